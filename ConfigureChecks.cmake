@@ -22,6 +22,7 @@ check_include_files("sys/types.h;sys/time.h"    LOG4CPLUS_HAVE_SYS_TIME_H )
 check_include_files("sys/types.h;sys/timeb.h"   LOG4CPLUS_HAVE_SYS_TIMEB_H )
 check_include_files("sys/types.h;sys/stat.h"    LOG4CPLUS_HAVE_SYS_STAT_H )
 check_include_files(sys/file.h    LOG4CPLUS_HAVE_SYS_FILE_H )
+check_include_files(sys/inotify.h LOG4CPLUS_HAVE_SYS_INOTIFY_H )
 check_include_files(syslog.h      LOG4CPLUS_HAVE_SYSLOG_H )
 check_include_files(arpa/inet.h   LOG4CPLUS_HAVE_ARPA_INET_H )
 check_include_files(netinet/in.h  LOG4CPLUS_HAVE_NETINET_IN_H )
@@ -125,6 +126,22 @@ if(LOG4CPLUS_WITH_ICONV)
   endif()
 endif()
 
+# Compression libraries for rolled over files are optional.
+if(WITH_ZLIB)
+  find_library(LIBZ NAMES z zlib)
+  check_include_files(zlib.h LOG4CPLUS_HAVE_ZLIB_H)
+  if(LIBZ AND LOG4CPLUS_HAVE_ZLIB_H)
+    set(LOG4CPLUS_WITH_ZLIB 1)
+  endif()
+endif()
+if(WITH_ZSTD)
+  find_library(LIBZSTD zstd)
+  check_include_files(zstd.h LOG4CPLUS_HAVE_ZSTD_H)
+  if(LIBZSTD AND LOG4CPLUS_HAVE_ZSTD_H)
+    set(LOG4CPLUS_WITH_ZSTD 1)
+  endif()
+endif()
+
 check_function_exists(gethostbyname_r LOG4CPLUS_HAVE_GETHOSTBYNAME_R) # TODO more complicated test in AC
 check_function_exists(getaddrinfo     LOG4CPLUS_HAVE_GETADDRINFO ) # TODO more complicated test in AC
 
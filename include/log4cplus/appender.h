@@ -36,11 +36,15 @@
 #include <log4cplus/helpers/pointer.h>
 #include <log4cplus/spi/filter.h>
 #include <log4cplus/helpers/lockfile.h>
+#include <log4cplus/helpers/eventcounter.h>
 
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <atomic>
 #include <condition_variable>
+#include <span>
+#include <vector>
 
 
 namespace log4cplus {
@@ -132,6 +136,27 @@ namespace log4cplus {
      * <dd>Set this property to <tt>true</tt> if you want all appends using
      * this appender to be done asynchronously. Default is <tt>false</tt>.</dd>
      *
+     * <dt><tt>OverflowPolicy</tt>, <tt>OverflowLevel</tt>,
+     * <tt>SampleRate</tt>, <tt>ReservedCapacity</tt>,
+     * <tt>ReservedLevel</tt></dt>
+     * <dd>With <tt>AsyncAppend</tt>, these decide what happens to events
+     * when the appender's queue is full, see helpers::OverflowPolicy.
+     * The queue length is set by <tt>log4cplus.threadPoolQueueSizeLimit</tt>.
+     * </dd>
+     *
+     * <dt><tt>FormatOutsideLock</tt></dt>
+     * <dd>Set this property to <tt>true</tt> if you want threshold check,
+     * filters and layout formatting to be done by the calling thread
+     * before the appender lock is taken. The lock is then held only for
+     * the output itself, e.g., file write and rollover. Filters and
+     * layout must be safe to use from multiple threads at once, which
+     * is true for the filters and layouts provided by log4cplus. It only
+     * pays off for appenders that output formatted events through
+     * `formatEvent()`, like FileAppender or ConsoleAppender. Batches
+     * passed to `syncDoAppendBatch()`, e.g., by AsyncAppender, are still
+     * formatted under the lock because they are written by one thread
+     * at once. Default is <tt>false</tt>.</dd>
+     *
      * </dl>
      */
     class LOG4CPLUS_EXPORT Appender
@@ -183,13 +208,51 @@ namespace log4cplus {
 
         void asyncDoAppend(const log4cplus::spi::InternalLoggingEvent& event);
 
+        /**
+         * This method is executed by thread pool threads. It takes all
+         * events queued by asynchronous `doAppend()` so far and appends
+         * them in their original order as one batch using
+         * `syncDoAppendBatch()`. It repeats until the queue is empty.
+         */
+        void drainAsyncQueue();
+
         /**
          * This function checks `async` flag. It either executes
-         * `syncDoAppend()` directly or enqueues its execution to thread pool
-         * thread.
+         * `syncDoAppend()` directly or enqueues the event into this
+         * appender's queue which is drained by a thread pool thread.
          */
         void doAppend(const log4cplus::spi::InternalLoggingEvent& event);
 
+        /**
+         * Same as `doAppend()` but it never waits for space in a full
+         * asynchronous queue, regardless of `setThreadPoolBlockOnFull()`.
+         *
+         * @return `false` if the event has been dropped because this
+         * appender's asynchronous queue is full, `true` otherwise.
+         */
+        bool tryDoAppend(const log4cplus::spi::InternalLoggingEvent& event);
+
+        /**
+         * @return Number of events of level `ll` dropped because
+         * asynchronous queue of this appender was full.
+         */
+        std::size_t getAsyncDropCount(LogLevel ll) const;
+
+        /**
+         * This method is a batch variant of `syncDoAppend()`. It takes
+         * the appender lock only once for the whole batch and hands the
+         * batch over to `appendBatch()`.
+         */
+        void syncDoAppendBatch(
+            std::span<const log4cplus::spi::InternalLoggingEvent> events);
+
+        /**
+         * This method is a batch variant of `doAppend()`. With `async`
+         * flag set, each event is enqueued to thread pool separately.
+         */
+        void doAppendBatch(
+            std::span<const log4cplus::spi::InternalLoggingEvent> events);
+
         /**
          * Get the name of this appender. The name uniquely identifies the
          * appender.
@@ -288,6 +351,20 @@ namespace log4cplus {
          */
         virtual void append(const log4cplus::spi::InternalLoggingEvent& event) = 0;
 
+        /**
+         * Appends a batch of events. Implementations must skip events
+         * for which `isAccepted()` returns `false`. The default
+         * implementation calls `append()` for each accepted event.
+         * @see syncDoAppendBatch method.
+         */
+        virtual void appendBatch(
+            std::span<const log4cplus::spi::InternalLoggingEvent> events);
+
+        /**
+         * Checks event against threshold and filters of this appender.
+         */
+        bool isAccepted(const log4cplus::spi::InternalLoggingEvent& event);
+
         tstring & formatEvent (const log4cplus::spi::InternalLoggingEvent& event) const;
 
       // Data
@@ -317,10 +394,31 @@ namespace log4cplus {
 
         //! Asynchronous append.
         bool async;
+
+        //! Check filters and format events before taking access_mutex.
+        bool formatOutsideLock;
+
+        //! Protects layout and filter against modification while they
+        //! are used outside of access_mutex. It is taken before
+        //! access_mutex.
+        std::shared_mutex layoutFilterMutex;
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
         std::atomic<std::size_t> in_flight;
         std::mutex in_flight_mutex;
         std::condition_variable in_flight_condition;
+
+        //! Packed events waiting for drainAsyncQueue(). Only one thread
+        //! pool thread drains the queue at a time so that the events are
+        //! appended in the same order as they were enqueued.
+        std::mutex async_queue_mutex;
+        std::condition_variable async_queue_space;
+        std::vector<char> async_queue;
+        std::size_t async_queue_head;
+        std::size_t async_queue_count;
+        bool async_drain_scheduled;
+
+        //! What happens to events that do not fit into the queue.
+        helpers::OverflowPolicy asyncOverflow;
 #endif
 
         /** Is this appender closed? */
@@ -328,7 +426,11 @@ namespace log4cplus {
 
     private:
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-        void subtract_in_flight();
+        void subtract_in_flight(std::size_t count = 1);
+        bool enqueueAsyncDoAppend(
+            const log4cplus::spi::InternalLoggingEvent& event, bool block);
+        void drainAsyncQueueImpl(std::vector<char> & records,
+            std::vector<log4cplus::spi::InternalLoggingEvent> & events);
 #endif
     };
 
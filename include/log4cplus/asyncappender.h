@@ -59,6 +59,29 @@ namespace log4cplus
    attached appendres are then appended to from a separate thread which reads
    events appended to this appender from a queue.
 
+   <h3>Properties</h3>
+   <dl>
+   <dt><tt>Appender</tt></dt>
+   <dd>Class name of the attached appender. Its properties are taken
+   from <tt>Appender.</tt> subset of properties.</dd>
+
+   <dt><tt>QueueLimit</tt></dt>
+   <dd>Maximal number of events in the queue. Default is 100.</dd>
+
+   <dt><tt>QueueType</tt></dt>
+   <dd>Either <tt>locking</tt> (default) for the mutex protected queue
+   or <tt>lockfree</tt> for the lock free ring of preallocated events
+   (see thread::LockFreeQueue). The lock free queue rounds
+   <tt>QueueLimit</tt> up to the next power of two.</dd>
+
+   <dt><tt>OverflowPolicy</tt>, <tt>OverflowLevel</tt>,
+   <tt>SampleRate</tt>, <tt>ReservedCapacity</tt>,
+   <tt>ReservedLevel</tt></dt>
+   <dd>What happens to events when the queue is full, see
+   helpers::OverflowPolicy. By default, logging threads wait for space
+   in the queue.</dd>
+   </dl>
+
    \sa helpers::AppenderAttachableImpl
  */
 class LOG4CPLUS_EXPORT AsyncAppender
@@ -66,7 +89,19 @@ class LOG4CPLUS_EXPORT AsyncAppender
     , public helpers::AppenderAttachableImpl
 {
 public:
-    AsyncAppender (SharedAppenderPtr const & app, unsigned max_len);
+    //! Type of the queue between logging threads and the queue thread.
+    enum QueueType
+    {
+        //! Mutex and semaphore protected queue, see thread::Queue.
+        QTLocking,
+        //! Lock free ring of preallocated events, see
+        //! thread::LockFreeQueue.
+        QTLockFree
+    };
+
+    AsyncAppender (SharedAppenderPtr const & app, unsigned max_len,
+        QueueType queue_type = QTLocking,
+        helpers::OverflowPolicy const & policy = helpers::OverflowPolicy ());
     AsyncAppender (helpers::Properties const &);
 
     AsyncAppender (AsyncAppender const &) = delete;
@@ -76,13 +111,18 @@ public:
 
     virtual void close () override;
 
+    //! \return Number of events of level <code>ll</code> dropped
+    //! because of full queue.
+    std::size_t getDropCount (LogLevel ll) const;
+
 protected:
     virtual void append (spi::InternalLoggingEvent const &) override;
 
-    void init_queue_thread (unsigned);
+    void init_queue_thread (unsigned, QueueType,
+        helpers::OverflowPolicy const &);
 
     thread::AbstractThreadPtr queue_thread;
-    thread::QueuePtr queue;
+    thread::AbstractQueuePtr queue;
 };
 
 
@@ -210,7 +210,8 @@ namespace log4cplus
          * <pre>false</pre> makes the thread pool not to block when it is full.
          * The items that could not be inserted are dropped instead.</li>
          * <li>Property <pre>log4cplus.threadPoolQueueSizeLimit</pre> can be used to
-         * set thread pool queue size limit.</li>
+         * set the limit of events queued for each appender with
+         * <code>AsyncAppend</code> set.</li>
          * </ul>
          *
          * <h3>Example</h3>
@@ -295,9 +296,25 @@ namespace log4cplus
       // Methods
         void init();  // called by the ctor
         void reconfigure();
+
+        /**
+         * Re-reads the configuration file and applies only what differs
+         * from the previously applied configuration. Appenders whose
+         * class and options did not change are kept, including their
+         * open files and queues. Changed appenders are created anew and
+         * each logger's list of appenders is swapped in one step. Loggers
+         * and additivity settings that are no longer configured are reset.
+         * Replaced and dropped appenders are closed at the end. Unlike
+         * Hierarchy::resetConfiguration(), this never blocks logging
+         * threads and leaves loggers not mentioned by either
+         * configuration untouched.
+         */
+        void reconfigureIncrementally();
         void replaceEnvironVariables();
+        void configureGlobals();
         void configureLoggers();
         void configureLogger(log4cplus::Logger logger, const log4cplus::tstring& config);
+        void reconfigureLogger(log4cplus::Logger logger, const log4cplus::tstring& config);
         void configureAppenders();
         void configureAdditivity();
 
@@ -364,11 +381,25 @@ namespace log4cplus
     class ConfigurationWatchDogThread;
 
 
+    /**
+     * Configures log4cplus from <code>propertyFile</code> and then
+     * checks the file for modifications every <code>millis</code>
+     * milliseconds. Changes are applied with
+     * PropertyConfigurator::reconfigureIncrementally().
+     *
+     * When <code>notify</code> is true and inotify is available (Linux),
+     * the file is not polled. Changes are picked up within milliseconds
+     * from file system notifications instead, including swaps of
+     * symbolic links on the path such as Kubernetes ConfigMap
+     * <code>..data</code> link. Polling is used when notifications
+     * cannot be set up, e.g., when the directory does not exist.
+     */
     class LOG4CPLUS_EXPORT ConfigureAndWatchThread {
     public:
       // ctor and dtor
         ConfigureAndWatchThread(const log4cplus::tstring& propertyFile,
-                                unsigned int millis = 60 * 1000);
+                                unsigned int millis = 60 * 1000,
+                                bool notify = true);
         virtual ~ConfigureAndWatchThread();
 
     private:
@@ -34,7 +34,9 @@
 #include <log4cplus/fstreams.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/helpers/lockfile.h>
+#include <chrono>
 #include <fstream>
+#include <functional>
 #include <locale>
 #include <memory>
 
@@ -42,6 +44,10 @@
 namespace log4cplus
 {
 
+    //! Compression of rolled over files, see <tt>Compression</tt>
+    //! property of FileAppenderBase.
+    enum class FileCompression { NONE, GZIP, ZSTD };
+
     /**
      * Base class for Appenders writing log events to a file.
      * It is constructed with uninitialized file object, so all
@@ -56,6 +62,17 @@ namespace log4cplus
      * <dd>When it is set true, output stream will be flushed after
      * each appended event.</dd>
      *
+     * <dt><tt>FlushBytes</tt>, <tt>FlushEvents</tt>,
+     * <tt>FlushInterval</tt></dt>
+     * <dd>Group commit of appended events. Output stream is flushed
+     * once at least <tt>FlushBytes</tt> bytes or <tt>FlushEvents</tt>
+     * events have been written since the last flush, or once the
+     * oldest unflushed event is <tt>FlushInterval</tt> milliseconds
+     * old, whichever comes first. Idle appenders are flushed by a
+     * background timer. Zero disables the respective limit. Setting any
+     * of these properties to non-zero value turns
+     * <tt>ImmediateFlush</tt> off.</dd>
+     *
      * <dt><tt>Append</tt></dt>
      * <dd>When it is set true, output file will be appended to
      * instead of being truncated at opening.</dd>
@@ -112,6 +129,41 @@ namespace log4cplus
      * not translate EOLs to OS specific character sequence. The default value
      * is <tt>Text</tt> and the underlying stream will be opened in text
      * mode.</dd>
+     *
+     * <dt><tt>FileEngine</tt></dt>
+     * <dd>Set this property to <tt>fd</tt> to write the file through
+     * a POSIX file descriptor opened with <code>O_APPEND</code> and an
+     * internal buffer of <tt>BufferSize</tt> bytes instead of through
+     * <code>std::basic_filebuf</code>. The fd engine does not use
+     * <tt>Locale</tt>; narrow strings are written as they are and wide
+     * strings are encoded as UTF-8. The default value is
+     * <tt>stream</tt>. Platforms without POSIX I/O always use
+     * <tt>stream</tt>.</dd>
+     *
+     * <dt><tt>SyncPolicy</tt></dt>
+     * <dd>Only used by the <tt>fd</tt> engine. When it is set to
+     * <tt>flush</tt>, the file is synchronized to storage with
+     * <code>fdatasync()</code> after each flush. When it is set to
+     * <tt>close</tt>, the file is synchronized when it is closed or
+     * rolled over. The default value is <tt>none</tt>.</dd>
+     *
+     * <dt><tt>Compression</tt></dt>
+     * <dd>Set this property to <tt>gzip</tt> or <tt>zstd</tt> to compress
+     * backups made by RollingFileAppender, DailyRollingFileAppender and
+     * TimeBasedRollingFileAppender. Backups get <tt>.gz</tt> or
+     * <tt>.zst</tt> suffix. Compression runs on a background thread and
+     * implies <tt>AsyncRollover</tt>. The default value is
+     * <tt>none</tt>. The respective library has to be available when
+     * log4cplus is built.</dd>
+     *
+     * <dt><tt>AsyncRollover</tt></dt>
+     * <dd>When it is set true, rolling appenders open the new file
+     * before they switch to it, and leave renaming of backups and
+     * removal of old files to a background thread, so that logging
+     * threads do not wait for them. When the new file cannot be
+     * opened, the rollover is done synchronously. With
+     * <tt>UseLockFile</tt>, backups are renamed, and compressed,
+     * synchronously under the lock file.</dd>
      * </dl>
      */
     class LOG4CPLUS_EXPORT FileAppenderBase : public Appender {
@@ -126,6 +178,11 @@ namespace log4cplus
       //! \return Locale imbued in fstream.
         virtual std::locale getloc () const;
 
+      //! Flushes output stream if the oldest unflushed event is older
+      //! than <tt>FlushInterval</tt>. It is called by the background
+      //! flush timer.
+        void flushExpired();
+
     protected:
       // Ctors
         FileAppenderBase(const log4cplus::tstring& filename,
@@ -135,13 +192,76 @@ namespace log4cplus
         FileAppenderBase(const log4cplus::helpers::Properties& properties,
                          std::ios_base::openmode mode = std::ios_base::trunc);
 
+      // Dtor
+        virtual ~FileAppenderBase();
+
         void init();
 
         virtual void append(const spi::InternalLoggingEvent& event) override;
 
+        /**
+         * Formats all accepted events of the batch into single buffer
+         * which is then written and flushed at once, unless
+         * supportsBatchWrite() returns false. Then the events go through
+         * append() one by one.
+         */
+        virtual void appendBatch(
+            std::span<const spi::InternalLoggingEvent> events) override;
+
+        //! \return `true` if appendBatch() may write the whole batch at
+        //! once, bypassing append(). Subclasses whose append() has to
+        //! see every event return `false`.
+        virtual bool supportsBatchWrite() const;
+
         virtual void open(std::ios_base::openmode mode);
         bool reopen();
 
+        //! Reopens the file if the stream is in failed state.
+        //! \return `false` if the file cannot be written to.
+        bool prepareForAppend();
+
+        //! Flushes output stream after <code>chars</code> characters of
+        //! <code>events</code> events have been written, depending on
+        //! <code>immediateFlush</code> and group commit limits.
+        void commitAppend(std::size_t chars, std::size_t events);
+
+        //! Output file operations. They use either <code>out</code> or
+        //! the file descriptor engine, see <tt>FileEngine</tt> property.
+        void openFile(const log4cplus::tstring& name,
+                      std::ios_base::openmode mode);
+        void closeFile();
+        bool isFileGood() const;
+        void writeFile(const log4cplus::tstring& str);
+        void flushFile();
+        //! \return Size of the file including buffered output.
+        std::streamoff getFileSize();
+        //! Accounts for data appended to the file by other processes.
+        void seekFileEnd();
+
+        /**
+         * Opens new file, moves the current file to <code>staged</code>
+         * and switches output to the new file.
+         *
+         * \return `false` if the output could not be switched; the
+         * current file is kept then.
+         */
+        bool switchToNextFile(const log4cplus::tstring& staged);
+
+        /**
+         * Moves the current file to a temporary name using
+         * switchToNextFile() and posts <code>job</code> with the
+         * temporary name to background worker, see <tt>AsyncRollover</tt>
+         * property. When compression is enabled and the output cannot be
+         * switched, the current file is closed before it is moved. With
+         * <tt>UseLockFile</tt>, <code>job</code> is run right away under
+         * the lock file.
+         *
+         * \return `false` if the current file has not been moved; the
+         * caller does the rollover synchronously then.
+         */
+        bool rolloverInBackground(
+            std::function<void (const log4cplus::tstring&)> job);
+
       // Data
         /**
          * Immediate flush means that the underlying writer or output stream
@@ -177,6 +297,35 @@ namespace log4cplus
         unsigned long bufferSize;
         std::unique_ptr<log4cplus::tchar[]> buffer;
 
+        //! Group commit limits, see <tt>FlushBytes</tt>,
+        //! <tt>FlushEvents</tt> and <tt>FlushInterval</tt> properties.
+        unsigned long flushBytes;
+        unsigned flushEvents;
+        std::chrono::milliseconds flushInterval;
+
+        //! Bytes and events written since the last flush and the time
+        //! of the first of them.
+        std::size_t unflushedBytes;
+        std::size_t unflushedEvents;
+        std::chrono::steady_clock::time_point firstUnflushed;
+
+        //! Output file engine, see <tt>FileEngine</tt> and
+        //! <tt>SyncPolicy</tt> properties.
+        enum FileEngine { FEStream, FEFd };
+        enum SyncPolicy { SPNone, SPFlush, SPClose };
+        FileEngine fileEngine;
+        SyncPolicy syncPolicy;
+
+        //! Compression of rolled over files, see <tt>Compression</tt>
+        //! property.
+        FileCompression compression;
+
+        //! See <tt>AsyncRollover</tt> property.
+        bool asyncRollover;
+
+        class FdFile;
+        std::unique_ptr<FdFile> fdFile;
+
         log4cplus::tofstream out;
         log4cplus::tstring filename;
         log4cplus::tstring localeName;
@@ -254,6 +403,8 @@ namespace log4cplus
 
     protected:
         virtual void append(const spi::InternalLoggingEvent& event) override;
+        virtual void appendBatch(
+            std::span<const spi::InternalLoggingEvent> events) override;
         void rollover(bool alreadyLocked = false);
 
       // Data
@@ -328,6 +479,8 @@ namespace log4cplus
 
     protected:
         virtual void append(const spi::InternalLoggingEvent& event) override;
+        virtual void appendBatch(
+            std::span<const spi::InternalLoggingEvent> events) override;
         void rollover(bool alreadyLocked = false);
         log4cplus::helpers::Time calculateNextRolloverTime(const log4cplus::helpers::Time& t) const;
         log4cplus::tstring getFilename(const log4cplus::helpers::Time& t) const;
@@ -399,6 +552,8 @@ namespace log4cplus
 
     protected:
         virtual void append(const spi::InternalLoggingEvent& event) override;
+        virtual void appendBatch(
+            std::span<const spi::InternalLoggingEvent> events) override;
         void open(std::ios_base::openmode mode) override;
         virtual void close() override;
         void rollover(bool alreadyLocked = false);
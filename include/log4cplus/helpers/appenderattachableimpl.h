@@ -35,7 +35,9 @@
 #include <log4cplus/spi/appenderattachable.h>
 #include <log4cplus/thread/syncprims.h>
 
+#include <atomic>
 #include <memory>
+#include <span>
 #include <vector>
 
 
@@ -86,12 +88,15 @@ namespace log4cplus {
             virtual SharedAppenderPtr getAppender(const log4cplus::tstring& name);
 
             /**
-             * Remove all previously added appenders.
+             * Remove all previously added appenders. When it returns,
+             * no other thread appends to the removed appenders, unless
+             * it is called from within an appender.
              */
             virtual void removeAllAppenders();
 
             /**
-             * Remove the appender passed as parameter from the list of appenders.
+             * Remove the appender passed as parameter from the list of
+             * appenders. See removeAllAppenders() for when it returns.
              */
             virtual void removeAppender(SharedAppenderPtr appender);
 
@@ -101,18 +106,91 @@ namespace log4cplus {
              */
             virtual void removeAppender(const log4cplus::tstring& name);
 
+            /**
+             * Replace all attached appenders with <code>newAppenders</code>.
+             * Logging threads see either the old or the new list, never
+             * a partial one.
+             */
+            virtual void replaceAllAppenders(
+                const SharedAppenderPtrList& newAppenders);
+
             /**
              * Call the <code>doAppend</code> method on all attached appenders.
+             * The list of appenders is read from immutable snapshot
+             * without taking <code>appender_list_mutex</code>, unless
+             * the list is locked by lockAppenderList().
              */
             int appendLoopOnAppenders(const spi::InternalLoggingEvent& event) const;
 
+            /**
+             * Call the <code>doAppendBatch</code> method on all attached
+             * appenders.
+             */
+            int appendLoopOnAppenders(
+                std::span<const spi::InternalLoggingEvent> events) const;
+
+            /**
+             * Locks <code>appender_list_mutex</code> and makes
+             * appendLoopOnAppenders() wait until unlockAppenderList() is
+             * called. This is used by HierarchyLocker to hold events
+             * while the configuration changes.
+             */
+            void lockAppenderList();
+
+            /**
+             * Undoes lockAppenderList().
+             */
+            void unlockAppenderList();
+
         protected:
           // Types
             typedef std::vector<SharedAppenderPtr> ListType;
 
+          // Methods
+            /**
+             * Registers calling thread as reader of appender list
+             * snapshots and returns the current snapshot. The snapshot
+             * stays valid until releaseAppenderSnapshot() is called with
+             * <code>token</code>. Returns null without registering if
+             * there are no appenders.
+             */
+            const ListType * acquireAppenderSnapshot(unsigned & token) const;
+
+            /**
+             * Undoes acquireAppenderSnapshot().
+             */
+            static void releaseAppenderSnapshot(unsigned token);
+
+            /**
+             * Publishes copy of <code>appenderList</code> as new
+             * snapshot. The previous snapshot is destroyed once no
+             * thread can be reading it. It has to be called with
+             * <code>appender_list_mutex</code> held.
+             */
+            void publishAppenderList();
+
+            /**
+             * Waits until no thread is appending through snapshots
+             * replaced so far. It does not wait when called by thread
+             * appending through a snapshot.
+             */
+            static void waitForAppenderReaders();
+
           // Data
-            /** Array of appenders. */
+            /** Array of appenders. It is guarded by
+             * <code>appender_list_mutex</code>. */
             ListType appenderList;
+
+            /** Immutable copy of <code>appenderList</code> read by
+             * appendLoopOnAppenders(). */
+            std::atomic<ListType *> appenderSnapshot {nullptr};
+
+            /** Size of <code>appenderList</code>. */
+            std::atomic<std::size_t> appenderCount {0};
+
+            /** Count of lockAppenderList() calls without
+             * unlockAppenderList(). */
+            std::atomic<unsigned> appenderListLocks {0};
         };  // end class AppenderAttachableImpl
 
     } // end namespace helpers
@@ -63,6 +63,14 @@ protected:
     //! Sets connected flag to true in ConnectorThread's client.
     virtual void ctcSetConnected () = 0;
 
+    //! Called by ConnectorThread without the access mutex held after
+    //! new connection has been established. Clients that store events
+    //! while disconnected send them here before they call
+    //! ctcSetConnected(). The default implementation just calls
+    //! ctcSetConnected().
+    //! \return `false` if the connection failed again.
+    virtual bool ctcReplay ();
+
     friend class LOG4CPLUS_EXPORT ConnectorThread;
 };
 
@@ -34,9 +34,12 @@
 
 #include <log4cplus/internal/threadsafetyanalysis.h>
 #include <log4cplus/thread/syncprims.h>
+#include <log4cplus/loglevel.h>
 #include <cstddef>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <vector>
 
 
 namespace log4cplus {
@@ -85,6 +88,122 @@ private:
 };
 
 
+class Properties;
+
+
+//! Decides what a bounded queue of events does with a new event when
+//! it is full and counts dropped events per log level.
+//!
+//! The settings are read from the following properties by configure():
+//!
+//! <dl>
+//! <dt><tt>OverflowPolicy</tt></dt>
+//! <dd>One of <tt>block</tt> (default), <tt>dropnewest</tt>,
+//! <tt>dropoldest</tt>, <tt>dropbelowlevel</tt> or <tt>sample</tt>.
+//! <tt>dropoldest</tt> drops the oldest queued event below
+//! <tt>ReservedLevel</tt>; when there is none, the new event is
+//! dropped.</dd>
+//!
+//! <dt><tt>OverflowLevel</tt></dt>
+//! <dd>With <tt>dropbelowlevel</tt>, events below this level are dropped
+//! when the queue is full and the others wait for space. Default is
+//! <tt>WARN</tt>.</dd>
+//!
+//! <dt><tt>SampleRate</tt></dt>
+//! <dd>With <tt>sample</tt>, only every N-th event below
+//! <tt>ReservedLevel</tt> is accepted once the queue is half full. Full
+//! queue drops new events. Default is 10.</dd>
+//!
+//! <dt><tt>ReservedCapacity</tt></dt>
+//! <dd>Number of queue entries usable only by events at or above
+//! <tt>ReservedLevel</tt>. Default is 0.</dd>
+//!
+//! <dt><tt>ReservedLevel</tt></dt>
+//! <dd>Default is <tt>ERROR</tt>.</dd>
+//! </dl>
+class LOG4CPLUS_EXPORT OverflowPolicy
+{
+public:
+    enum Action
+    {
+        //! Wait for space in the queue.
+        OPBlock,
+        //! Drop the new event.
+        OPDropNewest,
+        //! Drop the oldest queued event below reserved level to make
+        //! space for the new one, or the new one if there is no such
+        //! event.
+        OPDropOldest,
+        //! Drop the new event if it is below level, otherwise wait.
+        OPDropBelowLevel,
+        //! Accept only every N-th event below reserved level once the
+        //! queue is half full, drop new events when it is full.
+        OPSample
+    };
+
+    //! Result of decide().
+    enum Decision
+    {
+        //! There is space for the event.
+        ODAccept,
+        //! The producer has to wait for space and ask again.
+        ODWait,
+        //! The event has to be dropped.
+        ODDrop,
+        //! An event has to be removed by evictPacked() and the new
+        //! event stored instead of it.
+        ODEvict
+    };
+
+    OverflowPolicy ();
+
+    //! Copies settings. Counters of the copy start at zero.
+    OverflowPolicy (OverflowPolicy const &);
+    OverflowPolicy & operator = (OverflowPolicy const &);
+
+    ~OverflowPolicy ();
+
+    //! Reads settings from properties described above.
+    void configure (Properties const & properties);
+
+    //! \param ll Level of the new event.
+    //! \param size Number of events in the queue.
+    //! \param capacity Maximal number of events in the queue.
+    Decision decide (LogLevel ll, std::size_t size, std::size_t capacity);
+
+    //! Removes the oldest of <code>count</code> events packed by
+    //! spi::InternalLoggingEvent::pack() in <code>arena</code> from
+    //! offset <code>head</code> on whose level is below
+    //! <code>reservedLevel</code>, and counts it as dropped.
+    //!
+    //! \return `false` if there is no such event.
+    bool evictPacked (std::vector<char> & arena, std::size_t & head,
+        std::size_t count);
+
+    //! Counts dropped event of level <code>ll</code>.
+    void recordDrop (LogLevel ll);
+
+    //! \return Number of dropped events of level <code>ll</code>.
+    //! Custom levels are counted with the nearest lower standard level.
+    std::size_t getDropCount (LogLevel ll) const;
+
+    //! \return Number of all dropped events.
+    std::size_t getDropCount () const;
+
+    Action action;
+    LogLevel overflowLevel;
+    unsigned sampleRate;
+    std::size_t reservedCapacity;
+    LogLevel reservedLevel;
+
+private:
+    static std::size_t levelIndex (LogLevel ll);
+
+    std::atomic<std::size_t> sampleCounter {0};
+    std::array<std::atomic<std::size_t>, 6> drops {};
+};
+
+
 } // namespace helpers
 
 } // namespace log4cplus
@@ -32,7 +32,7 @@
 
 #include <log4cplus/tstring.h>
 #include <log4cplus/streams.h>
-#include <log4cplus/thread/syncprims.h>
+#include <atomic>
 
 
 namespace log4cplus {
@@ -50,6 +50,12 @@ namespace log4cplus {
          * where as internal error messages are sent to
          * <code>cerr</code>. All internal messages are prepended with
          * the string "log4clus: ".
+         *
+         * Initial state of internal debugging and quiet mode is taken
+         * from <code>LOG4CPLUS_LOGLOG_DEBUGENABLED</code> and
+         * <code>LOG4CPLUS_LOGLOG_QUIETMODE</code> environment variables.
+         * Disabled debug() call costs a single relaxed atomic load and
+         * takes no lock.
          */
         class LOG4CPLUS_EXPORT LogLog
         {
@@ -76,6 +82,16 @@ namespace log4cplus {
              */
             void setQuietMode(bool quietMode);
 
+            /**
+             * \return `true` if debug() produces output. It can be used
+             * to avoid composing debug messages that would be discarded.
+             */
+            bool isDebugEnabled() const
+            {
+                return (flags.load (std::memory_order_relaxed)
+                    & (fDebugEnabled | fQuietMode)) == fDebugEnabled;
+            }
+
             /**
              * This method is used to output log4cplus internal debug
              * statements. Output goes to <code>std::cout</code>.
@@ -106,30 +122,21 @@ namespace log4cplus {
             virtual ~LogLog();
 
         private:
-            enum TriState
+            enum Flags : unsigned
             {
-                TriUndef = -1,
-                TriFalse,
-                TriTrue
+                fDebugEnabled = 1 << 0,
+                fQuietMode    = 1 << 1
             };
 
             template <typename StringType>
             LOG4CPLUS_PRIVATE
-            void logging_worker (tostream & os,
-                bool (LogLog:: * cond) () const, tchar const *,
+            void logging_worker (tostream & os, bool output, tchar const *,
                 StringType const &, bool throw_flag = false) const;
 
-            LOG4CPLUS_PRIVATE static void set_tristate_from_env (TriState *,
-                tchar const * envvar);
-
             LOG4CPLUS_PRIVATE bool get_quiet_mode () const;
-            LOG4CPLUS_PRIVATE bool get_not_quiet_mode () const;
-            LOG4CPLUS_PRIVATE bool get_debug_mode () const;
 
             // Data
-            mutable TriState debugEnabled;
-            mutable TriState quietMode;
-            thread::Mutex mutex;
+            std::atomic<unsigned> flags;
 
             LOG4CPLUS_PRIVATE LogLog(const LogLog&);
             LOG4CPLUS_PRIVATE LogLog & operator = (LogLog const &);
@@ -33,8 +33,12 @@
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
 
-#include <deque>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/helpers/eventcounter.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/thread/syncprims.h>
 
@@ -42,8 +46,9 @@
 namespace log4cplus { namespace thread {
 
 
-//! Single consumer, multiple producers queue.
-class LOG4CPLUS_EXPORT Queue
+//! Interface of single consumer, multiple producers queues used by
+//! AsyncAppender.
+class LOG4CPLUS_EXPORT AbstractQueue
     : public virtual helpers::SharedObject
 {
 public:
@@ -51,37 +56,36 @@ public:
     typedef unsigned flags_type;
 
     //! Queue storage type.
-    typedef std::deque<spi::InternalLoggingEvent> queue_storage_type;
+    typedef std::vector<spi::InternalLoggingEvent> queue_storage_type;
 
-    explicit Queue (unsigned len = 100);
-    virtual ~Queue ();
+    AbstractQueue ();
+    virtual ~AbstractQueue ();
 
-    Queue (Queue const &) = delete;
-    Queue (Queue &&) = delete;
+    AbstractQueue (AbstractQueue const &) = delete;
+    AbstractQueue (AbstractQueue &&) = delete;
 
-    Queue & operator = (Queue const &) = delete;
-    Queue & operator = (Queue &&) = delete;
+    AbstractQueue & operator = (AbstractQueue const &) = delete;
+    AbstractQueue & operator = (AbstractQueue &&) = delete;
 
     // Producers' methods.
 
     //! Puts event <code>ev</code> into queue, sets QUEUE flag and
-    //! sets internal event object into signaled state. If the EXIT
-    //! flags is already set upon entering the function, nothing is
-    //! inserted into the queue. The function can block on internal
-    //! semaphore if the queue has reached maximal allowed
-    //! length. Calling thread is unblocked either by consumer thread
-    //! removing item from queue or by any other thread calling
-    //! signal_exit().
+    //! wakes up the consumer. If the EXIT flags is already set upon
+    //! entering the function, nothing is inserted into the queue. When
+    //! the queue has reached maximal allowed length, the queue's
+    //! helpers::OverflowPolicy decides whether the function blocks or
+    //! an event is dropped. Blocked calling thread is unblocked either
+    //! by consumer thread removing item from queue or by any other
+    //! thread calling signal_exit().
     //!
     //! \param ev spi::InternalLoggingEvent to be put into the queue.
     //! \return Flags.
-    flags_type put_event (spi::InternalLoggingEvent const & ev);
+    virtual flags_type put_event (spi::InternalLoggingEvent const & ev) = 0;
 
-    //! Sets EXIT flag and DRAIN flag and sets internal event object
-    //! into signaled state.
+    //! Sets EXIT flag and DRAIN flag and wakes up the consumer.
     //! \param drain If true, DRAIN flag will be set, otherwise unset.
     //! \return Flags, ERROR_BIT can be set upon error.
-    flags_type signal_exit (bool drain = true);
+    virtual flags_type signal_exit (bool drain = true) = 0;
 
     // Consumer's methods.
 
@@ -90,11 +94,10 @@ public:
     //! value. If EXIT flag is already set in flags member upon
     //! entering the function then depending on DRAIN flag it either
     //! fills <code>buf</code> argument or does not fill the argument,
-    //! if the queue is non-empty. The function blocks by waiting for
-    //! internal event object to be signaled if the queue is empty,
-    //! unless EXIT flag is set. The calling thread is unblocked when
-    //! items are added into the queue or when exit is signaled using
-    //! the signal_exit() function.
+    //! if the queue is non-empty. The function blocks if the queue is
+    //! empty, unless EXIT flag is set. The calling thread is unblocked
+    //! when items are added into the queue or when exit is signaled
+    //! using the signal_exit() function.
     //!
     //!
     //! Upon error, return value has one of the error flags set.
@@ -102,7 +105,10 @@ public:
     //! \param buf Pointer to storage of spi::InternalLoggingEvent
     //! instances to be filled from queue.
     //! \return Flags.
-    flags_type get_events (queue_storage_type * buf);
+    virtual flags_type get_events (queue_storage_type * buf) = 0;
+
+    //! \return Overflow policy of this queue with its drop counters.
+    helpers::OverflowPolicy const & getOverflowPolicy () const;
 
     //! Possible state flags.
     enum Flags
@@ -132,23 +138,152 @@ public:
     };
 
 protected:
-    //! Queue storage.
-    queue_storage_type queue;
+    //! Decides what happens to events that do not fit into the queue.
+    helpers::OverflowPolicy overflow;
+};
+
+
+//! Single consumer, multiple producers queue protected by a mutex.
+//!
+//! Events are stored packed by spi::InternalLoggingEvent::pack() one
+//! after another in a single arena buffer. The consumer swaps the
+//! arena out and unpacks the events outside of the lock.
+class LOG4CPLUS_EXPORT Queue
+    : public AbstractQueue
+{
+public:
+    explicit Queue (unsigned len = 100,
+        helpers::OverflowPolicy const & policy = helpers::OverflowPolicy ());
+    virtual ~Queue ();
+
+    //! \copydoc AbstractQueue::put_event()
+    //!
+    //! This implementation blocks on internal event if the policy tells
+    //! it to wait for space in the queue.
+    flags_type put_event (spi::InternalLoggingEvent const & ev) override;
+
+    //! \copydoc AbstractQueue::signal_exit()
+    flags_type signal_exit (bool drain = true) override;
+
+    //! \copydoc AbstractQueue::get_events()
+    flags_type get_events (queue_storage_type * buf) override;
+
+protected:
+    //! Packed events.
+    std::vector<char> arena;
+
+    //! Offset of the first event in <code>arena</code>. Events before
+    //! it have been dropped to make space for newer ones.
+    std::size_t arena_head;
 
-    //! Mutex protecting queue and flags.
+    //! Number of events in <code>arena</code>.
+    std::size_t count;
+
+    //! Maximal number of events in <code>arena</code>.
+    std::size_t const capacity;
+
+    //! Arena owned by the consumer. Events returned by get_events()
+    //! refer to it until the next call.
+    std::vector<char> consumer_arena;
+
+    //! Mutex protecting arena, count and flags.
     Mutex mutex;
 
     //! Event on which consumer can wait if it finds queue empty.
     ManualResetEvent ev_consumer;
 
-    //! Semaphore that limits the queue length.
-    Semaphore sem;
+    //! Event on which producers wait for space in the queue.
+    ManualResetEvent ev_producers;
 
     //! State flags.
     flags_type flags;
 };
 
 
+//! Bounded single consumer, multiple producers queue that does not
+//! take any lock on the producers' side.
+//!
+//! The queue is a ring of preallocated slots. Each slot carries a
+//! sequence number which tells producers and the consumer whose turn it
+//! is to touch the slot. Producers claim slots by atomically
+//! incrementing the enqueue position, pack the event into the slot's
+//! buffer using spi::InternalLoggingEvent::pack() and publish it by
+//! bumping the slot's sequence number. The consumer copies published
+//! records into its own arena and unpacks them from there. Slot buffers
+//! keep their capacity, so the queue does not allocate once it is
+//! warmed up.
+class LOG4CPLUS_EXPORT LockFreeQueue
+    : public AbstractQueue
+{
+public:
+    //! \param len Requested queue capacity. It is rounded up to the
+    //! next power of two.
+    //! \param policy Overflow policy. The lock free queue cannot drop
+    //! the oldest events, OPDropOldest drops the newest ones instead.
+    explicit LockFreeQueue (unsigned len = 100,
+        helpers::OverflowPolicy const & policy = helpers::OverflowPolicy ());
+    virtual ~LockFreeQueue ();
+
+    //! \copydoc AbstractQueue::put_event()
+    //!
+    //! This implementation waits without holding any lock if the policy
+    //! tells it to wait for space in the ring.
+    flags_type put_event (spi::InternalLoggingEvent const & ev) override;
+
+    //! \copydoc AbstractQueue::signal_exit()
+    flags_type signal_exit (bool drain = true) override;
+
+    //! \copydoc AbstractQueue::get_events()
+    flags_type get_events (queue_storage_type * buf) override;
+
+protected:
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        std::vector<char> record;
+        bool valid = false;
+    };
+
+    //! Step of the enqueue position. The lowest bit of the enqueue
+    //! position is the closed bit.
+    static constexpr std::size_t POS_STEP = 2;
+
+    //! Closed bit of the enqueue position. It is set by signal_exit().
+    static constexpr std::size_t POS_CLOSED = 1;
+
+    //! Ring of preallocated slots.
+    std::unique_ptr<Slot[]> slots;
+
+    //! Capacity of the ring, always power of two.
+    std::size_t const capacity;
+
+    //! Records copied out of the ring by the consumer. Events returned
+    //! by get_events() refer to it until the next call.
+    std::vector<char> consumer_arena;
+
+    //! Next position to be claimed by producers, multiplied by
+    //! POS_STEP, with POS_CLOSED bit.
+    alignas (64) std::atomic<std::size_t> enqueue_pos;
+
+    //! Incremented by producers after publishing a slot. The consumer
+    //! waits on it when the ring is empty.
+    alignas (64) std::atomic<std::uint32_t> produced_seq;
+
+    //! Incremented by the consumer after releasing slots and by
+    //! signal_exit(). Producers wait on it when the ring is full.
+    alignas (64) std::atomic<std::uint32_t> consumed_seq;
+
+    //! Next position to be read by the consumer. Written only by the
+    //! consumer thread once per batch. Producers read it to estimate
+    //! the number of queued events.
+    alignas (64) std::atomic<std::size_t> dequeue_pos;
+
+    //! State flags.
+    std::atomic<flags_type> flags;
+};
+
+
+typedef helpers::SharedObjectPtr<AbstractQueue> AbstractQueuePtr;
 typedef helpers::SharedObjectPtr<Queue> QueuePtr;
 
 
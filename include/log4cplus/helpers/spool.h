@@ -0,0 +1,158 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Haisman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_SPOOL_H
+#define LOG4CPLUS_HELPERS_SPOOL_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/tstring.h>
+#include <log4cplus/thread/syncprims.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace log4cplus {
+
+namespace helpers {
+
+class Properties;
+
+
+//! Bounded store-and-forward queue of serialized events used by
+//! SocketAppender and remote SysLogAppender while they are not
+//! connected. Records are kept in memory first. When the memory limit is
+//! reached they are written into segment files on local disk. Records
+//! are replayed oldest first. New records are dropped when both parts
+//! are full.
+//!
+//! The settings are read from the following properties by configure():
+//!
+//! <dl>
+//! <dt><tt>SpoolSize</tt></dt>
+//! <dd>Maximal size of records kept in memory. The value is in bytes.
+//! It is possible to use <tt>MB</tt> and <tt>KB</tt> suffixes. The
+//! default is 0.</dd>
+//!
+//! <dt><tt>SpoolFile</tt></dt>
+//! <dd>Path prefix of segment files, the files are named
+//! <tt>SpoolFile.N</tt>. Segments left by previous run are replayed
+//! before any new records. Records held in memory are lost when the
+//! appender is closed.</dd>
+//!
+//! <dt><tt>SpoolFileSize</tt></dt>
+//! <dd>Maximal size of all segment files. The default is 64 MB.</dd>
+//! </dl>
+//!
+//! The spool is enabled when either <tt>SpoolSize</tt> or
+//! <tt>SpoolFile</tt> is set. It is not synchronized, its users guard it
+//! with their access mutex.
+class LOG4CPLUS_EXPORT Spool
+{
+public:
+    Spool ();
+    ~Spool ();
+    Spool (Spool const &) = delete;
+    Spool & operator = (Spool const &) = delete;
+
+    //! Reads settings from properties described above and picks up
+    //! segment files left by previous run.
+    void configure (Properties const & properties);
+
+    bool enabled () const;
+
+    bool empty () const;
+
+    //! Stores a copy of <code>record</code>.
+    //! \return `false` if the spool is disabled or full and the record
+    //! has been dropped.
+    bool push (std::string_view record);
+
+    //! Sends stored records, oldest first, by calling <code>write</code>
+    //! with batches of records. <code>mutex</code> is held only while
+    //! a batch is taken from the spool so that producers can keep on
+    //! storing records while the batch is written. Once the spool is
+    //! found empty, <code>done</code> is called with <code>mutex</code>
+    //! still held.
+    //!
+    //! \return `false` if <code>write</code> failed. The failed batch
+    //! stays in the spool and it is sent again by the next replay.
+    bool replay (thread::Mutex const & mutex,
+        std::function<bool (std::vector<std::string> const &)> const & write,
+        std::function<void ()> const & done);
+
+    //! \return Number of records dropped since the last replay.
+    std::size_t getDropCount () const;
+
+private:
+    struct Segment
+    {
+        unsigned long index;
+        std::uintmax_t size;
+    };
+
+    tstring segmentName (unsigned long index) const;
+    bool write (std::string_view record);
+    void peek (std::vector<std::string> & records, std::size_t maxBytes);
+    void pop ();
+
+    std::size_t memoryLimit;
+    std::size_t memoryBytes;
+    std::deque<std::string> memory;
+
+    tstring filePrefix;
+    std::uintmax_t fileLimit;
+    std::uintmax_t fileBytes;
+    std::deque<Segment> segments;
+    //! Last segment when it is being written by this instance.
+    std::ofstream writer;
+    //! Read position in the first segment.
+    std::uintmax_t readPos;
+
+    //! Extent of the batch returned by the last peek().
+    std::size_t peekedMemory;
+    std::uintmax_t peekedFileEnd;
+
+    std::size_t drops;
+};
+
+
+} // namespace helpers
+
+} // namespace log4cplus
+
+#endif // LOG4CPLUS_HELPERS_SPOOL_H
@@ -53,6 +53,28 @@ namespace log4cplus {
         LOG4CPLUS_EXPORT tchar toLower(tchar);
 
 
+        /**
+         * Returns handle of new shared copy of <code>s</code>.
+         */
+        LOG4CPLUS_EXPORT tstring_handle makeStringHandle(
+            const log4cplus::tstring_view& s);
+
+        /**
+         * Returns handle of static empty string. Copies of this handle
+         * do not touch any reference count.
+         */
+        LOG4CPLUS_EXPORT tstring_handle const & getEmptyStringHandle();
+
+        /**
+         * Sets <code>handle</code> to a string equal to <code>s</code>.
+         * The handle is kept as it is if its string is already equal to
+         * <code>s</code>, otherwise it gets a new shared string. The
+         * string referenced by the handle is never modified.
+         */
+        LOG4CPLUS_EXPORT void assignStringHandle(tstring_handle & handle,
+            const log4cplus::tstring_view& s);
+
+
         /**
          * Tokenize <code>s</code> using <code>c</code> as the delimiter and
          * put the resulting tokens in <code>_result</code>.  If
@@ -160,6 +160,16 @@ LOG4CPLUS_EXPORT
 log4cplus::tstring getFormattedTime (log4cplus::tstring const & fmt,
     Time const & the_time, bool use_gmtime = false);
 
+/**
+ * Same as getFormattedTime() but appends the formatted time to
+ * <code>result</code> instead of returning a new string. Reusing
+ * <code>result</code> across calls avoids memory allocations.
+ */
+LOG4CPLUS_EXPORT
+void appendFormattedTime (log4cplus::tstring & result,
+    log4cplus::tstring const & fmt, Time const & the_time,
+    bool use_gmtime = false);
+
 
 } // namespace helpers
 
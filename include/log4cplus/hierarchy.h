@@ -32,8 +32,11 @@
 
 #include <log4cplus/logger.h>
 #include <log4cplus/thread/syncprims.h>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
 
@@ -240,6 +243,20 @@ namespace log4cplus {
         typedef std::vector<Logger> ProvisionNode;
         typedef std::map<log4cplus::tstring, ProvisionNode, std::less<>> ProvisionNodeMap;
         typedef std::map<log4cplus::tstring, Logger, std::less<>> LoggerMap;
+        typedef std::unordered_map<log4cplus::tstring, Logger,
+            helpers::tstring_hash, std::equal_to<>> LoggerCacheMap;
+
+        //! One shard of the read mostly cache of existing loggers. The
+        //! cache mirrors <code>loggerPtrs</code>. It is only written to
+        //! while <code>hashtable_mutex</code> is held.
+        struct alignas (64) LoggerCacheShard
+        {
+            std::shared_mutex mutex;
+            LoggerCacheMap loggers;
+        };
+
+        //! Number of shards of the loggers cache.
+        static constexpr std::size_t LOGGER_CACHE_SHARDS = 32;
 
       // Methods
         /**
@@ -296,17 +313,36 @@ namespace log4cplus {
         LOG4CPLUS_PRIVATE void updateChildren(ProvisionNode& pn,
             Logger const & logger);
 
+        /**
+         * Bumps the log level generation and marks cached chained
+         * LogLevel of every logger as stale. This has to be called
+         * whenever LogLevel of any logger or the structure of the
+         * hierarchy changes.
+         */
+        LOG4CPLUS_PRIVATE void invalidateLogLevelCaches();
+
+        /**
+         * Returns shard of loggers cache for logger <code>name</code>.
+         */
+        LOG4CPLUS_PRIVATE LoggerCacheShard & getLoggerCacheShard(
+            const log4cplus::tstring_view& name) const;
+
      // Data
         thread::Mutex hashtable_mutex;
         std::unique_ptr<spi::LoggerFactory> defaultFactory;
         ProvisionNodeMap provisionNodes;
         LoggerMap loggerPtrs;
+        std::unique_ptr<LoggerCacheShard[]> loggerCache;
         Logger root;
 
         int disableValue;
 
         bool emittedNoAppenderWarning;
 
+        //! Log level generation, see invalidateLogLevelCaches(). It is
+        //! guarded by <code>hashtable_mutex</code>.
+        std::uint32_t logLevelGeneration;
+
         // Disallow copying of instances of this class
         Hierarchy(const Hierarchy&);
         Hierarchy& operator=(const Hierarchy&);
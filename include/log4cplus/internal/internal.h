@@ -47,8 +47,11 @@
 #  error "This header must not be be used outside log4cplus' implementation files."
 #endif
 
+#include <array>
 #include <memory>
+#include <utility>
 #include <vector>
+#include <ctime>
 #include <sstream>
 #include <cstdio>
 #include <log4cplus/tstring.h>
@@ -75,25 +78,24 @@ struct gft_scratch_pad
     gft_scratch_pad ();
     ~gft_scratch_pad ();
 
-    void
-    reset ()
+    //! Format string rendered for one second with positions where
+    //! %q or %Q fractions of second are to be inserted.
+    struct cache_entry
     {
-        uc_q_str_valid = false;
-        q_str_valid = false;
-        s_str_valid = false;
-        ret.clear ();
-    }
-
-    log4cplus::tstring q_str;
-    log4cplus::tstring uc_q_str;
+        log4cplus::tstring fmt;
+        log4cplus::tstring text;
+        //! Position in text and whether it is %Q (true) or %q (false).
+        std::vector<std::pair<std::size_t, bool> > fractions;
+        time_t sec = 0;
+        bool use_gmtime = false;
+        bool valid = false;
+    };
+
     log4cplus::tstring s_str;
-    log4cplus::tstring ret;
     log4cplus::tstring fmt;
-    log4cplus::tstring tmp;
     std::vector<tchar> buffer;
-    bool uc_q_str_valid;
-    bool q_str_valid;
-    bool s_str_valid;
+    std::array<cache_entry, 4> cache;
+    std::size_t cache_victim;
 };
 
 
@@ -105,6 +107,10 @@ struct appender_sratch_pad
     tostringstream oss;
     tstring str;
     std::string chstr;
+    //! Appender and event for which <code>str</code> has been formatted
+    //! ahead of append(), see Appender::formatEvent().
+    void const * formatted_appender = nullptr;
+    spi::InternalLoggingEvent const * formatted_event = nullptr;
 };
 
 
@@ -117,15 +123,18 @@ struct per_thread_data
     tstring macros_str;
     tostringstream macros_oss;
     tostringstream layout_oss;
+    tstring layout_str;
     DiagnosticContextStack ndc_dcs;
     MappedDiagnosticContext mdc;
-    log4cplus::tstring thread_name;
-    log4cplus::tstring thread_name2;
+    log4cplus::tstring_handle thread_name;
+    log4cplus::tstring_handle thread_name2;
     gft_scratch_pad gft_sp;
     appender_sratch_pad appender_sp;
     log4cplus::tstring faa_str;
     log4cplus::tstring ll_str;
     spi::InternalLoggingEvent forced_log_ev;
+    std::vector<spi::InternalLoggingEvent> unpacked_events;
+    std::vector<char> async_records;
     std::FILE * fnull;
     log4cplus::helpers::snprintf_buf snprintf_buf;
 };
@@ -196,7 +205,7 @@ get_ptd (bool alloc = true)
 
 
 inline
-tstring &
+tstring_handle &
 get_thread_name_str ()
 {
     return get_ptd ()->thread_name;
@@ -204,7 +213,7 @@ get_thread_name_str ()
 
 
 inline
-tstring &
+tstring_handle &
 get_thread_name2_str ()
 {
     return get_ptd ()->thread_name2;
@@ -46,6 +46,7 @@ namespace log4cplus {
     {
 
         class PatternConverter;
+        class CompiledPattern;
 
     }
 
@@ -84,6 +85,16 @@ namespace log4cplus {
         virtual void formatAndAppend(log4cplus::tostream& output,
             const log4cplus::spi::InternalLoggingEvent& event) = 0;
 
+        /**
+         * Appends formatted <code>event</code> to the end of
+         * <code>buffer</code>. Appenders that keep reusing the same
+         * buffer can format events without any memory allocation in
+         * steady state. The default implementation formats the event
+         * through a per-thread string stream and appends the result.
+         */
+        virtual void formatInto(log4cplus::tstring& buffer,
+            const log4cplus::spi::InternalLoggingEvent& event);
+
     protected:
         LogLevelManager& llmCache;
     };
@@ -114,6 +125,8 @@ namespace log4cplus {
 
         virtual void formatAndAppend(log4cplus::tostream& output,
                                      const log4cplus::spi::InternalLoggingEvent& event) override;
+        virtual void formatInto(log4cplus::tstring& buffer,
+                                const log4cplus::spi::InternalLoggingEvent& event) override;
     };
 
 
@@ -625,6 +638,8 @@ namespace log4cplus {
 
         virtual void formatAndAppend(log4cplus::tostream& output,
                                      const log4cplus::spi::InternalLoggingEvent& event) override;
+        virtual void formatInto(log4cplus::tstring& buffer,
+                                const log4cplus::spi::InternalLoggingEvent& event) override;
 
     protected:
         void init(const log4cplus::tstring& pattern, unsigned ndcMaxDepth = 0);
@@ -632,6 +647,7 @@ namespace log4cplus {
       // Data
         log4cplus::tstring pattern;
         std::vector<std::unique_ptr<pattern::PatternConverter> > parsedPattern;
+        std::unique_ptr<pattern::CompiledPattern> compiledPattern;
     };
 
 
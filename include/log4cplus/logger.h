@@ -47,6 +47,7 @@ namespace log4cplus
     class Hierarchy;
     class HierarchyLocker;
     class DefaultLoggerFactory;
+    class PropertyConfigurator;
 
     namespace spi
     {
@@ -264,6 +265,9 @@ namespace log4cplus
 
         virtual void removeAppender(const log4cplus::tstring& name);
 
+        virtual void replaceAllAppenders(
+            const SharedAppenderPtrList& newAppenders);
+
         Logger () LOG4CPLUS_NOEXCEPT;
         Logger(const Logger& rhs) LOG4CPLUS_NOEXCEPT;
         Logger& operator=(const Logger& rhs) LOG4CPLUS_NOEXCEPT;
@@ -302,6 +306,7 @@ namespace log4cplus
         friend class log4cplus::Hierarchy;
         friend class log4cplus::HierarchyLocker;
         friend class log4cplus::DefaultLoggerFactory;
+        friend class log4cplus::PropertyConfigurator;
     };
 
 
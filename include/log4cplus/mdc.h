@@ -33,11 +33,12 @@
 
 #include <log4cplus/tstring.h>
 
-#include <map>
 #include <unordered_map>
 #include <functional>
 #include <optional>
 #include <deque>
+#include <utility>
+#include <cstddef>
 
 
 namespace log4cplus
@@ -52,8 +53,114 @@ using MappedDiagnosticContextStacksMap
         helpers::tstring_hash, std::equal_to<>>;
 
 //! Mapped diagnostic context map, keys to values.
-using MappedDiagnosticContextMap = std::map<tstring, tstring,
-    std::less<>>;
+//!
+//! Entries are kept sorted by key in a single allocation that holds
+//! up to 8 entries before it has to grow. Copies share the storage and
+//! count references to it. Storage shared with a copy is copied only
+//! when the map is modified. This makes copying the thread's map into
+//! a logging event a cheap and immutable snapshot.
+//!
+//! Iterators give read only access to entries so that the keys stay
+//! sorted. Values are changed through operator[]() or at().
+class LOG4CPLUS_EXPORT MappedDiagnosticContextMap
+{
+public:
+    using key_type = tstring;
+    using mapped_type = tstring;
+    using value_type = std::pair<tstring, tstring>;
+    using size_type = std::size_t;
+    using const_iterator = value_type const *;
+    using iterator = const_iterator;
+
+    MappedDiagnosticContextMap () noexcept = default;
+    MappedDiagnosticContextMap (MappedDiagnosticContextMap const &) noexcept;
+    MappedDiagnosticContextMap (MappedDiagnosticContextMap && other) noexcept
+        : rep (std::exchange (other.rep, nullptr))
+    { }
+
+    ~MappedDiagnosticContextMap ();
+
+    MappedDiagnosticContextMap & operator = (
+        MappedDiagnosticContextMap const &) noexcept;
+    MappedDiagnosticContextMap & operator = (
+        MappedDiagnosticContextMap &&) noexcept;
+
+    void swap (MappedDiagnosticContextMap & other) noexcept
+    {
+        std::swap (rep, other.rep);
+    }
+
+    size_type size () const noexcept;
+    bool empty () const noexcept { return size () == 0; }
+
+    const_iterator begin () const noexcept;
+    const_iterator end () const noexcept { return begin () + size (); }
+    const_iterator cbegin () const noexcept { return begin (); }
+    const_iterator cend () const noexcept { return end (); }
+
+    const_iterator find (tstring_view const & key) const;
+    const_iterator lower_bound (tstring_view const & key) const
+    {
+        return begin () + lowerBound (key);
+    }
+
+    bool contains (tstring_view const & key) const
+    {
+        return find (key) != end ();
+    }
+
+    size_type count (tstring_view const & key) const
+    {
+        return contains (key) ? 1 : 0;
+    }
+
+    //! \throw std::out_of_range if there is no such key.
+    mapped_type const & at (tstring_view const & key) const;
+
+    //! \throw std::out_of_range if there is no such key. It unshares
+    //! the storage.
+    mapped_type & at (tstring_view const & key);
+
+    template <typename Key, typename Value>
+    std::pair<iterator, bool> emplace (Key && key, Value && value)
+    {
+        tstring_view const k (key);
+        size_type const pos = lowerBound (k);
+        if (pos != size () && begin ()[pos].first == k)
+            return {begin () + pos, false};
+
+        return {insertAt (pos, tstring (std::forward<Key> (key)),
+            tstring (std::forward<Value> (value))), true};
+    }
+
+    std::pair<iterator, bool> insert (value_type const & value)
+    {
+        return emplace (value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert (value_type && value)
+    {
+        return emplace (std::move (value.first), std::move (value.second));
+    }
+
+    mapped_type & operator [] (tstring_view const & key);
+    size_type erase (tstring_view const & key);
+    void clear () noexcept;
+
+    //! \return `true` if the storage is shared with a copy.
+    bool shared () const noexcept;
+
+    bool operator == (MappedDiagnosticContextMap const & other) const;
+
+private:
+    struct Rep;
+
+    size_type lowerBound (tstring_view const & key) const;
+    value_type * insertAt (size_type pos, tstring && key, tstring && value);
+    LOG4CPLUS_PRIVATE void detach ();
+
+    Rep * rep = nullptr;
+};
 
 //! Internal MDC storage.
 struct LOG4CPLUS_EXPORT MappedDiagnosticContext final
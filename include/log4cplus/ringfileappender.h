@@ -0,0 +1,174 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Haisman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_RING_FILE_APPENDER_HEADER_
+#define LOG4CPLUS_RING_FILE_APPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/appender.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+
+namespace log4cplus {
+
+    /**
+     * Header at the beginning of ring file written by RingFileAppender.
+     * All fields are stored in native byte order.
+     *
+     * Records are stored in data area that follows the header. Their
+     * positions are expressed as logical offsets that grow without
+     * wrapping; physical offset in data area is logical offset modulo
+     * <code>data_size</code>. Valid records occupy range from
+     * <code>tail</code> to <code>head</code>.
+     */
+    struct RingFileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        //! Offset of data area from the beginning of the file.
+        std::uint32_t header_size;
+        std::uint64_t data_size;
+        //! Logical offset of the oldest record.
+        std::uint64_t tail;
+        //! Logical offset where the next record will be written.
+        std::uint64_t head;
+        //! Sequence number of the next record.
+        std::uint64_t sequence;
+    };
+
+
+    /**
+     * Header of each record in ring file. It is followed by
+     * <code>size</code> bytes of formatted event and padding to
+     * multiple of 8 bytes. Record never wraps around the end of data
+     * area; unused space at the end of data area is either covered by
+     * padding record or, if it is shorter than record header, skipped.
+     */
+    struct RingRecordHeader
+    {
+        enum Type : std::uint32_t { RTEvent = 0, RTPadding = 1 };
+
+        std::uint32_t size;
+        std::uint32_t type;
+        std::uint64_t sequence;
+        //! Event timestamp in microseconds since the Unix epoch.
+        std::int64_t timestamp;
+    };
+
+
+    /**
+     * Reads records of ring file written by RingFileAppender, from the
+     * oldest to the newest, and passes each of them to
+     * <code>func</code>.
+     *
+     * \return `false` when the file cannot be read or it is not
+     * a ring file.
+     */
+    LOG4CPLUS_EXPORT bool readRingFile(const log4cplus::tstring& filename,
+        std::function<void (RingRecordHeader const &, std::string_view)> const&
+            func);
+
+
+    /**
+     * Writes formatted events into preallocated memory mapped file
+     * which is used as circular buffer. Appending an event does not
+     * involve any system call and the written data survive crash of the
+     * process in the kernel page cache. Each record carries its length,
+     * sequence number and timestamp, see RingRecordHeader. Use
+     * <tt>ringfilereader</tt> utility or readRingFile() to decode the
+     * file. Existing ring file of the same size is appended to.
+     *
+     * This appender is available only on platforms with POSIX
+     * <code>mmap()</code>.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>File</tt></dt>
+     * <dd>This property specifies output file name.</dd>
+     *
+     * <dt><tt>Size</tt></dt>
+     * <dd>This property specifies size of data area of the file. The
+     * value is in bytes. It is possible to use <tt>MB</tt> and
+     * <tt>KB</tt> suffixes to specify the value in megabytes or
+     * kilobytes instead. The default is 16 MB.</dd>
+     *
+     * <dt><tt>CreateDirs</tt></dt>
+     * <dd>Set this property to <tt>true</tt> if you want to create
+     * missing directories in path leading to the file.</dd>
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT RingFileAppender : public Appender {
+    public:
+      // Ctors
+        RingFileAppender(const log4cplus::tstring& filename,
+                         std::size_t size = 16 * 1024 * 1024,
+                         bool createDirs = false);
+        RingFileAppender(const log4cplus::helpers::Properties& properties);
+
+      // Dtor
+        virtual ~RingFileAppender();
+
+      // Methods
+        virtual void close() override;
+
+    protected:
+        virtual void append(const spi::InternalLoggingEvent& event) override;
+
+        void init();
+
+      // Data
+        log4cplus::tstring filename;
+        std::size_t dataSize;
+        bool createDirs;
+
+        //! Mapped file, its header and data area.
+        void * mapping;
+        std::size_t mappingSize;
+        RingFileHeader * header;
+        unsigned char * data;
+
+    private:
+        //! Moves tail past records that would be overwritten by writing
+        //! data area up to logical offset <code>end</code>.
+        LOG4CPLUS_PRIVATE void reserve(std::uint64_t end);
+
+      // Disallow copying of instances of this class
+        RingFileAppender(const RingFileAppender&);
+        RingFileAppender& operator=(const RingFileAppender&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_RING_FILE_APPENDER_HEADER_
@@ -35,6 +35,7 @@
 #include <log4cplus/thread/syncprims.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/helpers/connectorthread.h>
+#include <log4cplus/helpers/spool.h>
 
 
 namespace log4cplus
@@ -66,10 +67,12 @@ namespace log4cplus
      *   at the server.
      *
      *   <li>If the remote server is down, the logging requests are
-     *   simply dropped. However, if and when the server comes back up,
-     *   then event transmission is resumed transparently. This
-     *   transparent reconnection is performed by a <em>connector</em>
-     *   thread which periodically attempts to connect to the server.
+     *   simply dropped, unless spool is configured, see below. However,
+     *   if and when the server comes back up, then event transmission
+     *   is resumed transparently. This transparent reconnection is
+     *   performed by a <em>connector</em> thread which periodically
+     *   attempts to connect to the server. Events stored in the spool
+     *   are sent by the connector thread before new events.
      *
      *   <li>Logging events are automatically <em>buffered</em> by the
      *   native TCP implementation. This means that if the link to the server
@@ -100,6 +103,12 @@ namespace log4cplus
      * <dd>Boolean value specifying whether to use IPv6 (true) or IPv4
      * (false). Default value is false.</dd>
      *
+     * <dt><tt>SpoolSize</tt>, <tt>SpoolFile</tt>,
+     * <tt>SpoolFileSize</tt></dt>
+     * <dd>Bounded store for events appended while the appender is not
+     * connected, see helpers::Spool. Events in the spool can be sent
+     * twice if the connection fails while they are being sent.</dd>
+     *
      * </dl>
      */
     class LOG4CPLUS_EXPORT SocketAppender
@@ -129,18 +138,24 @@ namespace log4cplus
         void initConnector ();
         virtual void append(const spi::InternalLoggingEvent& event) override;
 
+        //! Sends events stored in spool.
+        //! \return `false` if the connection failed.
+        bool replaySpool ();
+
       // Data
         log4cplus::helpers::Socket socket;
         log4cplus::tstring host;
         unsigned int port;
         log4cplus::tstring serverName;
         bool ipv6 = false;
+        helpers::Spool spool;
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
         virtual thread::Mutex const & ctcGetAccessMutex () const override;
         virtual helpers::Socket & ctcGetSocket () override;
         virtual helpers::Socket ctcConnect () override;
         virtual void ctcSetConnected () override;
+        virtual bool ctcReplay () override;
 
         volatile bool connected;
         helpers::SharedObjectPtr<helpers::ConnectorThread> connector;
@@ -78,6 +78,15 @@ namespace log4cplus {
              */
             virtual void removeAppender(const log4cplus::tstring& name) = 0;
 
+            /**
+             * Replace all attached appenders with <code>newAppenders</code>.
+             * Implementations should make the change visible to logging
+             * threads at once. The default implementation removes all
+             * appenders and adds the new ones one by one.
+             */
+            virtual void replaceAllAppenders(
+                const SharedAppenderPtrList& newAppenders);
+
           // Dtor
             virtual ~AppenderAttachable() = 0;
         };
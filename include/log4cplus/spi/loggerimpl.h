@@ -34,6 +34,8 @@
 #include <log4cplus/helpers/appenderattachableimpl.h>
 #include <log4cplus/helpers/pointer.h>
 #include <log4cplus/spi/loggerfactory.h>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -111,9 +113,10 @@ namespace log4cplus {
             LogLevel getLogLevel() const { return this->ll; }
 
             /**
-             * Set the LogLevel of this Logger.
+             * Set the LogLevel of this Logger. This invalidates cached
+             * chained LogLevel of all loggers in the hierarchy.
              */
-            void setLogLevel(LogLevel _ll) { this->ll = _ll; }
+            void setLogLevel(LogLevel _ll);
 
             /**
              * Return the {@link Hierarchy} where this <code>Logger</code>
@@ -124,7 +127,13 @@ namespace log4cplus {
             /**
              * Return the logger name.
              */
-            log4cplus::tstring const & getName() const { return name; }
+            log4cplus::tstring const & getName() const { return *name; }
+
+            /**
+             * Return shared handle of the logger name. Events logged
+             * through this logger share the name with it.
+             */
+            tstring_handle const & getNameHandle() const { return name; }
 
             /**
              * Get the additivity flag for this Logger instance.
@@ -174,7 +183,7 @@ namespace log4cplus {
 
           // Data
             /** The name of this logger */
-            log4cplus::tstring name;
+            tstring_handle name;
 
             /**
              * The assigned LogLevel of this logger.
@@ -199,10 +208,32 @@ namespace log4cplus {
             bool additive;
 
         private:
+          // Methods
+            /**
+             * Returns the result of getChainedLogLevel() cached until
+             * invalidateLogLevelCache() is called.
+             */
+            LOG4CPLUS_PRIVATE LogLevel getCachedChainedLogLevel() const;
+
+            /**
+             * Marks the cached chained LogLevel as stale for log level
+             * <code>generation</code> of the hierarchy.
+             */
+            LOG4CPLUS_PRIVATE void invalidateLogLevelCache(
+                std::uint32_t generation);
+
           // Data
             /** Loggers need to know what Hierarchy they are in. */
             Hierarchy& hierarchy;
 
+            /**
+             * Cached result of getChainedLogLevel(). The upper 31 bits
+             * hold the log level generation of the hierarchy in which the
+             * cache has been invalidated the last time, the next bit is
+             * set when the lower 32 bits hold valid LogLevel.
+             */
+            mutable std::atomic<std::uint64_t> cachedChainedLogLevel;
+
           // Friends
             friend class log4cplus::Logger;
             friend class log4cplus::DefaultLoggerFactory;
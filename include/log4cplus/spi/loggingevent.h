@@ -31,6 +31,7 @@
 #endif
 
 #include <memory>
+#include <vector>
 #include <log4cplus/loglevel.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/mdc.h>
@@ -83,6 +84,16 @@ namespace log4cplus {
             InternalLoggingEvent(
                 const log4cplus::spi::InternalLoggingEvent& rhs);
 
+            /**
+             * Moves all data of <code>rhs</code> into the new instance.
+             * Thread specific data not yet gathered by <code>rhs</code>
+             * will be gathered lazily by the new instance, so both have
+             * to be used on the same thread until
+             * gatherThreadSpecificData() is called.
+             */
+            InternalLoggingEvent(
+                log4cplus::spi::InternalLoggingEvent&& rhs) noexcept;
+
             virtual ~InternalLoggingEvent();
 
             void setLoggingEvent (const log4cplus::tstring_view & logger,
@@ -90,6 +101,15 @@ namespace log4cplus {
                 const char * filename, int line,
                 const char * function = nullptr);
 
+            /**
+             * Same as the above but the logger name is shared with
+             * <code>logger</code> handle instead of being copied.
+             */
+            void setLoggingEvent (tstring_handle const & logger,
+                LogLevel ll, const log4cplus::tstring_view & message,
+                const char * filename, int line,
+                const char * function = nullptr);
+
             void setFunction (char const * func);
             void setFunction (log4cplus::tstring_view const &);
 
@@ -116,7 +136,9 @@ namespace log4cplus {
              */
             const log4cplus::tstring& getLoggerName() const
             {
-                return loggerName;
+                if (packedFields & PFLogger)
+                    unpackFields (PFLogger);
+                return *loggerName;
             }
 
             /** LogLevel of logging event. */
@@ -128,7 +150,9 @@ namespace log4cplus {
             /** The nested diagnostic context (NDC) of logging event. */
             const log4cplus::tstring& getNDC() const
             {
-                if (!ndcCached)
+                if (packedFields & PFNdc)
+                    unpackFields (PFNdc);
+                else if (!ndcCached)
                 {
                     ndc = log4cplus::getNDC().get();
                     ndcCached = true;
@@ -138,7 +162,9 @@ namespace log4cplus {
 
             MappedDiagnosticContextMap const & getMDCCopy () const
             {
-                if (!mdcCached)
+                if (packedFields & PFMdc)
+                    unpackFields (PFMdc);
+                else if (!mdcCached)
                 {
                     mdc = log4cplus::getMDC().getContext ();
                     mdcCached = true;
@@ -151,24 +177,28 @@ namespace log4cplus {
             /** The name of thread in which this logging event was generated. */
             const log4cplus::tstring& getThread() const
             {
-                if (! threadCached)
+                if (packedFields & PFThread)
+                    unpackFields (PFThread);
+                else if (! threadCached)
                 {
-                    thread = thread::getCurrentThreadName ();
+                    thread = thread::getCurrentThreadNameHandle ();
                     threadCached = true;
                 }
-                return thread;
+                return *thread;
             }
 
             //! The alternative name of thread in which this logging event
             //! was generated.
             const log4cplus::tstring& getThread2() const
             {
-                if (! thread2Cached)
+                if (packedFields & PFThread2)
+                    unpackFields (PFThread2);
+                else if (! thread2Cached)
                 {
-                    thread2 = thread::getCurrentThreadName2 ();
+                    thread2 = thread::getCurrentThreadName2Handle ();
                     thread2Cached = true;
                 }
-                return thread2;
+                return *thread2;
             }
 
 
@@ -181,6 +211,8 @@ namespace log4cplus {
             /** The is the file where this log statement was written */
             const log4cplus::tstring& getFile() const
             {
+                if (packedFields & PFFile)
+                    unpackFields (PFFile);
                 return file;
             }
 
@@ -189,6 +221,8 @@ namespace log4cplus {
 
             log4cplus::tstring const & getFunction () const
             {
+                if (packedFields & PFFunction)
+                    unpackFields (PFFunction);
                 return function;
             }
 
@@ -196,25 +230,70 @@ namespace log4cplus {
 
             void swap (InternalLoggingEvent &);
 
+            /**
+             * Appends compact representation of this event to the end of
+             * <code>buffer</code>. Thread specific data are gathered
+             * first. All strings, including MDC keys and values, are
+             * stored in one contiguous record behind a fixed size header
+             * with their offsets.
+             */
+            void pack (std::vector<char> & buffer) const;
+
+            /**
+             * Replaces contents of this event with event stored by
+             * pack() at <code>record</code>. Only the log level, line and
+             * time stamp are read immediately. Strings and MDC are
+             * decoded by the first call of their getter, into existing
+             * string buffers of this event. Until then the event refers
+             * to <code>record</code>, which has to stay unchanged while
+             * the event is used. Copies of the event do not refer to the
+             * record.
+             *
+             * @return Pointer to the record following the unpacked one.
+             */
+            char const * unpack (char const * record);
+
+            /**
+             * @return Size in bytes of the record stored by pack() at
+             * <code>record</code>.
+             */
+            static std::size_t packedSize (char const * record);
+
+            /**
+             * @return Log level of the event stored by pack() at
+             * <code>record</code>, without unpacking it.
+             */
+            static LogLevel packedLogLevel (char const * record);
+
           // public operators
             log4cplus::spi::InternalLoggingEvent&
             operator=(const log4cplus::spi::InternalLoggingEvent& rhs);
 
+            /**
+             * Swaps contents with <code>rhs</code>. The moved-from
+             * instance keeps previous contents of this instance so that
+             * its string buffers can be reused by setLoggingEvent().
+             */
+            InternalLoggingEvent &
+            operator=(log4cplus::spi::InternalLoggingEvent&& rhs) noexcept;
+
           // static methods
             static unsigned int getDefaultType();
 
         protected:
           // Data
-            log4cplus::tstring message;
-            log4cplus::tstring loggerName;
+            mutable log4cplus::tstring message;
+            /** Logger name, shared with LoggerImpl when possible. */
+            mutable tstring_handle loggerName;
             LogLevel ll;
             mutable log4cplus::tstring ndc;
             mutable MappedDiagnosticContextMap mdc;
-            mutable log4cplus::tstring thread;
-            mutable log4cplus::tstring thread2;
+            /** Thread names, shared with per thread data. */
+            mutable tstring_handle thread;
+            mutable tstring_handle thread2;
             log4cplus::helpers::Time timestamp;
-            log4cplus::tstring file;
-            log4cplus::tstring function;
+            mutable log4cplus::tstring file;
+            mutable log4cplus::tstring function;
             int line;
             /** Indicates whether or not the Threadname has been retrieved. */
             mutable bool threadCached;
@@ -223,6 +302,35 @@ namespace log4cplus {
             mutable bool ndcCached;
             /** Indicates whether or not the MDC has been retrieved. */
             mutable bool mdcCached;
+
+            //! Fields not yet decoded from the record the event has been
+            //! unpacked from, see unpack().
+            enum PackedField : unsigned
+            {
+                PFMessage = 1 << 0,
+                PFLogger = 1 << 1,
+                PFNdc = 1 << 2,
+                PFThread = 1 << 3,
+                PFThread2 = 1 << 4,
+                PFFile = 1 << 5,
+                PFFunction = 1 << 6,
+                PFMdc = 1 << 7,
+                PFAll = (1 << 8) - 1
+            };
+
+            //! Decodes given fields from <code>packedRecord</code>
+            //! unless they have been decoded already.
+            void unpackFields (unsigned fields) const;
+
+            //! Record passed to unpack() and set of its fields not yet
+            //! decoded.
+            mutable char const * packedRecord;
+            mutable unsigned packedFields;
+
+        private:
+            void setLoggingEventData (LogLevel ll,
+                const log4cplus::tstring_view & message,
+                const char * filename, int line, const char * function);
         };
 
     } // end namespace spi
@@ -33,6 +33,7 @@
 #include <log4cplus/appender.h>
 #include <log4cplus/helpers/socket.h>
 #include <log4cplus/helpers/connectorthread.h>
+#include <log4cplus/helpers/spool.h>
 
 
 namespace log4cplus
@@ -75,6 +76,13 @@ namespace log4cplus
      * <dd>Boolean value specifying whether to use FQDN for hostname field.
      * Default value is true.</dd>
      *
+     * <dt><tt>SpoolSize</tt>, <tt>SpoolFile</tt>,
+     * <tt>SpoolFileSize</tt></dt>
+     * <dd>Bounded store for messages to remote syslog that are appended
+     * while the appender is not connected, see helpers::Spool. The
+     * messages are sent once the connection is re-established, before
+     * new messages.</dd>
+     *
      * </dl>
      *
      * \note Messages sent to remote syslog using UDP are conforming
@@ -123,6 +131,10 @@ namespace log4cplus
         //! Remote syslog worker function.
         void appendRemote(const spi::InternalLoggingEvent& event);
 
+        //! Sends messages stored in spool.
+        //! \return `false` if the connection failed.
+        bool replaySpool ();
+
       // Data
         tstring ident;
         int facility;
@@ -137,6 +149,7 @@ namespace log4cplus
         helpers::Socket syslogSocket;
         bool connected;
         bool ipv6 = false;
+        helpers::Spool spool;
 
         static tstring const remoteTimeFormat;
 
@@ -148,6 +161,7 @@ namespace log4cplus
         virtual helpers::Socket & ctcGetSocket () override;
         virtual helpers::Socket ctcConnect () override;
         virtual void ctcSetConnected () override;
+        virtual bool ctcReplay () override;
 
         helpers::SharedObjectPtr<helpers::ConnectorThread> connector;
 #endif
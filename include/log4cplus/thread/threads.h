@@ -42,6 +42,10 @@ namespace log4cplus { namespace thread {
 
 LOG4CPLUS_EXPORT log4cplus::tstring const & getCurrentThreadName();
 LOG4CPLUS_EXPORT log4cplus::tstring const & getCurrentThreadName2();
+//! Same as getCurrentThreadName() but returns shared handle of the name.
+LOG4CPLUS_EXPORT log4cplus::tstring_handle const & getCurrentThreadNameHandle();
+//! Same as getCurrentThreadName2() but returns shared handle of the name.
+LOG4CPLUS_EXPORT log4cplus::tstring_handle const & getCurrentThreadName2Handle();
 LOG4CPLUS_EXPORT void setCurrentThreadName(const log4cplus::tstring & name);
 LOG4CPLUS_EXPORT void setCurrentThreadName2(const log4cplus::tstring & name);
 LOG4CPLUS_EXPORT void yield();
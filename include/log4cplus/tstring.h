@@ -32,6 +32,7 @@
 
 #include <type_traits>
 #include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <log4cplus/tchar.h>
@@ -42,6 +43,10 @@ namespace log4cplus
 using tstring = std::basic_string<tchar>;
 using tstring_view = std::basic_string_view<tchar>;
 
+//! Handle of immutable shared string. Copying the handle does not
+//! depend on the length of the string.
+using tstring_handle = std::shared_ptr<tstring const>;
+
 namespace helpers
 {
 
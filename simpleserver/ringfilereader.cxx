@@ -0,0 +1,117 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Haisman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <log4cplus/ringfileappender.h>
+#include <log4cplus/initializer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/tstring.h>
+
+
+namespace ringfilereader
+{
+
+void
+usage (char const * program)
+{
+    std::cerr << "Usage: " << program << " [-v] <ring file>\n"
+        "Prints events stored by RingFileAppender from the oldest to the"
+        " newest.\n"
+        "  -v  prefix each event with its sequence number and timestamp\n";
+}
+
+
+void
+print_header (log4cplus::RingRecordHeader const & rec)
+{
+    std::time_t const secs = static_cast<std::time_t>(
+        rec.timestamp / 1000000);
+    long const usecs = static_cast<long>(rec.timestamp % 1000000);
+    std::tm tm_buf {};
+#if defined (_WIN32)
+    gmtime_s (&tm_buf, &secs);
+#else
+    gmtime_r (&secs, &tm_buf);
+#endif
+
+    char time_str[32];
+    std::strftime (time_str, sizeof (time_str), "%Y-%m-%dT%H:%M:%S",
+        &tm_buf);
+
+    char usecs_str[8];
+    std::snprintf (usecs_str, sizeof (usecs_str), "%06ld", usecs);
+
+    std::cout << rec.sequence << ' ' << time_str << '.' << usecs_str
+        << "Z ";
+}
+
+} // namespace ringfilereader
+
+
+int
+main (int argc, char * argv[])
+{
+    using namespace ringfilereader;
+
+    bool verbose = false;
+    char const * file_name = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp (argv[i], "-v") == 0)
+            verbose = true;
+        else if (! file_name)
+            file_name = argv[i];
+        else
+        {
+            usage (argv[0]);
+            return 2;
+        }
+    }
+
+    if (! file_name)
+    {
+        usage (argv[0]);
+        return 2;
+    }
+
+    log4cplus::Initializer initializer;
+
+    bool const ok = log4cplus::readRingFile (
+        LOG4CPLUS_C_STR_TO_TSTRING (file_name),
+        [verbose] (log4cplus::RingRecordHeader const & rec,
+            std::string_view msg) {
+            if (verbose)
+                print_header (rec);
+            std::cout.write (msg.data (),
+                static_cast<std::streamsize>(msg.size ()));
+        });
+    std::cout.flush ();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -20,6 +20,7 @@
 
 #include <log4cplus/appender.h>
 #include <log4cplus/layout.h>
+#include <log4cplus/helpers/eventcounter.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/pointer.h>
 #include <log4cplus/helpers/stringhelper.h>
@@ -28,10 +29,17 @@
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/internal/internal.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <chrono>
 #include <memory>
 #include <stdexcept>
 #include <utility>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <map>
+#include <thread>
+#include <catch_amalgamated.hpp>
+#endif
+
 
 namespace log4cplus
 {
@@ -90,8 +98,12 @@ Appender::Appender()
    errorHandler(new OnlyOnceErrorHandler),
    useLockFile(false),
    async(false),
+   formatOutsideLock(false),
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
    in_flight(0),
+   async_queue_head(0),
+   async_queue_count(0),
+   async_drain_scheduled(false),
 #endif
    closed(false)
 {
@@ -105,8 +117,12 @@ Appender::Appender(const log4cplus::helpers::Properties & properties)
     , errorHandler(new OnlyOnceErrorHandler)
     , useLockFile(false)
     , async(false)
+    , formatOutsideLock(false)
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
     , in_flight(0)
+    , async_queue_head(0)
+    , async_queue_count(0)
+    , async_drain_scheduled(false)
 #endif
     , closed(false)
 {
@@ -212,6 +228,13 @@ Appender::Appender(const log4cplus::helpers::Properties & properties)
 
     // Deal with asynchronous append flag.
     properties.getBool (async, LOG4CPLUS_TEXT("AsyncAppend"));
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (async)
+        asyncOverflow.configure (properties);
+#endif
+
+    properties.getBool (formatOutsideLock,
+        LOG4CPLUS_TEXT("FormatOutsideLock"));
 }
 
 
@@ -219,8 +242,9 @@ Appender::~Appender()
 {
     helpers::LogLog & loglog = helpers::getLogLog ();
 
-    loglog.debug(LOG4CPLUS_TEXT("Destroying appender named [") + name
-        + LOG4CPLUS_TEXT("]."));
+    if (loglog.isDebugEnabled ())
+        loglog.debug(LOG4CPLUS_TEXT("Destroying appender named [") + name
+            + LOG4CPLUS_TEXT("]."));
 
     if (! closed)
         loglog.error (
@@ -274,12 +298,12 @@ bool Appender::isClosed() const
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
 void
-Appender::subtract_in_flight ()
+Appender::subtract_in_flight (std::size_t count)
 {
 #if defined (LOG4CPLUS_ENABLE_THREAD_POOL)
     std::size_t const prev = std::atomic_fetch_sub_explicit (&in_flight,
-        std::size_t (1), std::memory_order_acq_rel);
-    if (prev == 1)
+        count, std::memory_order_acq_rel);
+    if (prev == count)
     {
         std::unique_lock<std::mutex> lock (in_flight_mutex);
         in_flight_condition.notify_all ();
@@ -291,31 +315,198 @@ Appender::subtract_in_flight ()
 
 
 // from global-init.cxx
-void enqueueAsyncDoAppend (SharedAppenderPtr const & appender,
-    spi::InternalLoggingEvent const & event);
+bool enqueueAsyncDrain (SharedAppenderPtr const & appender);
+std::size_t getAsyncQueueSizeLimit ();
+bool getThreadPoolBlockOnFull ();
 
 
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+namespace
+{
+
+//! Counts events dropped because of full asynchronous queue and
+//! reports them through LogLog at most once per 5 minutes.
 void
-Appender::doAppend(const log4cplus::spi::InternalLoggingEvent& event)
+recordDroppedAsyncEvent ()
+{
+    static helpers::SteadyClockGate gate (
+        helpers::SteadyClockGate::Duration {std::chrono::minutes (5)});
+
+    gate.record_event ();
+    helpers::SteadyClockGate::Info info;
+    if (gate.latch_open (info))
+    {
+        helpers::LogLog & loglog = helpers::getLogLog ();
+        log4cplus::tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("Asynchronous logging queue is full. Dropped ")
+            << info.count << LOG4CPLUS_TEXT (" events in last ")
+            << std::chrono::duration_cast<std::chrono::seconds> (info.time_span).count ()
+            << LOG4CPLUS_TEXT (" seconds");
+        loglog.warn (oss.str ());
+    }
+}
+
+} // namespace
+
+
+bool
+Appender::enqueueAsyncDoAppend(const log4cplus::spi::InternalLoggingEvent& event,
+    bool block)
+{
+    event.gatherThreadSpecificData ();
+    LogLevel const ll = event.getLogLevel ();
+
+    bool schedule = false;
+    bool evicted = false;
+    {
+        std::unique_lock<std::mutex> lock (async_queue_mutex);
+        std::size_t const limit = getAsyncQueueSizeLimit ();
+        while (limit != 0)
+        {
+            helpers::OverflowPolicy::Decision const decision
+                = asyncOverflow.decide (ll, async_queue_count, limit);
+            if (decision == helpers::OverflowPolicy::ODAccept)
+                break;
+            else if (decision == helpers::OverflowPolicy::ODWait && block)
+                async_queue_space.wait (lock);
+            else if (decision == helpers::OverflowPolicy::ODEvict
+                && asyncOverflow.evictPacked (async_queue, async_queue_head,
+                    async_queue_count))
+            {
+                // The new event replaces the evicted one and takes over
+                // its in_flight count.
+                --async_queue_count;
+                evicted = true;
+                break;
+            }
+            else
+            {
+                lock.unlock ();
+                asyncOverflow.recordDrop (ll);
+                return false;
+            }
+        }
+
+        event.pack (async_queue);
+        ++async_queue_count;
+        if (! evicted)
+            std::atomic_fetch_add_explicit (&in_flight, std::size_t (1),
+                std::memory_order_relaxed);
+        if (! async_drain_scheduled)
+            schedule = async_drain_scheduled = true;
+    }
+
+    if (evicted)
+        recordDroppedAsyncEvent ();
+
+    if (! schedule)
+        return true;
+
+    bool enqueued = false;
+    try
+    {
+        enqueued = enqueueAsyncDrain (SharedAppenderPtr (this));
+    }
+    catch (...)
+    {
+        // The event is already queued. Fall through and append it on
+        // this thread.
+    }
+
+    // Without thread pool, e.g., during shutdown, append the events on
+    // this thread. Local buffers are used because this thread might
+    // already be in the middle of draining another appender's queue.
+    if (! enqueued)
+    {
+        std::vector<char> records;
+        std::vector<spi::InternalLoggingEvent> events;
+        drainAsyncQueueImpl (records, events);
+    }
+
+    return true;
+}
+#endif
+
+
+void
+Appender::drainAsyncQueue()
 {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED) \
     && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
-    if (async)
+    internal::per_thread_data * ptd = internal::get_ptd ();
+    drainAsyncQueueImpl (ptd->async_records, ptd->unpacked_events);
+#endif
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+void
+Appender::drainAsyncQueueImpl(std::vector<char> & records,
+    std::vector<log4cplus::spi::InternalLoggingEvent> & events)
+{
+    for (;;)
     {
-        event.gatherThreadSpecificData ();
+        std::size_t count;
+        std::size_t head;
+        {
+            std::unique_lock<std::mutex> lock (async_queue_mutex);
+            if (async_queue_count == 0)
+            {
+                async_drain_scheduled = false;
+                return;
+            }
 
-        std::atomic_fetch_add_explicit (&in_flight, std::size_t (1),
-            std::memory_order_relaxed);
+            // Swap the buffers so that the producers keep appending into
+            // already allocated storage.
+            records.clear ();
+            records.swap (async_queue);
+            head = async_queue_head;
+            async_queue_head = 0;
+            count = async_queue_count;
+            async_queue_count = 0;
+        }
+        async_queue_space.notify_all ();
+
+        // The whole run is appended as one batch, under one appender
+        // lock and with one write for appenders supporting it.
+        events.resize (count);
+        char const * record = records.data () + head;
+        for (auto & ev : events)
+            record = ev.unpack (record);
 
         try
         {
-            enqueueAsyncDoAppend (SharedAppenderPtr (this), event);
+            syncDoAppendBatch (events);
+        }
+        catch (std::exception const & e)
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Asynchronous append failed: ")
+                + LOG4CPLUS_C_STR_TO_TSTRING (e.what ()));
         }
         catch (...)
         {
-            subtract_in_flight ();
-            throw;
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Asynchronous append failed."));
         }
+
+        subtract_in_flight (count);
+    }
+}
+#endif
+
+
+void
+Appender::doAppend(const log4cplus::spi::InternalLoggingEvent& event)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+    if (async)
+    {
+        if (! enqueueAsyncDoAppend (event, getThreadPoolBlockOnFull ()))
+            recordDroppedAsyncEvent ();
     }
     else
 #endif
@@ -323,6 +514,37 @@ Appender::doAppend(const log4cplus::spi::InternalLoggingEvent& event)
 }
 
 
+std::size_t
+Appender::getAsyncDropCount(LogLevel ll) const
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    return asyncOverflow.getDropCount (ll);
+#else
+    return 0;
+#endif
+}
+
+
+bool
+Appender::tryDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+    if (async)
+    {
+        if (enqueueAsyncDoAppend (event, false))
+            return true;
+
+        recordDroppedAsyncEvent ();
+        return false;
+    }
+#endif
+
+    syncDoAppend (event);
+    return true;
+}
+
+
 void
 Appender::asyncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
 {
@@ -353,6 +575,40 @@ Appender::asyncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
 void
 Appender::syncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
 {
+    // Marks event formatted for this appender in thread local buffer so
+    // that formatEvent() called from append() returns it as it is.
+    struct preformatted_guard
+    {
+        internal::appender_sratch_pad * sp = nullptr;
+
+        ~preformatted_guard ()
+        {
+            if (sp)
+            {
+                sp->formatted_appender = nullptr;
+                sp->formatted_event = nullptr;
+            }
+        }
+    };
+
+    // The layout has to stay the same until the preformatted event is
+    // appended.
+    std::shared_lock<std::shared_mutex> lf_guard;
+    preformatted_guard preformatted;
+    if (formatOutsideLock)
+    {
+        lf_guard = std::shared_lock<std::shared_mutex> (layoutFilterMutex);
+
+        if (! isAccepted(event))
+            return;
+
+        formatEvent (event);
+
+        preformatted.sp = &internal::get_appender_sp ();
+        preformatted.sp->formatted_appender = this;
+        preformatted.sp->formatted_event = &event;
+    }
+
     thread::MutexGuard guard (access_mutex);
 
     if(closed) {
@@ -363,16 +619,50 @@ Appender::syncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
         return;
     }
 
-    // Check appender's threshold logging level.
+    // Check appender's threshold logging level and evaluate filters
+    // attached to this appender.
 
-    if (! isAsSevereAsThreshold(event.getLogLevel()))
+    if (! formatOutsideLock && ! isAccepted(event))
         return;
 
-    // Evaluate filters attached to this appender.
+    // Lock system wide lock.
 
-    if (checkFilter(filter.get(), event) == spi::FilterResult::DENY)
+    helpers::LockFileGuard lfguard;
+    if (useLockFile && lockFile.get ())
+    {
+        try
+        {
+            lfguard.attach_and_lock (*lockFile);
+        }
+        catch (std::runtime_error const &)
+        {
+            return;
+        }
+    }
+
+    // Finally append given event.
+
+    append(event);
+}
+
+
+void
+Appender::syncDoAppendBatch(
+    std::span<const spi::InternalLoggingEvent> events)
+{
+    if (events.empty ())
         return;
 
+    thread::MutexGuard guard (access_mutex);
+
+    if(closed) {
+        helpers::getLogLog().error(
+            LOG4CPLUS_TEXT("Attempted to append to closed appender named [")
+            + name
+            + LOG4CPLUS_TEXT("]."));
+        return;
+    }
+
     // Lock system wide lock.
 
     helpers::LockFileGuard lfguard;
@@ -388,9 +678,44 @@ Appender::syncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
         }
     }
 
-    // Finally append given event.
+    // Finally append given events. Threshold and filters are checked
+    // by appendBatch(). FormatOutsideLock does not apply to batches,
+    // they are formatted under access_mutex.
 
-    append(event);
+    appendBatch(events);
+}
+
+
+void
+Appender::doAppendBatch(std::span<const spi::InternalLoggingEvent> events)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+    if (async)
+    {
+        for (auto const & event : events)
+            doAppend (event);
+    }
+    else
+#endif
+        syncDoAppendBatch (events);
+}
+
+
+void
+Appender::appendBatch(std::span<const spi::InternalLoggingEvent> events)
+{
+    for (auto const & event : events)
+        if (isAccepted (event))
+            append (event);
+}
+
+
+bool
+Appender::isAccepted(const spi::InternalLoggingEvent& event)
+{
+    return isAsSevereAsThreshold(event.getLogLevel())
+        && checkFilter(filter.get(), event) != spi::FilterResult::DENY;
 }
 
 
@@ -398,9 +723,14 @@ tstring &
 Appender::formatEvent (const spi::InternalLoggingEvent& event) const
 {
     internal::appender_sratch_pad & appender_sp = internal::get_appender_sp ();
-    detail::clear_tostringstream (appender_sp.oss);
-    layout->formatAndAppend(appender_sp.oss, event);
-    appender_sp.str = appender_sp.oss.str();
+    if (appender_sp.formatted_appender == this
+        && appender_sp.formatted_event == &event)
+        return appender_sp.str;
+
+    appender_sp.formatted_appender = nullptr;
+    appender_sp.formatted_event = nullptr;
+    appender_sp.str.clear ();
+    layout->formatInto(appender_sp.str, event);
     return appender_sp.str;
 }
 
@@ -450,6 +780,7 @@ Appender::setErrorHandler(std::unique_ptr<ErrorHandler> eh)
 void
 Appender::setLayout(std::unique_ptr<Layout> lo)
 {
+    std::unique_lock<std::shared_mutex> lf_guard (layoutFilterMutex);
     thread::MutexGuard guard (access_mutex);
 
     this->layout = std::move(lo);
@@ -469,6 +800,7 @@ Appender::getLayout()
 void
 Appender::setFilter(log4cplus::spi::FilterPtr f)
 {
+    std::unique_lock<std::shared_mutex> lf_guard (layoutFilterMutex);
     thread::MutexGuard guard (access_mutex);
 
     filter = std::move (f);
@@ -487,15 +819,13 @@ Appender::getFilter() const
 void
 Appender::addFilter (log4cplus::spi::FilterPtr f)
 {
+    std::unique_lock<std::shared_mutex> lf_guard (layoutFilterMutex);
     thread::MutexGuard guard (access_mutex);
 
-    log4cplus::spi::FilterPtr filterChain = getFilter ();
-    if (filterChain)
-        filterChain->appendFilter (std::move (f));
+    if (filter)
+        filter->appendFilter (std::move (f));
     else
-        filterChain = std::move (f);
-
-    setFilter (filterChain);
+        filter = std::move (f);
 }
 
 
@@ -508,4 +838,178 @@ Appender::addFilter (std::function<
 }
 
 
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+namespace
+{
+
+class RecordingAppender
+    : public Appender
+{
+public:
+    explicit RecordingAppender (helpers::Properties const & props)
+        : Appender (props)
+    { }
+
+    ~RecordingAppender () override
+    {
+        destructorImpl ();
+    }
+
+    void
+    close () override
+    {
+        closed = true;
+    }
+
+    std::vector<tstring> messages;
+
+protected:
+    void
+    append (spi::InternalLoggingEvent const & event) override
+    {
+        messages.push_back (event.getMessage ());
+    }
+};
+
+
+class BlockingAppender
+    : public RecordingAppender
+{
+public:
+    using RecordingAppender::RecordingAppender;
+
+    std::atomic<bool> entered {false};
+    std::atomic<bool> release {false};
+
+protected:
+    void
+    append (spi::InternalLoggingEvent const & event) override
+    {
+        entered = true;
+        while (! release)
+            std::this_thread::yield ();
+        RecordingAppender::append (event);
+    }
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("Asynchronous append order", "[appender]")
+{
+    helpers::Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("AsyncAppend"), LOG4CPLUS_TEXT ("true"));
+    helpers::SharedObjectPtr<RecordingAppender> appender (
+        new RecordingAppender (props));
+
+    unsigned const threads_count = 4;
+    unsigned const per_thread = 2000;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t != threads_count; ++t)
+        threads.emplace_back ([&appender, t] {
+            tstring const prefix = helpers::convertIntegerToString (t)
+                + LOG4CPLUS_TEXT (":");
+            for (unsigned i = 0; i != per_thread; ++i)
+                appender->doAppend (spi::InternalLoggingEvent (
+                    LOG4CPLUS_TEXT ("test"), INFO_LOG_LEVEL,
+                    prefix + helpers::convertIntegerToString (i),
+                    __FILE__, __LINE__));
+        });
+    for (auto & thread : threads)
+        thread.join ();
+
+    appender->waitToFinishAsyncLogging ();
+    CATCH_REQUIRE (appender->messages.size () == threads_count * per_thread);
+
+    // Events of each thread have to be appended in the order in which
+    // they were logged.
+    std::map<tstring, unsigned> next;
+    for (tstring const & msg : appender->messages)
+    {
+        tstring::size_type const colon = msg.find (LOG4CPLUS_TEXT (':'));
+        CATCH_REQUIRE (colon != tstring::npos);
+        unsigned & expected = next[msg.substr (0, colon)];
+        CATCH_REQUIRE (msg.substr (colon + 1)
+            == helpers::convertIntegerToString (expected));
+        ++expected;
+    }
+    CATCH_REQUIRE (next.size () == threads_count);
+
+    appender->close ();
+}
+
+
+CATCH_TEST_CASE ("Asynchronous append with full queue", "[appender]")
+{
+    helpers::Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("AsyncAppend"), LOG4CPLUS_TEXT ("true"));
+    helpers::SharedObjectPtr<BlockingAppender> appender (
+        new BlockingAppender (props));
+    spi::InternalLoggingEvent const event (LOG4CPLUS_TEXT ("test"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+
+    std::size_t const limit = 4;
+    setThreadPoolQueueSizeLimit (limit);
+
+    // The first event keeps the drain task busy in append().
+    CATCH_REQUIRE (appender->tryDoAppend (event));
+    while (! appender->entered)
+        std::this_thread::yield ();
+
+    for (std::size_t i = 0; i != limit; ++i)
+        CATCH_REQUIRE (appender->tryDoAppend (event));
+    CATCH_REQUIRE (! appender->tryDoAppend (event));
+
+    appender->release = true;
+    appender->waitToFinishAsyncLogging ();
+    CATCH_REQUIRE (appender->messages.size () == limit + 1);
+
+    setThreadPoolQueueSizeLimit (0);
+    appender->close ();
+}
+
+
+CATCH_TEST_CASE ("Asynchronous append overflow policy", "[appender]")
+{
+    helpers::Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("AsyncAppend"), LOG4CPLUS_TEXT ("true"));
+    props.setProperty (LOG4CPLUS_TEXT ("OverflowPolicy"),
+        LOG4CPLUS_TEXT ("DropOldest"));
+    helpers::SharedObjectPtr<BlockingAppender> appender (
+        new BlockingAppender (props));
+    auto log = [&appender] (LogLevel ll, unsigned i) {
+        appender->doAppend (spi::InternalLoggingEvent (LOG4CPLUS_TEXT ("test"),
+            ll, helpers::convertIntegerToString (i), __FILE__, __LINE__));
+    };
+
+    std::size_t const limit = 4;
+    setThreadPoolQueueSizeLimit (limit);
+
+    log (INFO_LOG_LEVEL, 0);
+    while (! appender->entered)
+        std::this_thread::yield ();
+
+    // The oldest queued events below ERROR make space for the new ones.
+    log (FATAL_LOG_LEVEL, 1);
+    for (unsigned i = 2; i != 8; ++i)
+        log (i < 4 ? DEBUG_LOG_LEVEL : INFO_LOG_LEVEL, i);
+
+    appender->release = true;
+    appender->waitToFinishAsyncLogging ();
+    CATCH_REQUIRE (appender->messages == std::vector<tstring> {
+        LOG4CPLUS_TEXT ("0"), LOG4CPLUS_TEXT ("1"), LOG4CPLUS_TEXT ("5"),
+        LOG4CPLUS_TEXT ("6"), LOG4CPLUS_TEXT ("7") });
+    CATCH_REQUIRE (appender->getAsyncDropCount (DEBUG_LOG_LEVEL) == 2);
+    CATCH_REQUIRE (appender->getAsyncDropCount (INFO_LOG_LEVEL) == 1);
+    CATCH_REQUIRE (appender->getAsyncDropCount (FATAL_LOG_LEVEL) == 0);
+
+    setThreadPoolQueueSizeLimit (0);
+    appender->close ();
+}
+#endif
+
+
 } // namespace log4cplus
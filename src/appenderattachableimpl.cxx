@@ -26,6 +26,19 @@
 #include <log4cplus/thread/syncprims-pub-impl.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/hierarchy.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/nullappender.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <catch_amalgamated.hpp>
+#endif
 
 
 namespace log4cplus
@@ -39,6 +52,16 @@ namespace spi
 AppenderAttachable::~AppenderAttachable() = default;
 
 
+void
+AppenderAttachable::replaceAllAppenders(
+    const SharedAppenderPtrList& newAppenders)
+{
+    removeAllAppenders ();
+    for (SharedAppenderPtr const & appender : newAppenders)
+        addAppender (appender);
+}
+
+
 } // namespace spi
 
 
@@ -46,6 +69,205 @@ namespace helpers
 {
 
 
+namespace
+{
+
+
+//! Tracks readers of appender list snapshots of all
+//! AppenderAttachableImpl instances. Readers register in one of striped
+//! counters for the current epoch parity. Replaced snapshot is retired
+//! and destroyed once counters of both parities have been seen at zero
+//! after the replacement. The epoch is flipped in between so that the
+//! counters drain even under continuous logging. Snapshot retired while
+//! readers are active is destroyed by one of later readers or appender
+//! list changes. Only removal of appenders waits for readers, see
+//! synchronize().
+class SnapshotReaders
+{
+public:
+    typedef std::vector<SharedAppenderPtr> ListType;
+
+    static
+    SnapshotReaders &
+    get ()
+    {
+        // Leaked on purpose. Retired snapshots hold appenders which must
+        // not be destroyed during static destruction.
+        static SnapshotReaders * const readers = new SnapshotReaders;
+        return *readers;
+    }
+
+    unsigned
+    enter ()
+    {
+        unsigned const token = slotIndex () * 2
+            + (epoch.load (std::memory_order_relaxed) & 1);
+        slots[token / 2].readers[token % 2].fetch_add (1,
+            std::memory_order_seq_cst);
+        ++depth;
+        return token;
+    }
+
+    void
+    leave (unsigned token)
+    {
+        --depth;
+        slots[token / 2].readers[token % 2].fetch_sub (1,
+            std::memory_order_release);
+        if (pending.load (std::memory_order_relaxed)) [[unlikely]]
+            while (reclaim (false))
+                ;
+    }
+
+    void
+    retire (ListType * snapshot)
+    {
+        if (snapshot)
+        {
+            std::lock_guard<std::mutex> guard (mtx);
+            retiredNew.emplace_back (snapshot);
+            pending.store (true, std::memory_order_relaxed);
+        }
+
+        // Without readers, the second step destroys the snapshot.
+        while (reclaim (true))
+            ;
+    }
+
+    //! Waits until snapshots retired so far are destroyed, i.e., until
+    //! no thread can be appending through them. It does not wait when
+    //! the calling thread is a reader itself, e.g., when an appender
+    //! removes appenders, as it would wait for itself.
+    void
+    synchronize ()
+    {
+        if (depth != 0)
+            return;
+
+        unsigned long target;
+        {
+            std::lock_guard<std::mutex> guard (mtx);
+            if (retiredNew.empty () && retiredOld.empty ())
+                return;
+
+            // Two steps take retiredNew through retiredOld to garbage.
+            target = steps + 2;
+        }
+
+        for (unsigned spins = 0; ; ++spins)
+        {
+            {
+                std::lock_guard<std::mutex> guard (mtx);
+                if (steps >= target
+                    || (retiredNew.empty () && retiredOld.empty ()))
+                    return;
+            }
+
+            if (reclaim (true))
+                continue;
+
+            // Readers may be blocked on I/O, do not spin for too long.
+            if (spins < 64)
+                std::this_thread::yield ();
+            else
+                std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        }
+    }
+
+private:
+    SnapshotReaders () = default;
+
+    static
+    unsigned
+    slotIndex ()
+    {
+        static std::atomic<unsigned> next {0};
+        thread_local unsigned const index
+            = next.fetch_add (1, std::memory_order_relaxed) % slot_count;
+        return index;
+    }
+
+    //! Advances retired snapshots by one step. Readers pass
+    //! <code>wait = false</code> so that they never block on each other.
+    //! \return `true` if some snapshots advanced.
+    bool
+    reclaim (bool wait)
+    {
+        std::vector<std::unique_ptr<ListType>> garbage;
+        {
+            std::unique_lock<std::mutex> guard (mtx, std::defer_lock);
+            if (wait)
+                guard.lock ();
+            else
+                guard.try_lock ();
+
+            if (! guard.owns_lock ()
+                || (retiredNew.empty () && retiredOld.empty ()))
+                return false;
+
+            unsigned const idle
+                = (epoch.load (std::memory_order_seq_cst) & 1) ^ 1;
+            for (Slot const & slot : slots)
+                if (slot.readers[idle].load (std::memory_order_seq_cst) != 0)
+                    return false;
+
+            // Snapshots in retiredOld have already seen the other parity
+            // idle, now they have seen both.
+            garbage.swap (retiredOld);
+            retiredOld.swap (retiredNew);
+            epoch.fetch_add (1, std::memory_order_seq_cst);
+            ++steps;
+            pending.store (! retiredOld.empty (), std::memory_order_relaxed);
+        }
+
+        // Release appenders in order, see removeAllAppenders().
+        for (auto & snapshot : garbage)
+            for (auto & app : *snapshot)
+                app = SharedAppenderPtr ();
+
+        return true;
+    }
+
+    static constexpr unsigned slot_count = 16;
+
+    //! Number of snapshots the calling thread is reading.
+    static thread_local unsigned depth;
+
+    struct alignas (64) Slot
+    {
+        std::array<std::atomic<std::size_t>, 2> readers {};
+    };
+
+    std::array<Slot, slot_count> slots;
+    std::atomic<unsigned> epoch {0};
+    std::atomic<bool> pending {false};
+    std::mutex mtx;
+    std::vector<std::unique_ptr<ListType>> retiredNew;
+    std::vector<std::unique_ptr<ListType>> retiredOld;
+    //! Count of reclaim() steps, guarded by mtx.
+    unsigned long steps = 0;
+};
+
+
+thread_local unsigned SnapshotReaders::depth = 0;
+
+
+//! Releases snapshot acquired by acquireAppenderSnapshot() even when
+//! an appender throws.
+struct SnapshotGuard
+{
+    unsigned const token;
+
+    ~SnapshotGuard ()
+    {
+        SnapshotReaders::get ().leave (token);
+    }
+};
+
+
+} // namespace
+
+
 //////////////////////////////////////////////////////////////////////////////
 // log4cplus::helpers::AppenderAttachableImpl ctor and dtor
 //////////////////////////////////////////////////////////////////////////////
@@ -53,7 +275,11 @@ namespace helpers
 AppenderAttachableImpl::AppenderAttachableImpl() = default;
 
 
-AppenderAttachableImpl::~AppenderAttachableImpl() = default;
+AppenderAttachableImpl::~AppenderAttachableImpl()
+{
+    SnapshotReaders::get ().retire (
+        appenderSnapshot.exchange (nullptr, std::memory_order_seq_cst));
+}
 
 
 
@@ -76,6 +302,7 @@ AppenderAttachableImpl::addAppender(SharedAppenderPtr newAppender)
     if (it == appenderList.end())
     {
         appenderList.push_back(newAppender);
+        publishAppenderList();
     }
 }
 
@@ -110,16 +337,21 @@ AppenderAttachableImpl::getAppender(const log4cplus::tstring& name)
 void
 AppenderAttachableImpl::removeAllAppenders()
 {
-    thread::MutexGuard guard (appender_list_mutex);
+    {
+        thread::MutexGuard guard (appender_list_mutex);
 
-    // Clear appenders in specific order because the order of destruction of
-    // std::vector elements is surprisingly unspecified and it breaks our
-    // tests' expectations.
+        // Clear appenders in specific order because the order of
+        // destruction of std::vector elements is surprisingly unspecified
+        // and it breaks our tests' expectations.
 
-    for (auto & app : appenderList)
-        app = SharedAppenderPtr ();
+        for (auto & app : appenderList)
+            app = SharedAppenderPtr ();
 
-    appenderList.clear ();
+        appenderList.clear ();
+        publishAppenderList();
+    }
+
+    waitForAppenderReaders();
 }
 
 
@@ -133,13 +365,19 @@ AppenderAttachableImpl::removeAppender(SharedAppenderPtr appender)
         return;
     }
 
-    thread::MutexGuard guard (appender_list_mutex);
-
-    auto it = std::find(appenderList.begin(), appenderList.end(), appender);
-    if (it != appenderList.end())
     {
+        thread::MutexGuard guard (appender_list_mutex);
+
+        auto it = std::find(appenderList.begin(), appenderList.end(),
+            appender);
+        if (it == appenderList.end())
+            return;
+
         appenderList.erase(it);
+        publishAppenderList();
     }
+
+    waitForAppenderReaders();
 }
 
 
@@ -152,21 +390,345 @@ AppenderAttachableImpl::removeAppender(const log4cplus::tstring& name)
 
 
 
+void
+AppenderAttachableImpl::replaceAllAppenders(
+    const SharedAppenderPtrList& newAppenders)
+{
+    ListType list;
+    list.reserve (newAppenders.size ());
+    for (SharedAppenderPtr const & appender : newAppenders)
+    {
+        if (! appender)
+            getLogLog().warn( LOG4CPLUS_TEXT("Tried to add NULL appender") );
+        else if (std::find (list.begin (), list.end (), appender)
+            == list.end ())
+            list.push_back (appender);
+    }
+
+    {
+        thread::MutexGuard guard (appender_list_mutex);
+
+        // See removeAllAppenders() for the order.
+        for (auto & app : appenderList)
+            app = SharedAppenderPtr ();
+
+        appenderList.swap (list);
+        publishAppenderList();
+    }
+
+    waitForAppenderReaders();
+}
+
+
+
 int
 AppenderAttachableImpl::appendLoopOnAppenders(const spi::InternalLoggingEvent& event) const
 {
-    int count = 0;
+    unsigned token;
+    ListType const * const snapshot = acquireAppenderSnapshot (token);
+    if (! snapshot)
+        return 0;
 
-    thread::MutexGuard guard (appender_list_mutex);
+    SnapshotGuard const guard {token};
 
-    for (auto & appender : appenderList)
-    {
-        ++count;
+    for (auto & appender : *snapshot)
         appender->doAppend(event);
+
+    return static_cast<int>(snapshot->size ());
+}
+
+
+int
+AppenderAttachableImpl::appendLoopOnAppenders(
+    std::span<const spi::InternalLoggingEvent> events) const
+{
+    unsigned token;
+    ListType const * const snapshot = acquireAppenderSnapshot (token);
+    if (! snapshot)
+        return 0;
+
+    SnapshotGuard const guard {token};
+
+    for (auto & appender : *snapshot)
+        appender->doAppendBatch(events);
+
+    return static_cast<int>(snapshot->size ());
+}
+
+
+void
+AppenderAttachableImpl::lockAppenderList()
+{
+    appender_list_mutex.lock ();
+    appenderListLocks.fetch_add (1, std::memory_order_acq_rel);
+}
+
+
+void
+AppenderAttachableImpl::unlockAppenderList()
+{
+    appenderListLocks.fetch_sub (1, std::memory_order_acq_rel);
+    appender_list_mutex.unlock ();
+}
+
+
+const AppenderAttachableImpl::ListType *
+AppenderAttachableImpl::acquireAppenderSnapshot(unsigned & token) const
+{
+    if (appenderListLocks.load (std::memory_order_acquire) != 0) [[unlikely]]
+    {
+        // Wait until the configuration change is finished.
+        thread::MutexGuard guard (appender_list_mutex);
+    }
+
+    if (appenderCount.load (std::memory_order_acquire) == 0)
+        return nullptr;
+
+    SnapshotReaders & readers = SnapshotReaders::get ();
+    token = readers.enter ();
+    ListType const * const snapshot
+        = appenderSnapshot.load (std::memory_order_seq_cst);
+    if (! snapshot)
+        readers.leave (token);
+
+    return snapshot;
+}
+
+
+void
+AppenderAttachableImpl::releaseAppenderSnapshot(unsigned token)
+{
+    SnapshotReaders::get ().leave (token);
+}
+
+
+void
+AppenderAttachableImpl::publishAppenderList()
+{
+    ListType * const snapshot
+        = appenderList.empty () ? nullptr : new ListType (appenderList);
+    ListType * const previous
+        = appenderSnapshot.exchange (snapshot, std::memory_order_seq_cst);
+    appenderCount.store (appenderList.size (), std::memory_order_release);
+    SnapshotReaders::get ().retire (previous);
+}
+
+
+void
+AppenderAttachableImpl::waitForAppenderReaders()
+{
+    SnapshotReaders::get ().synchronize ();
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+namespace
+{
+
+class DestructionFlagAppender
+    : public NullAppender
+{
+public:
+    explicit DestructionFlagAppender (std::atomic<bool> & flag_)
+        : flag (flag_)
+    { }
+
+    ~DestructionFlagAppender ()
+    {
+        flag.store (true);
+    }
+
+private:
+    std::atomic<bool> & flag;
+};
+
+
+//! Counts events appended after it has been marked as removed.
+class RemovalCheckAppender
+    : public NullAppender
+{
+public:
+    std::atomic<bool> removed {false};
+    std::atomic<unsigned> late {0};
+
+protected:
+    void
+    append (const spi::InternalLoggingEvent &) override
+    {
+        // Give the removing thread chance to run.
+        std::this_thread::sleep_for (std::chrono::microseconds (10));
+        if (removed.load ())
+            late.fetch_add (1);
+    }
+};
+
+
+//! Removes itself from <code>aai</code> when it is appended to.
+class SelfRemovingAppender
+    : public NullAppender
+{
+public:
+    explicit SelfRemovingAppender (AppenderAttachableImpl & aai_)
+        : aai (aai_)
+    { }
+
+protected:
+    void
+    append (const spi::InternalLoggingEvent &) override
+    {
+        aai.removeAppender (getName ());
+    }
+
+private:
+    AppenderAttachableImpl & aai;
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("Appender list changes while appending", "[appender]")
+{
+    AppenderAttachableImpl aai;
+    std::atomic<bool> permanentDestroyed {false};
+    std::atomic<bool> transientDestroyed {false};
+    SharedAppenderPtr permanent (
+        new DestructionFlagAppender (permanentDestroyed));
+    SharedAppenderPtr transient (
+        new DestructionFlagAppender (transientDestroyed));
+    aai.addAppender (permanent);
+
+    spi::InternalLoggingEvent const event (LOG4CPLUS_TEXT ("test"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+
+    std::atomic<bool> stop {false};
+    std::atomic<bool> missed {false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t != 2; ++t)
+        workers.emplace_back ([&] {
+            while (! stop.load ()) {
+                int const count = aai.appendLoopOnAppenders (event);
+                if (count != 1 && count != 2)
+                    missed.store (true);
+            }
+        });
+
+    for (int i = 0; i != 2000; ++i)
+    {
+        aai.addAppender (transient);
+        aai.removeAppender (transient);
+    }
+
+    stop.store (true);
+    for (auto & worker : workers)
+        worker.join ();
+
+    CATCH_REQUIRE (! missed.load ());
+    CATCH_REQUIRE (aai.getAllAppenders ().size () == 1);
+
+    // Snapshots retired while the workers were appending are released
+    // by the next reader at the latest.
+    CATCH_REQUIRE (aai.appendLoopOnAppenders (event) == 1);
+    transient = SharedAppenderPtr ();
+    CATCH_REQUIRE (transientDestroyed.load ());
+
+    permanent = SharedAppenderPtr ();
+    CATCH_REQUIRE (! permanentDestroyed.load ());
+    aai.removeAllAppenders ();
+    CATCH_REQUIRE (permanentDestroyed.load ());
+}
+
+
+CATCH_TEST_CASE ("Removed appender is not appended to", "[appender]")
+{
+    AppenderAttachableImpl aai;
+    spi::InternalLoggingEvent const event (LOG4CPLUS_TEXT ("test"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+
+    CATCH_SECTION ("removal by other thread")
+    {
+        std::atomic<bool> stop {false};
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t != 2; ++t)
+            workers.emplace_back ([&] {
+                while (! stop.load ())
+                    aai.appendLoopOnAppenders (event);
+            });
+
+        std::vector<SharedAppenderPtr> removed;
+        for (int i = 0; i != 200; ++i)
+        {
+            SharedAppenderPtr appender (new RemovalCheckAppender);
+            aai.addAppender (appender);
+            std::this_thread::yield ();
+            if (i % 2 == 0)
+                aai.removeAppender (appender);
+            else
+                aai.removeAllAppenders ();
+            static_cast<RemovalCheckAppender &>(*appender).removed.store (
+                true);
+            appender->close ();
+            removed.push_back (appender);
+        }
+
+        stop.store (true);
+        for (auto & worker : workers)
+            worker.join ();
+
+        unsigned late = 0;
+        for (auto const & appender : removed)
+            late += static_cast<RemovalCheckAppender &>(*appender).late;
+        CATCH_REQUIRE (late == 0);
+    }
+
+    CATCH_SECTION ("removal from within appender")
+    {
+        SharedAppenderPtr appender (new SelfRemovingAppender (aai));
+        appender->setName (LOG4CPLUS_TEXT ("self-removing"));
+        aai.addAppender (appender);
+        CATCH_REQUIRE (aai.appendLoopOnAppenders (event) == 1);
+        CATCH_REQUIRE (aai.getAllAppenders ().empty ());
+    }
+}
+
+
+CATCH_TEST_CASE ("Root logger appenders benchmark",
+    "[.][appender][benchmark]")
+{
+    Hierarchy h;
+    Logger root = h.getRoot ();
+    for (int i = 0; i != 3; ++i)
+        root.addAppender (SharedAppenderPtr (new NullAppender));
+
+    spi::InternalLoggingEvent const event (LOG4CPLUS_TEXT ("bench.worker"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+
+    constexpr std::size_t events = 200000;
+    unsigned const max_threads
+        = (std::max) (std::thread::hardware_concurrency (), 8u);
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        auto const start = std::chrono::steady_clock::now ();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t != threads; ++t)
+            workers.emplace_back ([&h, &event] {
+                Logger const logger
+                    = h.getInstance (LOG4CPLUS_TEXT ("bench.worker"));
+                for (std::size_t i = 0; i != events; ++i)
+                    logger.callAppenders (event);
+            });
+        for (auto & worker : workers)
+            worker.join ();
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now () - start).count ();
+
+        CATCH_WARN (threads << " threads: "
+            << (static_cast<double>(events) * threads * 1e9 / ns)
+            << " events/s");
     }
 
-    return count;
+    root.removeAllAppenders ();
 }
+#endif
 
 
 } // namespace helpers
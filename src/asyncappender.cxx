@@ -30,6 +30,7 @@
 #include <log4cplus/spi/factory.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
 
 
@@ -45,17 +46,17 @@ class QueueThread
     : public thread::AbstractThread
 {
 public:
-    QueueThread (AsyncAppenderPtr, thread::QueuePtr);
+    QueueThread (AsyncAppenderPtr, thread::AbstractQueuePtr);
 
     virtual void run() override;
 
 private:
     AsyncAppenderPtr appenders;
-    thread::QueuePtr queue;
+    thread::AbstractQueuePtr queue;
 };
 
 
-QueueThread::QueueThread (AsyncAppenderPtr aai, thread::QueuePtr q)
+QueueThread::QueueThread (AsyncAppenderPtr aai, thread::AbstractQueuePtr q)
     : appenders (std::move (aai))
     , queue (std::move (q))
 { }
@@ -71,12 +72,8 @@ QueueThread::run()
     {
         unsigned qflags = queue->get_events (&ev_buf);
         if (qflags & thread::Queue::EVENT)
-        {
-            auto const ev_buf_end = ev_buf.end ();
-            for (auto it = ev_buf.begin ();
-                it != ev_buf_end; ++it)
-                appenders->appendLoopOnAppenders (*it);
-        }
+            appenders->appendLoopOnAppenders (
+                std::span<spi::InternalLoggingEvent const> (ev_buf));
 
         if (((thread::Queue::EXIT | thread::Queue::DRAIN
                 | thread::Queue::EVENT) & qflags)
@@ -93,10 +90,11 @@ QueueThread::run()
 
 
 AsyncAppender::AsyncAppender (SharedAppenderPtr const & app,
-    unsigned queue_len)
+    unsigned queue_len, QueueType queue_type,
+    helpers::OverflowPolicy const & policy)
 {
     addAppender (app);
-    init_queue_thread (queue_len);
+    init_queue_thread (queue_len, queue_type, policy);
 }
 
 
@@ -131,7 +129,22 @@ AsyncAppender::AsyncAppender (helpers::Properties const & props)
     unsigned queue_len = 100;
     props.getUInt (queue_len, LOG4CPLUS_TEXT ("QueueLimit"));
 
-    init_queue_thread (queue_len);
+    QueueType queue_type = QTLocking;
+    tstring const queue_type_str = helpers::toLower (
+        props.getProperty (LOG4CPLUS_TEXT ("QueueType")));
+    if (queue_type_str == LOG4CPLUS_TEXT ("lockfree"))
+        queue_type = QTLockFree;
+    else if (! queue_type_str.empty ()
+        && queue_type_str != LOG4CPLUS_TEXT ("locking"))
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("AsyncAppender::AsyncAppender()")
+            LOG4CPLUS_TEXT (" - Unknown QueueType: ")
+            + queue_type_str);
+
+    helpers::OverflowPolicy policy;
+    policy.configure (props);
+
+    init_queue_thread (queue_len, queue_type, policy);
 }
 
 
@@ -142,9 +155,13 @@ AsyncAppender::~AsyncAppender ()
 
 
 void
-AsyncAppender::init_queue_thread (unsigned queue_len)
+AsyncAppender::init_queue_thread (unsigned queue_len,
+    QueueType queue_type, helpers::OverflowPolicy const & policy)
 {
-    queue = new thread::Queue (queue_len);
+    if (queue_type == QTLockFree)
+        queue = new thread::LockFreeQueue (queue_len, policy);
+    else
+        queue = new thread::Queue (queue_len, policy);
     queue_thread = new QueueThread (AsyncAppenderPtr (this), queue);
     queue_thread->start ();
     helpers::getLogLog ().debug (LOG4CPLUS_TEXT("Queue thread started."));
@@ -172,6 +189,13 @@ AsyncAppender::close ()
 }
 
 
+std::size_t
+AsyncAppender::getDropCount (LogLevel ll) const
+{
+    return queue ? queue->getOverflowPolicy ().getDropCount (ll) : 0;
+}
+
+
 void
 AsyncAppender::append (spi::InternalLoggingEvent const & ev)
 {
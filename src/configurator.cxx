@@ -19,7 +19,6 @@
 // limitations under the License.
 
 #include <log4cplus/configurator.h>
-#include <log4cplus/hierarchylocker.h>
 #include <log4cplus/hierarchy.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/stringhelper.h>
@@ -46,11 +45,35 @@
 #include <tchar.h>
 #endif
 
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_HAVE_SYS_INOTIFY_H) \
+    && defined (LOG4CPLUS_HAVE_POLL_H) && defined (LOG4CPLUS_HAVE_UNISTD_H) \
+    && defined (LOG4CPLUS_HAVE_FCNTL_H)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <deque>
+#define LOG4CPLUS_CONFIG_WATCH_INOTIFY
+#endif
+
 #include <algorithm>
 #include <cstdlib>
+#include <filesystem>
 #include <iterator>
+#include <memory>
+#include <set>
 #include <sstream>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/loggingmacros.h>
+#include <catch_amalgamated.hpp>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#endif
+
 
 namespace log4cplus
 {
@@ -102,6 +125,83 @@ namespace
         return pflags;
     }
 
+
+    //! Splits logger configuration string into log level and appender
+    //! names, ignoring spaces.
+    static
+    std::vector<tstring>
+    tokenize_logger_config (tstring const & config)
+    {
+        tstring configString;
+        std::remove_copy_if(config.begin(), config.end(),
+            std::back_inserter (configString),
+            [](tchar const ch) -> bool { return ch == LOG4CPLUS_TEXT(' '); });
+
+        std::vector<tstring> tokens;
+        helpers::tokenize(configString, LOG4CPLUS_TEXT(','),
+            std::back_insert_iterator<std::vector<tstring> >(tokens));
+        return tokens;
+    }
+
+
+    static
+    bool
+    equal_properties (helpers::Properties const & a,
+        helpers::Properties const & b)
+    {
+        std::vector<tstring> const names = a.propertyNames ();
+        if (names.size () != b.size ())
+            return false;
+
+        return std::all_of (names.begin (), names.end (),
+            [&](tstring const & name) {
+                return b.exists (name)
+                    && b.getProperty (name) == a.getProperty (name); });
+    }
+
+
+    //! \return `true` when appender <code>name</code> has the same
+    //! class and options in both sets of appender properties.
+    static
+    bool
+    same_appender_config (tstring const & name,
+        helpers::Properties const & previous,
+        helpers::Properties const & current)
+    {
+        if (! previous.exists (name) || ! current.exists (name)
+            || previous.getProperty (name) != current.getProperty (name))
+            return false;
+
+        tstring const prefix = name + LOG4CPLUS_TEXT (".");
+        return equal_properties (previous.getPropertySubset (prefix),
+            current.getPropertySubset (prefix));
+    }
+
+
+    //! Adds normalized paths of files that appender <code>name</code>
+    //! writes into, its <code>File</code> and
+    //! <code>FilenamePattern</code> options, to <code>files</code>.
+    static
+    void
+    appender_files (std::set<std::filesystem::path> & files,
+        tstring const & name, helpers::Properties const & props)
+    {
+        for (tchar const * option : {LOG4CPLUS_TEXT (".File"),
+                LOG4CPLUS_TEXT (".FilenamePattern")})
+        {
+            tstring const file = props.getProperty (name + option);
+            if (file.empty ())
+                continue;
+
+            std::error_code ec;
+            std::filesystem::path path
+                = std::filesystem::weakly_canonical (file, ec);
+            if (ec)
+                path = std::filesystem::path (file).lexically_normal ();
+            files.insert (std::move (path));
+        }
+    }
+
 } // namespace
 
 
@@ -176,36 +276,10 @@ PropertyConfigurator::doConfigure(const tstring& file, Hierarchy& h,
 void
 PropertyConfigurator::configure()
 {
-    // Configure log4cplus internals.
-    bool internal_debugging = false;
-    if (properties.getBool (internal_debugging, LOG4CPLUS_TEXT ("configDebug")))
-        helpers::getLogLog ().setInternalDebugging (internal_debugging);
-
-    bool quiet_mode = false;
-    if (properties.getBool (quiet_mode, LOG4CPLUS_TEXT ("quietMode")))
-        helpers::getLogLog ().setQuietMode (quiet_mode);
-
     bool disable_override = false;
     properties.getBool (disable_override, LOG4CPLUS_TEXT ("disableOverride"));
 
-    initializeLog4cplus();
-
-    unsigned int thread_pool_size;
-    if (properties.getUInt (thread_pool_size, LOG4CPLUS_TEXT ("threadPoolSize")))
-        thread_pool_size = (std::min) (thread_pool_size, 1024U);
-    else
-        thread_pool_size = 4;
-
-    setThreadPoolSize (thread_pool_size);
-
-    bool block;
-    if (properties.getBool (block, LOG4CPLUS_TEXT ("threadPoolBlockOnFull")))
-        setThreadPoolBlockOnFull (block);
-
-    unsigned int queue_size_limit;
-    if (properties.getUInt (queue_size_limit, LOG4CPLUS_TEXT ("threadPoolQueueSizeLimit")))
-        setThreadPoolQueueSizeLimit ((std::max) (queue_size_limit, 100u));
-
+    configureGlobals();
     configureAppenders();
     configureLoggers();
     configureAdditivity();
@@ -238,6 +312,38 @@ PropertyConfigurator::getPropertyFilename () const
 // PropertyConfigurator protected methods
 //////////////////////////////////////////////////////////////////////////////
 
+void
+PropertyConfigurator::configureGlobals()
+{
+    // Configure log4cplus internals.
+    bool internal_debugging = false;
+    if (properties.getBool (internal_debugging, LOG4CPLUS_TEXT ("configDebug")))
+        helpers::getLogLog ().setInternalDebugging (internal_debugging);
+
+    bool quiet_mode = false;
+    if (properties.getBool (quiet_mode, LOG4CPLUS_TEXT ("quietMode")))
+        helpers::getLogLog ().setQuietMode (quiet_mode);
+
+    initializeLog4cplus();
+
+    unsigned int thread_pool_size;
+    if (properties.getUInt (thread_pool_size, LOG4CPLUS_TEXT ("threadPoolSize")))
+        thread_pool_size = (std::min) (thread_pool_size, 1024U);
+    else
+        thread_pool_size = 4;
+
+    setThreadPoolSize (thread_pool_size);
+
+    bool block;
+    if (properties.getBool (block, LOG4CPLUS_TEXT ("threadPoolBlockOnFull")))
+        setThreadPoolBlockOnFull (block);
+
+    unsigned int queue_size_limit;
+    if (properties.getUInt (queue_size_limit, LOG4CPLUS_TEXT ("threadPoolQueueSizeLimit")))
+        setThreadPoolQueueSizeLimit ((std::max) (queue_size_limit, 100u));
+}
+
+
 void
 PropertyConfigurator::reconfigure()
 {
@@ -247,6 +353,170 @@ PropertyConfigurator::reconfigure()
 }
 
 
+void
+PropertyConfigurator::reconfigureIncrementally()
+{
+    helpers::Properties const previous (std::move (properties));
+    properties = helpers::Properties(propertyFilename,
+        pcflag_to_pflags_encoding (flags));
+    init();
+
+    bool disable_override = false;
+    properties.getBool (disable_override, LOG4CPLUS_TEXT ("disableOverride"));
+
+    configureGlobals();
+
+    // Collect appenders attached to loggers of the previous
+    // configuration.
+
+    std::vector<std::pair<Logger, tstring>> previousLoggers;
+    if (previous.exists (LOG4CPLUS_TEXT ("rootLogger")))
+        previousLoggers.emplace_back (h.getRoot (),
+            LOG4CPLUS_TEXT ("rootLogger"));
+
+    helpers::Properties const previousLoggerProperties
+        = previous.getPropertySubset (LOG4CPLUS_TEXT ("logger."));
+    for (tstring const & loggerName : previousLoggerProperties.propertyNames ())
+        previousLoggers.emplace_back (getLogger (loggerName),
+            LOG4CPLUS_TEXT ("logger.") + loggerName);
+
+    AppenderMap liveAppenders;
+    for (auto & logger : previousLoggers)
+        for (SharedAppenderPtr & appender : logger.first.getAllAppenders ())
+            liveAppenders.emplace (appender->getName (), appender);
+
+    // Keep appenders with unchanged configuration, create the rest.
+
+    helpers::Properties const previousAppenderProperties
+        = previous.getPropertySubset (LOG4CPLUS_TEXT ("appender."));
+    helpers::Properties const appenderProperties
+        = properties.getPropertySubset (LOG4CPLUS_TEXT ("appender."));
+    for (auto const & live : liveAppenders)
+        if (same_appender_config (live.first, previousAppenderProperties,
+                appenderProperties))
+            appenders.insert (live);
+
+    // Appenders replaced by an appender writing into the same file are
+    // detached and closed before the new one is created. It would open,
+    // and possibly truncate, the file while the old one still writes
+    // into it otherwise. Appender lists of loggers they are attached to
+    // stay locked until the loggers get the new appenders, so logging
+    // threads wait instead of missing the appender in the meantime.
+
+    std::set<std::filesystem::path> newFiles;
+    for (tstring const & name : appenderProperties.propertyNames ())
+        if (name.find (LOG4CPLUS_TEXT ('.')) == tstring::npos
+            && appenders.find (name) == appenders.end ())
+            appender_files (newFiles, name, appenderProperties);
+
+    SharedAppenderPtrList sameFileAppenders;
+    for (auto const & live : liveAppenders)
+    {
+        if (appenders.find (live.first) != appenders.end ())
+            continue;
+
+        std::set<std::filesystem::path> files;
+        appender_files (files, live.first, previousAppenderProperties);
+        if (std::any_of (files.begin (), files.end (),
+                [&](std::filesystem::path const & file) {
+                    return newFiles.count (file) != 0; }))
+            sameFileAppenders.push_back (live.second);
+    }
+
+    struct LockedLoggers
+    {
+        ~LockedLoggers ()
+        {
+            unlock ();
+        }
+
+        void
+        unlock ()
+        {
+            for (Logger & logger : loggers)
+                logger.value->unlockAppenderList ();
+            loggers.clear ();
+        }
+
+        LoggerList loggers;
+    } locked;
+
+    for (auto & logger : previousLoggers)
+    {
+        SharedAppenderPtrList const attached
+            = logger.first.getAllAppenders ();
+        if (std::find_first_of (attached.begin (), attached.end (),
+                sameFileAppenders.begin (), sameFileAppenders.end ())
+            == attached.end ())
+            continue;
+
+        logger.first.value->lockAppenderList ();
+        locked.loggers.push_back (logger.first);
+    }
+
+    for (SharedAppenderPtr & appender : sameFileAppenders)
+    {
+        // Removal waits for threads still appending to it.
+        for (Logger & logger : locked.loggers)
+            logger.removeAppender (appender);
+        appender->close ();
+    }
+
+    configureAppenders();
+
+    // Update loggers. Loggers that are no longer configured are reset
+    // the same way Hierarchy::resetConfiguration() would reset them.
+
+    for (auto & logger : previousLoggers)
+    {
+        if (properties.exists (logger.second))
+            continue;
+
+        logger.first.replaceAllAppenders (SharedAppenderPtrList ());
+        logger.first.setLogLevel (logger.second == LOG4CPLUS_TEXT ("rootLogger")
+            ? DEBUG_LOG_LEVEL : NOT_SET_LOG_LEVEL);
+    }
+
+    if (properties.exists (LOG4CPLUS_TEXT ("rootLogger")))
+        reconfigureLogger (h.getRoot (),
+            properties.getProperty (LOG4CPLUS_TEXT ("rootLogger")));
+
+    helpers::Properties const loggerProperties
+        = properties.getPropertySubset (LOG4CPLUS_TEXT ("logger."));
+    for (tstring const & loggerName : loggerProperties.propertyNames ())
+        reconfigureLogger (getLogger (loggerName),
+            loggerProperties.getProperty (loggerName));
+
+    locked.unlock ();
+
+    helpers::Properties const additivityProperties
+        = properties.getPropertySubset (LOG4CPLUS_TEXT ("additivity."));
+    for (tstring const & loggerName
+        : previous.getPropertySubset (LOG4CPLUS_TEXT ("additivity."))
+            .propertyNames ())
+        if (! additivityProperties.exists (loggerName))
+            getLogger (loggerName).setAdditivity (true);
+
+    configureAdditivity();
+
+    h.disable (disable_override
+        ? Hierarchy::DISABLE_OVERRIDE : Hierarchy::DISABLE_OFF);
+
+    // Close appenders that have been replaced or dropped. They are no
+    // longer attached to any of the configured loggers.
+
+    for (auto const & live : liveAppenders)
+    {
+        auto const it = appenders.find (live.first);
+        if ((it == appenders.end () || it->second != live.second)
+            && ! live.second->isClosed ())
+            live.second->close ();
+    }
+
+    appenders.clear ();
+}
+
+
 void
 PropertyConfigurator::replaceEnvironVariables()
 {
@@ -310,17 +580,7 @@ PropertyConfigurator::configureLoggers()
 void
 PropertyConfigurator::configureLogger(Logger logger, const tstring& config)
 {
-    // Remove all spaces from config
-    tstring configString;
-    std::remove_copy_if(config.begin(), config.end(),
-        std::back_inserter (configString),
-        [](tchar const ch) -> bool { return ch == LOG4CPLUS_TEXT(' '); });
-
-    // "Tokenize" configString
-    std::vector<tstring> tokens;
-    helpers::tokenize(configString, LOG4CPLUS_TEXT(','),
-        std::back_insert_iterator<std::vector<tstring> >(tokens));
-
+    std::vector<tstring> const tokens = tokenize_logger_config (config);
     if (tokens.empty ())
     {
         helpers::getLogLog().error(
@@ -361,6 +621,54 @@ PropertyConfigurator::configureLogger(Logger logger, const tstring& config)
 
 
 
+void
+PropertyConfigurator::reconfigureLogger(Logger logger, const tstring& config)
+{
+    std::vector<tstring> const tokens = tokenize_logger_config (config);
+    if (tokens.empty ())
+    {
+        helpers::getLogLog().error(
+            LOG4CPLUS_TEXT("PropertyConfigurator::reconfigureLogger()")
+            LOG4CPLUS_TEXT("- Invalid config string(Logger = ")
+            + logger.getName()
+            + LOG4CPLUS_TEXT("): \"")
+            + config
+            + LOG4CPLUS_TEXT("\""));
+        return;
+    }
+
+    LogLevel const ll = tokens[0] != LOG4CPLUS_TEXT("INHERITED")
+        ? getLogLevelManager().fromString(tokens[0])
+        : NOT_SET_LOG_LEVEL;
+    if (logger.getLogLevel () != ll)
+        logger.setLogLevel (ll);
+
+    SharedAppenderPtrList list;
+    for(std::vector<tstring>::size_type j=1; j<tokens.size(); ++j)
+    {
+        auto appenderIt = appenders.find(tokens[j]);
+        if (appenderIt == appenders.end())
+        {
+            helpers::getLogLog().error(
+                LOG4CPLUS_TEXT("PropertyConfigurator::reconfigureLogger()")
+                LOG4CPLUS_TEXT("- Invalid appender: ")
+                + tokens[j]);
+            continue;
+        }
+
+        if (std::find (list.begin (), list.end (), appenderIt->second)
+            == list.end ())
+            list.push_back (appenderIt->second);
+    }
+
+    // Swap the whole list at once, and only when it differs, so that
+    // logging threads never see the logger without its appenders.
+    if (logger.getAllAppenders () != list)
+        logger.replaceAllAppenders (list);
+}
+
+
+
 void
 PropertyConfigurator::configureAppenders()
 {
@@ -370,7 +678,10 @@ PropertyConfigurator::configureAppenders()
     tstring factoryName;
     for (tstring & appenderName : appendersProps)
     {
-        if (appenderName.find (LOG4CPLUS_TEXT('.')) == tstring::npos)
+        // Appenders reused by reconfigureIncrementally() are already
+        // in the map.
+        if (appenderName.find (LOG4CPLUS_TEXT('.')) == tstring::npos
+            && appenders.find (appenderName) == appenders.end ())
         {
             factoryName = appenderProperties.getProperty(appenderName);
             spi::AppenderFactory* factory
@@ -491,6 +802,212 @@ BasicConfigurator::doConfigure(Hierarchy& h, bool logToStdErr)
 
 #if !defined(LOG4CPLUS_SINGLE_THREADED)
 
+#if defined (LOG4CPLUS_CONFIG_WATCH_INOTIFY)
+namespace
+{
+
+//! Waits for changes of configuration file using inotify. Every
+//! directory along the path that contains a symbolic link is watched
+//! for changes of the link's entry, and so is the directory of the
+//! resolved file. This catches in-place writes, editors that rename a
+//! new file over the old one and swaps of symbolic links such as
+//! Kubernetes ConfigMap <code>..data</code> link.
+class ConfigFileNotifier
+{
+public:
+    explicit ConfigFileNotifier (std::string const & file_)
+        : file (file_)
+    {
+        inotifyFd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd == -1 || pipe2 (pipeFds, O_NONBLOCK | O_CLOEXEC) == -1)
+            return;
+
+        updateWatches ();
+    }
+
+    ~ConfigFileNotifier ()
+    {
+        for (int fd : {inotifyFd, pipeFds[0], pipeFds[1]})
+            if (fd != -1)
+                ::close (fd);
+    }
+
+    //! \return `false` if the watch could not be set up.
+    bool
+    valid () const
+    {
+        return pipeFds[0] != -1 && ! watches.empty ();
+    }
+
+    //! Blocks until the file might have changed.
+    //! \return `false` when interrupted or on error.
+    bool
+    wait ()
+    {
+        for (;;)
+        {
+            pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {pipeFds[0], POLLIN, 0}};
+            int const ret = ::poll (fds, 2, -1);
+            if (ret == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return false;
+            }
+
+            if (fds[1].revents != 0)
+                return false;
+
+            if (! drain ())
+                continue;
+
+            // Editors and ConfigMap updates produce bursts of events.
+            // Let the burst settle before the file is read.
+            fds[0].revents = 0;
+            while (::poll (fds, 1, settle_millis) > 0)
+                drain ();
+
+            updateWatches ();
+            return true;
+        }
+    }
+
+    void
+    interrupt ()
+    {
+        char const ch = 0;
+        [[maybe_unused]] ssize_t ret = ::write (pipeFds[1], &ch, 1);
+    }
+
+private:
+    //! Reads pending events.
+    //! \return `true` if any of them concerns the watched entries.
+    bool
+    drain ()
+    {
+        alignas (inotify_event) char buf[4096];
+        bool relevant = false;
+        ssize_t len;
+        while ((len = ::read (inotifyFd, buf, sizeof (buf))) > 0)
+        {
+            for (char const * ptr = buf; ptr < buf + len; )
+            {
+                auto const * ev = reinterpret_cast<inotify_event const *>(ptr);
+                if ((ev->mask & IN_Q_OVERFLOW) != 0)
+                    relevant = true;
+                else if (ev->len != 0)
+                    relevant = relevant || std::any_of (watches.begin (),
+                        watches.end (), [ev](Watch const & w) {
+                            return w.wd == ev->wd && w.name == ev->name; });
+
+                ptr += sizeof (inotify_event) + ev->len;
+            }
+        }
+
+        return relevant;
+    }
+
+    void
+    updateWatches ()
+    {
+        for (Watch const & w : watches)
+            inotify_rm_watch (inotifyFd, w.wd);
+        watches.clear ();
+
+        std::vector<std::pair<std::string, std::string>> entries;
+        resolve (entries);
+        for (auto & entry : entries)
+        {
+            int const wd = inotify_add_watch (inotifyFd, entry.first.c_str (),
+                IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                | IN_CLOSE_WRITE | IN_ATTRIB);
+            if (wd != -1)
+                watches.push_back (Watch {wd, std::move (entry.second)});
+        }
+    }
+
+    //! Walks the path the same way as <code>realpath()</code> and
+    //! collects directory and name of every symbolic link on the way
+    //! and of the resolved file.
+    void
+    resolve (std::vector<std::pair<std::string, std::string>> & entries) const
+    {
+        std::deque<std::string> pending;
+        auto push_path = [&pending] (std::string const & path) {
+            std::vector<std::string> components;
+            helpers::tokenize (path, '/', std::back_inserter (components));
+            pending.insert (pending.begin (), components.begin (),
+                components.end ());
+        };
+
+        std::string resolved;
+        if (file.empty () || file[0] != '/')
+        {
+            char cwd[4096];
+            if (! ::getcwd (cwd, sizeof (cwd)))
+                return;
+
+            push_path (cwd + ('/' + file));
+        }
+        else
+            push_path (file);
+
+        unsigned links = 0;
+        std::string component;
+        while (! pending.empty ())
+        {
+            component = std::move (pending.front ());
+            pending.pop_front ();
+            if (component.empty () || component == ".")
+                continue;
+            else if (component == "..")
+            {
+                if (! resolved.empty ())
+                    resolved.erase (resolved.rfind ('/'));
+                continue;
+            }
+
+            std::string const path = resolved + '/' + component;
+            char target[4096];
+            ssize_t const len = ::readlink (path.c_str (), target,
+                sizeof (target));
+            if (len <= 0 || len == sizeof (target) || ++links > 40)
+            {
+                if (pending.empty ())
+                    entries.emplace_back (
+                        resolved.empty () ? std::string ("/") : resolved,
+                        component);
+                resolved = path;
+                continue;
+            }
+
+            entries.emplace_back (
+                resolved.empty () ? std::string ("/") : resolved, component);
+            if (target[0] == '/')
+                resolved.clear ();
+            push_path (std::string (target, len));
+        }
+    }
+
+    static constexpr int settle_millis = 50;
+
+    struct Watch
+    {
+        int wd;
+        std::string name;
+    };
+
+    std::string const file;
+    int inotifyFd = -1;
+    int pipeFds[2] = {-1, -1};
+    std::vector<Watch> watches;
+};
+
+} // namespace
+#endif
+
+
 //////////////////////////////////////////////////////////////////////////////
 // ConfigurationWatchDogThread implementation
 //////////////////////////////////////////////////////////////////////////////
@@ -500,17 +1017,35 @@ class ConfigurationWatchDogThread
       public PropertyConfigurator
 {
 public:
-    ConfigurationWatchDogThread(const tstring& file, unsigned int millis)
+    ConfigurationWatchDogThread(const tstring& file, unsigned int millis,
+        bool notify)
         : PropertyConfigurator(file)
         , waitMillis(millis < 1000 ? 1000 : millis)
         , shouldTerminate(false)
-        , lock(nullptr)
     {
         lastFileInfo.mtime = helpers::now ();
         lastFileInfo.size = 0;
         lastFileInfo.is_link = false;
 
         updateLastModInfo();
+
+#if defined (LOG4CPLUS_CONFIG_WATCH_INOTIFY)
+        if (notify)
+        {
+            notifier.reset (new ConfigFileNotifier (
+                LOG4CPLUS_TSTRING_TO_STRING (file)));
+            if (! notifier->valid ())
+            {
+                helpers::getLogLog ().warn (
+                    LOG4CPLUS_TEXT ("ConfigurationWatchDogThread- Cannot")
+                    LOG4CPLUS_TEXT (" watch ") + file
+                    + LOG4CPLUS_TEXT (" for changes, polling instead."));
+                notifier.reset ();
+            }
+        }
+#else
+        (void) notify;
+#endif
     }
 
     ~ConfigurationWatchDogThread () override = default;
@@ -518,13 +1053,15 @@ public:
     void terminate ()
     {
         shouldTerminate.signal ();
+#if defined (LOG4CPLUS_CONFIG_WATCH_INOTIFY)
+        if (notifier)
+            notifier->interrupt ();
+#endif
         join ();
     }
 
 protected:
     void run() override;
-    Logger getLogger(const tstring& name) override;
-    void addAppender(Logger &logger, SharedAppenderPtr& appender) override;
 
     bool checkForFileModification();
     void updateLastModInfo();
@@ -537,54 +1074,53 @@ private:
     unsigned int const waitMillis;
     thread::ManualResetEvent shouldTerminate;
     helpers::FileInfo lastFileInfo;
-    HierarchyLocker* lock;
+#if defined (LOG4CPLUS_CONFIG_WATCH_INOTIFY)
+    std::unique_ptr<ConfigFileNotifier> notifier;
+#endif
 };
 
 
 void
 ConfigurationWatchDogThread::run()
 {
+#if defined (LOG4CPLUS_CONFIG_WATCH_INOTIFY)
+    if (notifier)
+    {
+        while (notifier->wait ())
+        {
+            // The notification does not tell whether the file has
+            // actually changed. Only skip it while it does not exist.
+            helpers::FileInfo fi;
+            if (helpers::getFileInfo (&fi, propertyFilename) == 0)
+            {
+                reconfigureIncrementally();
+                updateLastModInfo();
+            }
+        }
+
+        if (shouldTerminate.timed_wait (0))
+            return;
+
+        helpers::getLogLog ().warn (
+            LOG4CPLUS_TEXT ("ConfigurationWatchDogThread- Watching ")
+            + propertyFilename
+            + LOG4CPLUS_TEXT (" failed, polling instead."));
+    }
+#endif
+
     while (! shouldTerminate.timed_wait (waitMillis))
     {
         bool modified = checkForFileModification();
         if(modified) {
-            // Lock the Hierarchy
-            HierarchyLocker theLock(h);
-            lock = &theLock;
-
-            // reconfigure the Hierarchy
-            theLock.resetConfiguration();
-            reconfigure();
+            // Apply only the differences. Logging threads keep running
+            // and unchanged appenders stay in place.
+            reconfigureIncrementally();
             updateLastModInfo();
-
-            // release the lock
-            lock = nullptr;
         }
     }
 }
 
 
-Logger
-ConfigurationWatchDogThread::getLogger(const tstring& name)
-{
-    if(lock)
-        return lock->getInstance(name);
-    else
-        return PropertyConfigurator::getLogger(name);
-}
-
-
-void
-ConfigurationWatchDogThread::addAppender(Logger& logger,
-                                         SharedAppenderPtr& appender)
-{
-    if(lock)
-        lock->addAppender(logger, appender);
-    else
-        PropertyConfigurator::addAppender(logger, appender);
-}
-
-
 bool
 ConfigurationWatchDogThread::checkForFileModification()
 {
@@ -630,10 +1166,10 @@ ConfigurationWatchDogThread::updateLastModInfo()
 //////////////////////////////////////////////////////////////////////////////
 
 ConfigureAndWatchThread::ConfigureAndWatchThread(const tstring& file,
-    unsigned int millis)
+    unsigned int millis, bool notify)
     : watchDogThread(nullptr)
 {
-    watchDogThread = new ConfigurationWatchDogThread(file, millis);
+    watchDogThread = new ConfigurationWatchDogThread(file, millis, notify);
     watchDogThread->addReference ();
     watchDogThread->configure();
     watchDogThread->start();
@@ -653,4 +1189,230 @@ ConfigureAndWatchThread::~ConfigureAndWatchThread()
 #endif
 
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+namespace
+{
+
+class IncrementalConfigurator
+    : public PropertyConfigurator
+{
+public:
+    using PropertyConfigurator::PropertyConfigurator;
+    using PropertyConfigurator::reconfigureIncrementally;
+};
+
+
+void
+write_config (tstring const & file_name, char const * text)
+{
+    std::ofstream out (std::filesystem::path (file_name),
+        std::ios_base::trunc);
+    out << text;
+}
+
+} // namespace
+
+
+CATCH_TEST_CASE ("PropertyConfigurator incremental reconfiguration",
+    "[configurator]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("configurator_incremental_test.properties"));
+    write_config (file_name,
+        "log4cplus.appender.A1=log4cplus::NullAppender\n"
+        "log4cplus.appender.A2=log4cplus::FileAppender\n"
+        "log4cplus.appender.A2.File=configurator_incremental_test.log\n"
+        "log4cplus.appender.A2.Threshold=WARN\n"
+        "log4cplus.rootLogger=INFO, A1\n"
+        "log4cplus.logger.x=WARN, A1, A2\n"
+        "log4cplus.additivity.x=false\n");
+
+    Hierarchy h;
+    IncrementalConfigurator config (file_name, h);
+    config.configure ();
+
+    Logger root = h.getRoot ();
+    Logger x = h.getInstance (LOG4CPLUS_TEXT ("x"));
+    SharedAppenderPtr const a1 = root.getAppender (LOG4CPLUS_TEXT ("A1"));
+    SharedAppenderPtr const a2 = x.getAppender (LOG4CPLUS_TEXT ("A2"));
+    CATCH_REQUIRE (a1);
+    CATCH_REQUIRE (a2);
+    CATCH_REQUIRE (! x.getAdditivity ());
+
+    write_config (file_name,
+        "log4cplus.appender.A1=log4cplus::NullAppender\n"
+        "log4cplus.appender.A2=log4cplus::FileAppender\n"
+        "log4cplus.appender.A2.File=configurator_incremental_test.log\n"
+        "log4cplus.appender.A2.Threshold=ERROR\n"
+        "log4cplus.rootLogger=DEBUG, A1, A2\n"
+        "log4cplus.logger.y=ERROR, A1\n");
+    config.reconfigureIncrementally ();
+
+    CATCH_SECTION ("unchanged appender is kept")
+    {
+        CATCH_REQUIRE (root.getAppender (LOG4CPLUS_TEXT ("A1")) == a1);
+    }
+
+    CATCH_SECTION ("changed appender is replaced")
+    {
+        SharedAppenderPtr const a2new
+            = root.getAppender (LOG4CPLUS_TEXT ("A2"));
+        CATCH_REQUIRE (a2new);
+        CATCH_REQUIRE (a2new != a2);
+        CATCH_REQUIRE (a2new->getThreshold () == ERROR_LOG_LEVEL);
+        CATCH_REQUIRE (a2->isClosed ());
+    }
+
+    CATCH_SECTION ("loggers")
+    {
+        CATCH_REQUIRE (root.getLogLevel () == DEBUG_LOG_LEVEL);
+        CATCH_REQUIRE (root.getAllAppenders ().size () == 2);
+        CATCH_REQUIRE (x.getLogLevel () == NOT_SET_LOG_LEVEL);
+        CATCH_REQUIRE (x.getAllAppenders ().empty ());
+        CATCH_REQUIRE (x.getAdditivity ());
+
+        Logger y = h.getInstance (LOG4CPLUS_TEXT ("y"));
+        CATCH_REQUIRE (y.getLogLevel () == ERROR_LOG_LEVEL);
+        CATCH_REQUIRE (y.getAppender (LOG4CPLUS_TEXT ("A1")) == a1);
+    }
+
+    h.shutdown ();
+    std::filesystem::remove (std::filesystem::path (file_name));
+    std::filesystem::remove (
+        std::filesystem::path ("configurator_incremental_test.log"));
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+CATCH_TEST_CASE ("PropertyConfigurator incremental reconfiguration "
+    "while logging", "[configurator]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("configurator_incremental_logging_test.properties"));
+    char const log_name[] = "configurator_incremental_logging_test.log";
+    write_config (file_name,
+        "log4cplus.appender.A1=log4cplus::FileAppender\n"
+        "log4cplus.appender.A1.File=configurator_incremental_logging_test.log\n"
+        "log4cplus.appender.A1.ImmediateFlush=false\n"
+        "log4cplus.appender.A1.layout=log4cplus::PatternLayout\n"
+        "log4cplus.appender.A1.layout.ConversionPattern=old %m%n\n"
+        "log4cplus.rootLogger=INFO, A1\n");
+
+    Hierarchy h;
+    IncrementalConfigurator config (file_name, h);
+    config.configure ();
+
+    Logger root = h.getRoot ();
+    SharedAppenderPtr const a1 = root.getAppender (LOG4CPLUS_TEXT ("A1"));
+    CATCH_REQUIRE (a1);
+
+    std::atomic<bool> stop {false};
+    std::atomic<unsigned> logged {0};
+    std::thread worker ([&] {
+        while (! stop.load ())
+            LOG4CPLUS_INFO (root, logged.fetch_add (1));
+    });
+
+    while (logged.load () < 100)
+        std::this_thread::yield ();
+
+    // The new appender writes into the same file, named differently.
+    // The old one must not write its buffered events into it afterwards
+    // and no event may be lost in between.
+    write_config (file_name,
+        "log4cplus.appender.A1=log4cplus::FileAppender\n"
+        "log4cplus.appender.A1.File=./configurator_incremental_logging_test.log\n"
+        "log4cplus.appender.A1.Append=true\n"
+        "log4cplus.appender.A1.layout=log4cplus::PatternLayout\n"
+        "log4cplus.appender.A1.layout.ConversionPattern=%m%n\n"
+        "log4cplus.rootLogger=INFO, A1\n");
+    config.reconfigureIncrementally ();
+
+    unsigned const reconfigured = logged.load ();
+    while (logged.load () < reconfigured + 100)
+        std::this_thread::yield ();
+
+    stop.store (true);
+    worker.join ();
+
+    CATCH_REQUIRE (a1->isClosed ());
+    CATCH_REQUIRE (root.getAppender (LOG4CPLUS_TEXT ("A1")) != a1);
+    h.shutdown ();
+
+    std::ifstream in (log_name, std::ios_base::binary);
+    std::string line;
+    unsigned expected = 0;
+    std::size_t newLines = 0;
+    while (std::getline (in, line))
+    {
+        std::string const number = std::to_string (expected++);
+        if (newLines == 0 && line == "old " + number)
+            continue;
+
+        CATCH_REQUIRE (line == number);
+        ++newLines;
+    }
+    CATCH_REQUIRE (expected == logged.load ());
+    CATCH_REQUIRE (newLines >= 100);
+
+    std::filesystem::remove (std::filesystem::path (file_name));
+    std::filesystem::remove (std::filesystem::path (log_name));
+}
+#endif
+
+
+#if defined (LOG4CPLUS_CONFIG_WATCH_INOTIFY)
+CATCH_TEST_CASE ("ConfigFileNotifier", "[configurator]")
+{
+    namespace fs = std::filesystem;
+    fs::path const dir ("configurator_notifier_test");
+    fs::remove_all (dir);
+    fs::create_directories (dir / "..v1");
+    fs::create_directories (dir / "..v2");
+    std::ofstream (dir / "..v1" / "log4cplus.properties") << "a=1\n";
+    std::ofstream (dir / "..v2" / "log4cplus.properties") << "a=2\n";
+
+    // Layout of Kubernetes ConfigMap volume.
+    fs::create_directory_symlink ("..v1", dir / "..data");
+    fs::create_symlink ("..data/log4cplus.properties",
+        dir / "log4cplus.properties");
+
+    ConfigFileNotifier notifier ((dir / "log4cplus.properties").string ());
+    CATCH_REQUIRE (notifier.valid ());
+
+    CATCH_SECTION ("symbolic link swap")
+    {
+        fs::create_directory_symlink ("..v2", dir / "..data_tmp");
+        fs::rename (dir / "..data_tmp", dir / "..data");
+        CATCH_REQUIRE (notifier.wait ());
+
+        // The watch follows the new target.
+        std::ofstream (dir / "..v2" / "log4cplus.properties") << "a=3\n";
+        CATCH_REQUIRE (notifier.wait ());
+    }
+
+    CATCH_SECTION ("write")
+    {
+        std::ofstream (dir / "..v1" / "log4cplus.properties") << "a=3\n";
+        CATCH_REQUIRE (notifier.wait ());
+    }
+
+    CATCH_SECTION ("unrelated entries are ignored")
+    {
+        std::thread thread ([&] {
+            std::ofstream (dir / "other.log") << "x\n";
+            std::ofstream (dir / "..v1" / "other.log") << "x\n";
+            std::this_thread::sleep_for (std::chrono::milliseconds (200));
+            notifier.interrupt ();
+        });
+        CATCH_REQUIRE (! notifier.wait ());
+        thread.join ();
+    }
+
+    fs::remove_all (dir);
+}
+#endif
+#endif
+
+
 } // namespace log4cplus
@@ -32,6 +32,15 @@ namespace log4cplus::helpers {
 
 IConnectorThreadClient::~IConnectorThreadClient () = default;
 
+
+bool
+IConnectorThreadClient::ctcReplay ()
+{
+    thread::MutexGuard guard (ctcGetAccessMutex ());
+    ctcSetConnected ();
+    return true;
+}
+
 //
 //
 //
@@ -97,8 +106,15 @@ ConnectorThread::run ()
         {
             thread::MutexGuard guard (client_access_mutex);
             client_socket = std::move (new_socket);
-            ctc.ctcSetConnected ();
         }
+
+        // Let the client send events it has stored while it was
+        // disconnected.
+
+        if (! ctc.ctcReplay ())
+            helpers::getLogLog().error(
+                LOG4CPLUS_TEXT("ConnectorThread::run()")
+                LOG4CPLUS_TEXT("- Connection failed during replay"));
     }
 }
 
@@ -110,6 +110,8 @@ ConsoleAppender::close()
 void
 ConsoleAppender::append(const spi::InternalLoggingEvent& event)
 {
+    tstring const & str = formatEvent (event);
+
     thread::MutexGuard guard (getOutputMutex ());
 
     tostream& output = (logToStdErr ? tcerr : tcout);
@@ -119,7 +121,7 @@ ConsoleAppender::append(const spi::InternalLoggingEvent& event)
         cur_loc = output.getloc();
         output.imbue(*locale);
     }
-    layout->formatAndAppend(output, event);
+    output.write(str.data(), static_cast<std::streamsize>(str.size()));
     if(immediateFlush) {
         output.flush();
     }
@@ -25,6 +25,15 @@
 
 
 #include <log4cplus/helpers/eventcounter.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <algorithm>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#endif
 
 namespace log4cplus {
 
@@ -39,7 +48,7 @@ BaseEventCounter::~BaseEventCounter ()
 std::size_t
 BaseEventCounter::record_event ()
 {
-    return ++event_count;
+    return event_count.fetch_add (1, std::memory_order_relaxed) + 1;
 }
 
 //
@@ -60,8 +69,7 @@ SteadyClockGate::~SteadyClockGate ()
 bool
 SteadyClockGate::latch_open (SteadyClockGate::Info & info)
 {
-    std::size_t count = event_count.load ();
-    if (count == 0)
+    if (event_count.load (std::memory_order_relaxed) == 0)
         return false;
 
     if (! mtx.try_lock ())
@@ -76,9 +84,11 @@ SteadyClockGate::latch_open (SteadyClockGate::Info & info)
     if (now >= timeout_point
         // Has anything changed since the first check
         // at the start of the function?
-        && (count = event_count.load ()) > 0)
+        && event_count.load (std::memory_order_relaxed) > 0)
     {
-        info.count = count;
+        // Take the events counted so far. Events recorded concurrently
+        // are left for the next report.
+        info.count = event_count.exchange (0, std::memory_order_relaxed);
         info.time_span = now - prev_timeout_point;
         prev_timeout_point = now;
         timeout_point += pause_duration;
@@ -93,6 +103,214 @@ SteadyClockGate::latch_open (SteadyClockGate::Info & info)
 SteadyClockGate::Info::~Info ()
 = default;
 
+//
+//
+//
+
+OverflowPolicy::OverflowPolicy ()
+    : action (OPBlock)
+    , overflowLevel (WARN_LOG_LEVEL)
+    , sampleRate (10)
+    , reservedCapacity (0)
+    , reservedLevel (ERROR_LOG_LEVEL)
+{ }
+
+
+OverflowPolicy::OverflowPolicy (OverflowPolicy const & other)
+    : action (other.action)
+    , overflowLevel (other.overflowLevel)
+    , sampleRate (other.sampleRate)
+    , reservedCapacity (other.reservedCapacity)
+    , reservedLevel (other.reservedLevel)
+{ }
+
+
+OverflowPolicy &
+OverflowPolicy::operator = (OverflowPolicy const & other)
+{
+    action = other.action;
+    overflowLevel = other.overflowLevel;
+    sampleRate = other.sampleRate;
+    reservedCapacity = other.reservedCapacity;
+    reservedLevel = other.reservedLevel;
+    return *this;
+}
+
+
+OverflowPolicy::~OverflowPolicy ()
+= default;
+
+
+void
+OverflowPolicy::configure (Properties const & properties)
+{
+    tstring const action_str = toLower (
+        properties.getProperty (LOG4CPLUS_TEXT ("OverflowPolicy")));
+    if (action_str == LOG4CPLUS_TEXT ("block"))
+        action = OPBlock;
+    else if (action_str == LOG4CPLUS_TEXT ("dropnewest"))
+        action = OPDropNewest;
+    else if (action_str == LOG4CPLUS_TEXT ("dropoldest"))
+        action = OPDropOldest;
+    else if (action_str == LOG4CPLUS_TEXT ("dropbelowlevel"))
+        action = OPDropBelowLevel;
+    else if (action_str == LOG4CPLUS_TEXT ("sample"))
+        action = OPSample;
+    else if (! action_str.empty ())
+        getLogLog ().error (
+            LOG4CPLUS_TEXT ("Unknown OverflowPolicy: ") + action_str);
+
+    LogLevelManager & llm = getLogLevelManager ();
+    tstring level_str;
+    if (properties.getString (level_str, LOG4CPLUS_TEXT ("OverflowLevel")))
+        overflowLevel = llm.fromString (toUpper (level_str));
+    if (properties.getString (level_str, LOG4CPLUS_TEXT ("ReservedLevel")))
+        reservedLevel = llm.fromString (toUpper (level_str));
+
+    properties.getUInt (sampleRate, LOG4CPLUS_TEXT ("SampleRate"));
+    if (sampleRate == 0)
+        sampleRate = 1;
+
+    unsigned reserved = 0;
+    if (properties.getUInt (reserved, LOG4CPLUS_TEXT ("ReservedCapacity")))
+        reservedCapacity = reserved;
+}
+
+
+OverflowPolicy::Decision
+OverflowPolicy::decide (LogLevel ll, std::size_t size, std::size_t capacity)
+{
+    bool const reserved = ll >= reservedLevel;
+    std::size_t const limit = reserved || reservedCapacity >= capacity
+        ? capacity
+        : capacity - reservedCapacity;
+
+    if (action == OPSample && ! reserved && size >= limit / 2
+        && size < limit)
+        return sampleCounter.fetch_add (1, std::memory_order_relaxed)
+            % sampleRate == 0
+            ? ODAccept
+            : ODDrop;
+
+    if (size < limit)
+        return ODAccept;
+
+    switch (action)
+    {
+    case OPBlock:
+        return ODWait;
+
+    case OPDropOldest:
+        return ODEvict;
+
+    case OPDropBelowLevel:
+        return ll < overflowLevel ? ODDrop : ODWait;
+
+    case OPDropNewest:
+    case OPSample:
+    default:
+        return ODDrop;
+    }
+}
+
+
+bool
+OverflowPolicy::evictPacked (std::vector<char> & arena, std::size_t & head,
+    std::size_t count)
+{
+    // Events at or above reserved level are never evicted, scan past
+    // them.
+    std::size_t offset = head;
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        char const * const record = arena.data () + offset;
+        std::size_t const size
+            = spi::InternalLoggingEvent::packedSize (record);
+        LogLevel const ll = spi::InternalLoggingEvent::packedLogLevel (record);
+        if (ll >= reservedLevel)
+        {
+            offset += size;
+            continue;
+        }
+
+        recordDrop (ll);
+        auto const pos = arena.begin () + static_cast<std::ptrdiff_t>(offset);
+        if (offset == head)
+            head += size;
+        else
+            arena.erase (pos, pos + static_cast<std::ptrdiff_t>(size));
+
+        // Do not let evicted records pile up in front of the arena while
+        // the consumer is busy.
+        if (head > arena.size () / 2)
+        {
+            arena.erase (arena.begin (),
+                arena.begin () + static_cast<std::ptrdiff_t>(head));
+            head = 0;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+std::size_t
+OverflowPolicy::levelIndex (LogLevel ll)
+{
+    return static_cast<std::size_t>(
+        std::clamp<LogLevel> (ll / DEBUG_LOG_LEVEL, 0,
+            static_cast<LogLevel>(std::tuple_size_v<decltype (drops)> - 1)));
+}
+
+
+void
+OverflowPolicy::recordDrop (LogLevel ll)
+{
+    drops[levelIndex (ll)].fetch_add (1, std::memory_order_relaxed);
+}
+
+
+std::size_t
+OverflowPolicy::getDropCount (LogLevel ll) const
+{
+    return drops[levelIndex (ll)].load (std::memory_order_relaxed);
+}
+
+
+std::size_t
+OverflowPolicy::getDropCount () const
+{
+    std::size_t count = 0;
+    for (auto const & drop : drops)
+        count += drop.load (std::memory_order_relaxed);
+    return count;
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("SteadyClockGate", "[eventcounter]")
+{
+    SteadyClockGate gate (SteadyClockGate::Duration::zero ());
+    SteadyClockGate::Info info;
+
+    CATCH_REQUIRE (! gate.latch_open (info));
+
+    CATCH_REQUIRE (gate.record_event () == 1);
+    CATCH_REQUIRE (gate.record_event () == 2);
+    CATCH_REQUIRE (gate.record_event () == 3);
+    CATCH_REQUIRE (gate.latch_open (info));
+    CATCH_REQUIRE (info.count == 3);
+
+    // Each report covers only events recorded since the previous one.
+    CATCH_REQUIRE (! gate.latch_open (info));
+    gate.record_event ();
+    CATCH_REQUIRE (gate.latch_open (info));
+    CATCH_REQUIRE (info.count == 1);
+}
+#endif
+
 } // namespace helpers
 
 } // namespace log4cplus
\ No newline at end of file
@@ -28,6 +28,7 @@
 #include <log4cplus/fileappender.h>
 #include <log4cplus/nteventlogappender.h>
 #include <log4cplus/nullappender.h>
+#include <log4cplus/ringfileappender.h>
 #include <log4cplus/socketappender.h>
 #include <log4cplus/syslogappender.h>
 #include <log4cplus/win32debugappender.h>
@@ -182,6 +183,7 @@ void initializeFactoryRegistry()
     LOG4CPLUS_REG_APPENDER (reg, AsyncAppender);
 #endif
     LOG4CPLUS_REG_APPENDER (reg, Log4jUdpAppender);
+    LOG4CPLUS_REG_APPENDER (reg, RingFileAppender);
 
     spi::LayoutFactoryRegistry& reg2 = spi::getLayoutFactoryRegistry();
     DisableFactoryLocking<spi::LayoutFactoryRegistry> dfl_reg2 (reg2);
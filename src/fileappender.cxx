@@ -18,6 +18,21 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_SYS_TYPES_H)
+#include <sys/types.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_SYS_STAT_H)
+#include <sys/stat.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_FCNTL_H)
+#include <fcntl.h>
+#endif
+
 #include <log4cplus/fileappender.h>
 #include <log4cplus/layout.h>
 #include <log4cplus/streams.h>
@@ -28,15 +43,23 @@
 #include <log4cplus/helpers/fileinfo.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <log4cplus/thread/threads.h>
 #include <log4cplus/internal/internal.h>
 #include <log4cplus/internal/env.h>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <cstdio>
 #include <stdexcept>
 #include <cmath> // std::fmod
+#include <deque>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <vector>
 
 // For _wrename() and _wremove() on Windows.
 #include <stdio.h>
@@ -45,8 +68,22 @@
 #include <errno.h>
 #endif
 
+#if defined (LOG4CPLUS_WITH_ZLIB)
+#include <zlib.h>
+#endif
+#if defined (LOG4CPLUS_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+#if ! defined (_WIN32) && defined (LOG4CPLUS_HAVE_UNISTD_H) \
+    && defined (LOG4CPLUS_HAVE_FCNTL_H) && defined (LOG4CPLUS_HAVE_SYS_STAT_H)
+#  define LOG4CPLUS_USE_FD_FILE_ENGINE
+#endif
+
 #if defined (LOG4CPLUS_WITH_UNIT_TESTS)
 #include <catch_amalgamated.hpp>
+#include <thread>
+#include <vector>
 #endif
 
 
@@ -142,9 +179,9 @@ loglog_renaming_result (helpers::LogLog & loglog, tstring const & src,
 static
 void
 loglog_opening_result (helpers::LogLog & loglog,
-    log4cplus::tostream const & os, tstring const & filename)
+    bool good, tstring const & filename)
 {
-    if (! os)
+    if (! good)
     {
         loglog.error (
             LOG4CPLUS_TEXT("Failed to open file ")
@@ -155,13 +192,14 @@ loglog_opening_result (helpers::LogLog & loglog,
 
 static
 void
-rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
+rolloverFiles(const tstring& filename, unsigned int maxBackupIndex,
+    const tstring& suffix = tstring ())
 {
     helpers::LogLog * loglog = helpers::LogLog::getLogLog();
 
     // Delete the oldest file
     tostringstream buffer;
-    buffer << filename << LOG4CPLUS_TEXT(".") << maxBackupIndex;
+    buffer << filename << LOG4CPLUS_TEXT(".") << maxBackupIndex << suffix;
     long ret = file_remove (buffer.str ());
 
     tostringstream source_oss;
@@ -173,8 +211,8 @@ rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
         source_oss.str(internal::empty_str);
         target_oss.str(internal::empty_str);
 
-        source_oss << filename << LOG4CPLUS_TEXT(".") << i;
-        target_oss << filename << LOG4CPLUS_TEXT(".") << (i+1);
+        source_oss << filename << LOG4CPLUS_TEXT(".") << i << suffix;
+        target_oss << filename << LOG4CPLUS_TEXT(".") << (i+1) << suffix;
 
         tstring const source (source_oss.str ());
         tstring const target (target_oss.str ());
@@ -190,9 +228,649 @@ rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
     }
 } // end rolloverFiles()
 
+
+static
+tstring
+compression_suffix (FileCompression compression)
+{
+    switch (compression)
+    {
+    case FileCompression::GZIP:
+        return LOG4CPLUS_TEXT (".gz");
+
+    case FileCompression::ZSTD:
+        return LOG4CPLUS_TEXT (".zst");
+
+    default:
+        return tstring ();
+    }
+}
+
+
+#if defined (LOG4CPLUS_WITH_ZLIB)
+static
+bool
+gzip_file (std::ifstream & in, tstring const & dest)
+{
+#if defined (_WIN32) && defined (UNICODE)
+    gzFile gz = gzopen_w (dest.c_str (), "wb");
+#else
+    gzFile gz = gzopen (LOG4CPLUS_TSTRING_TO_STRING (dest).c_str (), "wb");
+#endif
+    if (! gz)
+        return false;
+
+    std::vector<char> buf (64 * 1024);
+    bool ok = true;
+    while (ok && (in.read (buf.data (), static_cast<std::streamsize>(buf.size ()))
+            || in.gcount () != 0))
+    {
+        auto const count = static_cast<unsigned>(in.gcount ());
+        ok = gzwrite (gz, buf.data (), count) == static_cast<int>(count);
+    }
+
+    return gzclose (gz) == Z_OK && ok && in.eof ();
+}
+#endif
+
+
+#if defined (LOG4CPLUS_WITH_ZSTD)
+static
+bool
+zstd_file (std::ifstream & in, tstring const & dest)
+{
+    std::ofstream out (std::filesystem::path (dest),
+        std::ios_base::binary | std::ios_base::trunc);
+    std::unique_ptr<ZSTD_CCtx, decltype (&ZSTD_freeCCtx)> cctx (
+        ZSTD_createCCtx (), &ZSTD_freeCCtx);
+    if (! out || ! cctx)
+        return false;
+
+    std::vector<char> in_buf (ZSTD_CStreamInSize ());
+    std::vector<char> out_buf (ZSTD_CStreamOutSize ());
+    bool last = false;
+    while (! last)
+    {
+        in.read (in_buf.data (), static_cast<std::streamsize>(in_buf.size ()));
+        if (in.bad ())
+            return false;
+
+        last = in.eof ();
+        ZSTD_EndDirective const mode = last ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer input { in_buf.data (),
+            static_cast<std::size_t>(in.gcount ()), 0 };
+        bool finished = false;
+        while (! finished)
+        {
+            ZSTD_outBuffer output { out_buf.data (), out_buf.size (), 0 };
+            std::size_t const remaining = ZSTD_compressStream2 (cctx.get (),
+                &output, &input, mode);
+            if (ZSTD_isError (remaining))
+                return false;
+
+            out.write (out_buf.data (),
+                static_cast<std::streamsize>(output.pos));
+            finished = last ? remaining == 0 : input.pos == input.size;
+        }
+    }
+
+    out.close ();
+    return ! out.fail ();
+}
+#endif
+
+
+//! Compresses <code>src</code> into <code>dest</code> and removes
+//! <code>src</code>. Compressed data are appended to <code>dest</code>
+//! if it exists already; both gzip and zstd allow concatenation.
+static
+void
+compress_rolled_file (tstring const & src, tstring const & dest,
+    FileCompression compression)
+{
+    helpers::LogLog & loglog = helpers::getLogLog ();
+    tstring const part = dest + LOG4CPLUS_TEXT (".part");
+
+    bool ok = false;
+    {
+        std::ifstream in (std::filesystem::path (src), std::ios_base::binary);
+        if (in)
+            switch (compression)
+            {
+#if defined (LOG4CPLUS_WITH_ZLIB)
+            case FileCompression::GZIP:
+                ok = gzip_file (in, part);
+                break;
+#endif
+
+#if defined (LOG4CPLUS_WITH_ZSTD)
+            case FileCompression::ZSTD:
+                ok = zstd_file (in, part);
+                break;
+#endif
+
+            default:
+                break;
+            }
+    }
+
+    std::error_code ec;
+    if (ok && std::filesystem::exists (std::filesystem::path (dest), ec))
+    {
+        std::ifstream in (std::filesystem::path (part), std::ios_base::binary);
+        std::ofstream out (std::filesystem::path (dest),
+            std::ios_base::binary | std::ios_base::app);
+        out << in.rdbuf ();
+        out.close ();
+        ok = ! out.fail ();
+        file_remove (part);
+    }
+    else if (ok)
+        ok = file_rename (part, dest) == 0;
+
+    if (! ok)
+    {
+        loglog.error (LOG4CPLUS_TEXT ("Failed to compress file ") + src
+            + LOG4CPLUS_TEXT (" to ") + dest);
+        file_remove (part);
+        return;
+    }
+
+    loglog.debug (LOG4CPLUS_TEXT ("Compressed file ") + src
+        + LOG4CPLUS_TEXT (" to ") + dest);
+    file_remove (src);
+}
+
+
+//! \return Unique name to which a rolled over file is renamed before it
+//! is compressed in the background.
+static
+tstring
+staging_filename (tstring const & filename)
+{
+    static std::atomic<unsigned long> counter {0};
+    tostringstream oss;
+    oss << filename << LOG4CPLUS_TEXT (".rolled-")
+        << std::chrono::duration_cast<std::chrono::microseconds> (
+            std::chrono::system_clock::now ().time_since_epoch ()).count ()
+        << LOG4CPLUS_TEXT ("-")
+        << counter.fetch_add (1, std::memory_order_relaxed);
+    return oss.str ();
+}
+
+
+//! Moves rolled over file <code>src</code> to <code>dest</code>,
+//! compressing it if requested.
+static
+void
+move_rolled_file (tstring const & src, tstring const & dest,
+    FileCompression compression)
+{
+    if (compression != FileCompression::NONE)
+    {
+        compress_rolled_file (src, dest, compression);
+        return;
+    }
+
+#if defined (_WIN32)
+    // Try to remove the target first. It seems it is not
+    // possible to rename over existing file.
+    file_remove (dest);
+#endif
+
+    loglog_renaming_result (helpers::getLogLog (), src, dest,
+        file_rename (src, dest));
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+//! Base of the background threads of this file. The thread is started
+//! when there is work for it and joined again by stopThread(). Derived
+//! classes keep their state under mtx, wait on cv and return from
+//! run() once stop is set. Both lifecycle functions are called with
+//! lifecycle_mtx held.
+class OnDemandThread
+{
+protected:
+    OnDemandThread () = default;
+    virtual ~OnDemandThread () = default;
+
+    //! Starts the thread or wakes it up if it is already running.
+    void
+    wake ()
+    {
+        if (! worker_thread)
+        {
+            worker_thread = new WorkerThread (*this);
+            worker_thread->start ();
+        }
+        else
+            cv.notify_one ();
+    }
+
+    //! Sets stop, waits for run() to return and resets stop.
+    void
+    stopThread ()
+    {
+        if (! worker_thread)
+            return;
+
+        {
+            std::unique_lock<std::mutex> guard (mtx);
+            stop = true;
+        }
+
+        cv.notify_one ();
+        worker_thread->join ();
+        worker_thread = nullptr;
+        stop = false;
+    }
+
+    virtual void run () = 0;
+
+    std::mutex lifecycle_mtx;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop = false;
+
+private:
+    class WorkerThread
+        : public thread::AbstractThread
+    {
+    public:
+        explicit WorkerThread (OnDemandThread & owner_)
+            : owner (owner_)
+        { }
+
+        void
+        run () override
+        {
+            owner.run ();
+        }
+
+    private:
+        OnDemandThread & owner;
+    };
+
+    thread::AbstractThreadPtr worker_thread;
+};
+
+
+//! Background thread that runs rollover jobs, e.g., compression of
+//! rolled over files, one by one in order in which they were posted.
+class RolloverWorker
+    : public OnDemandThread
+{
+public:
+    static
+    RolloverWorker &
+    get ()
+    {
+        // Leaked on purpose. Appenders closed during static destruction
+        // may still post jobs. Jobs posted until then are run at exit.
+        static RolloverWorker * const worker = new RolloverWorker;
+        static struct Finisher
+        {
+            ~Finisher ()
+            {
+                worker->shutdown ();
+            }
+        } const finisher;
+        (void) finisher;
+        return *worker;
+    }
+
+    void
+    post (std::function<void ()> job)
+    {
+        std::unique_lock<std::mutex> lifecycle_guard (lifecycle_mtx);
+        {
+            std::unique_lock<std::mutex> guard (mtx);
+            jobs.push_back (std::move (job));
+        }
+
+        wake ();
+    }
+
+    //! Runs all posted jobs and stops the thread. It is started again
+    //! by the next post().
+    void
+    shutdown ()
+    {
+        std::unique_lock<std::mutex> lifecycle_guard (lifecycle_mtx);
+        stopThread ();
+    }
+
+private:
+    RolloverWorker () = default;
+
+    void
+    run () override
+    {
+        std::unique_lock<std::mutex> guard (mtx);
+        for (;;)
+        {
+            cv.wait (guard, [this] { return stop || ! jobs.empty (); });
+            if (jobs.empty ())
+                break;
+
+            std::function<void ()> job (std::move (jobs.front ()));
+            jobs.pop_front ();
+            guard.unlock ();
+            job ();
+            guard.lock ();
+        }
+    }
+
+    std::deque<std::function<void ()> > jobs;
+};
+#endif
+
+
+static
+void
+post_rollover_job (std::function<void ()> job)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    RolloverWorker::get ().post (std::move (job));
+#else
+    job ();
+#endif
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+//! Background timer that flushes file appenders whose oldest unflushed
+//! event has become older than their FlushInterval. Its thread runs
+//! only while there are any appenders registered.
+class FlushTimer
+    : public OnDemandThread
+{
+public:
+    static
+    FlushTimer &
+    get ()
+    {
+        // Leaked on purpose. Appenders are closed, and unregistered,
+        // during static destruction, too.
+        static FlushTimer * const timer = new FlushTimer;
+        return *timer;
+    }
+
+    void
+    add (FileAppenderBase * appender, std::chrono::milliseconds interval)
+    {
+        std::unique_lock<std::mutex> lifecycle_guard (lifecycle_mtx);
+        {
+            std::unique_lock<std::mutex> guard (mtx);
+            appenders.emplace_back (appender, interval);
+        }
+
+        wake ();
+    }
+
+    void
+    remove (FileAppenderBase * appender)
+    {
+        std::unique_lock<std::mutex> lifecycle_guard (lifecycle_mtx);
+        {
+            std::unique_lock<std::mutex> guard (mtx);
+            auto it = std::find_if (appenders.begin (), appenders.end (),
+                [appender] (auto const & entry) {
+                    return entry.first == appender; });
+            if (it == appenders.end ())
+                return;
+
+            appenders.erase (it);
+            if (! appenders.empty ())
+                return;
+        }
+
+        stopThread ();
+    }
+
+private:
+    FlushTimer () = default;
+
+    void
+    run () override
+    {
+        std::unique_lock<std::mutex> guard (mtx);
+        while (! stop)
+        {
+            // Check twice per the shortest interval so that an idle
+            // appender is flushed at most half of its interval late.
+            auto tick = std::chrono::milliseconds::max ();
+            for (auto const & entry : appenders)
+                tick = (std::min) (tick, entry.second);
+            tick = (std::max) (tick / 2, std::chrono::milliseconds (1));
+
+            cv.wait_for (guard, tick);
+            if (stop)
+                break;
+
+            for (auto const & entry : appenders)
+                entry.first->flushExpired ();
+        }
+    }
+
+    std::vector<std::pair<FileAppenderBase *, std::chrono::milliseconds> >
+        appenders;
+};
+#endif
+
 } // namespace
 
 
+//! Waits for background rollover jobs to finish. It is called by
+//! deinitialize().
+void
+shutdownRolloverWorker ()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    RolloverWorker::get ().shutdown ();
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileAppenderBase::FdFile
+///////////////////////////////////////////////////////////////////////////////
+
+//! Output file written through a POSIX file descriptor. It keeps its own
+//! buffer and tracks the file size so that neither writing nor the size
+//! checks of rolling appenders go through std::basic_filebuf.
+class FileAppenderBase::FdFile
+{
+public:
+    FdFile (std::size_t buffer_size_, SyncPolicy sync_)
+        : buffer_size (buffer_size_ != 0 ? buffer_size_ : 8 * 1024)
+        , sync (sync_)
+    {
+        buffer.reserve (buffer_size);
+    }
+
+    ~FdFile ()
+    {
+        close ();
+    }
+
+    bool
+    open (tstring const & name, bool truncate)
+    {
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+        close ();
+        failed = false;
+
+        int flags = O_WRONLY | O_CREAT | O_APPEND;
+#if defined (O_CLOEXEC)
+        flags |= O_CLOEXEC;
+#endif
+        if (truncate)
+            flags |= O_TRUNC;
+
+        std::string const name_str = LOG4CPLUS_TSTRING_TO_STRING (name);
+        do
+            fd = ::open (name_str.c_str (), flags, 0666);
+        while (fd == -1 && errno == EINTR);
+
+        if (fd == -1)
+            return false;
+
+        refreshSize ();
+        return true;
+
+#else
+        (void) name;
+        (void) truncate;
+        return false;
+
+#endif
+    }
+
+    void
+    close ()
+    {
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+        if (fd == -1)
+            return;
+
+        writeBuffer ();
+        if (sync != SPNone)
+            syncFile ();
+
+        ::close (fd);
+        fd = -1;
+#endif
+    }
+
+    bool
+    good () const
+    {
+        return fd != -1 && ! failed;
+    }
+
+    void
+    write (tstring const & str)
+    {
+#if defined (UNICODE)
+        for (wchar_t wch : str)
+        {
+            auto const cp = static_cast<std::uint32_t>(wch);
+            if (cp < 0x80)
+                buffer.push_back (static_cast<char>(cp));
+            else if (cp < 0x800)
+            {
+                buffer.push_back (static_cast<char>(0xC0 | (cp >> 6)));
+                buffer.push_back (static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else if (cp < 0x10000)
+            {
+                buffer.push_back (static_cast<char>(0xE0 | (cp >> 12)));
+                buffer.push_back (static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                buffer.push_back (static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else
+            {
+                buffer.push_back (static_cast<char>(0xF0 | (cp >> 18)));
+                buffer.push_back (static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                buffer.push_back (static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                buffer.push_back (static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+
+#else
+        buffer.insert (buffer.end (), str.begin (), str.end ());
+
+#endif
+
+        if (buffer.size () >= buffer_size)
+            writeBuffer ();
+    }
+
+    void
+    flush ()
+    {
+        writeBuffer ();
+        if (sync == SPFlush)
+            syncFile ();
+    }
+
+    std::streamoff
+    size () const
+    {
+        return static_cast<std::streamoff>(file_size + buffer.size ());
+    }
+
+    //! Re-reads file size; other processes might have appended to it.
+    void
+    refreshSize ()
+    {
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+        struct stat st;
+        if (fd != -1 && ::fstat (fd, &st) == 0)
+            file_size = static_cast<std::uint64_t>(st.st_size);
+#endif
+    }
+
+private:
+    void
+    writeBuffer ()
+    {
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+        char const * data = buffer.data ();
+        std::size_t left = buffer.size ();
+        while (left != 0 && fd != -1)
+        {
+            ssize_t const ret = ::write (fd, data, left);
+            if (ret == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                helpers::getLogLog ().error (
+                    LOG4CPLUS_TEXT ("Failed to write to file descriptor")
+                    LOG4CPLUS_TEXT ("; error ")
+                    + helpers::convertIntegerToString (errno));
+                failed = true;
+                break;
+            }
+
+            data += ret;
+            left -= static_cast<std::size_t>(ret);
+            file_size += static_cast<std::uint64_t>(ret);
+        }
+#endif
+        buffer.clear ();
+    }
+
+    void
+    syncFile ()
+    {
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+#  if defined (_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+        int const ret = ::fdatasync (fd);
+#  else
+        int const ret = ::fsync (fd);
+#  endif
+        if (ret == -1)
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Failed to synchronize file")
+                LOG4CPLUS_TEXT ("; error ")
+                + helpers::convertIntegerToString (errno));
+#endif
+    }
+
+    int fd = -1;
+    bool failed = false;
+    std::size_t const buffer_size;
+    SyncPolicy const sync;
+    std::vector<char> buffer;
+    std::uint64_t file_size = 0;
+};
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // FileAppenderBase ctors and dtor
 ///////////////////////////////////////////////////////////////////////////////
@@ -204,6 +882,15 @@ FileAppenderBase::FileAppenderBase(const tstring& filename_,
     , reopenDelay(1)
     , bufferSize (0)
     , buffer (nullptr)
+    , flushBytes (0)
+    , flushEvents (0)
+    , flushInterval (0)
+    , unflushedBytes (0)
+    , unflushedEvents (0)
+    , fileEngine (FEStream)
+    , syncPolicy (SPNone)
+    , compression (FileCompression::NONE)
+    , asyncRollover (false)
     , filename(filename_)
     , localeName (LOG4CPLUS_TEXT ("DEFAULT"))
     , fileOpenMode(mode_)
@@ -218,6 +905,15 @@ FileAppenderBase::FileAppenderBase(const Properties& props,
     , reopenDelay(1)
     , bufferSize (0)
     , buffer (nullptr)
+    , flushBytes (0)
+    , flushEvents (0)
+    , flushInterval (0)
+    , unflushedBytes (0)
+    , unflushedEvents (0)
+    , fileEngine (FEStream)
+    , syncPolicy (SPNone)
+    , compression (FileCompression::NONE)
+    , asyncRollover (false)
 {
     filename = props.getProperty(LOG4CPLUS_TEXT("File"));
     lockFileName = props.getProperty (LOG4CPLUS_TEXT ("LockFile"));
@@ -228,6 +924,14 @@ FileAppenderBase::FileAppenderBase(const Properties& props,
     props.getInt (reopenDelay, LOG4CPLUS_TEXT("ReopenDelay"));
     props.getULong (bufferSize, LOG4CPLUS_TEXT("BufferSize"));
 
+    unsigned interval = 0;
+    props.getULong (flushBytes, LOG4CPLUS_TEXT("FlushBytes"));
+    props.getUInt (flushEvents, LOG4CPLUS_TEXT("FlushEvents"));
+    props.getUInt (interval, LOG4CPLUS_TEXT("FlushInterval"));
+    flushInterval = std::chrono::milliseconds (interval);
+    if (flushBytes != 0 || flushEvents != 0 || interval != 0)
+        immediateFlush = false;
+
     bool app = (mode_ & (std::ios_base::app | std::ios_base::ate)) != 0;
     props.getBool (app, LOG4CPLUS_TEXT("Append"));
     fileOpenMode = app ? std::ios::app : std::ios::trunc;
@@ -235,9 +939,67 @@ FileAppenderBase::FileAppenderBase(const Properties& props,
     if (props.getProperty(LOG4CPLUS_TEXT("TextMode"), LOG4CPLUS_TEXT("Text"))
         == LOG4CPLUS_TEXT("Binary"))
         fileOpenMode |= std::ios_base::binary;
+
+    tstring const engine = helpers::toLower (
+        props.getProperty (LOG4CPLUS_TEXT ("FileEngine")));
+    if (engine == LOG4CPLUS_TEXT ("fd"))
+    {
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+        fileEngine = FEFd;
+#else
+        helpers::getLogLog ().warn (
+            LOG4CPLUS_TEXT ("FileEngine fd is not available,")
+            LOG4CPLUS_TEXT (" using stream instead"));
+#endif
+    }
+    else if (! engine.empty () && engine != LOG4CPLUS_TEXT ("stream"))
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("Unknown FileEngine: ") + engine);
+
+    tstring const sync = helpers::toLower (
+        props.getProperty (LOG4CPLUS_TEXT ("SyncPolicy")));
+    if (sync == LOG4CPLUS_TEXT ("flush"))
+        syncPolicy = SPFlush;
+    else if (sync == LOG4CPLUS_TEXT ("close"))
+        syncPolicy = SPClose;
+    else if (! sync.empty () && sync != LOG4CPLUS_TEXT ("none"))
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("Unknown SyncPolicy: ") + sync);
+
+    tstring const compression_str = helpers::toLower (
+        props.getProperty (LOG4CPLUS_TEXT ("Compression")));
+    if (compression_str == LOG4CPLUS_TEXT ("gzip"))
+    {
+#if defined (LOG4CPLUS_WITH_ZLIB)
+        compression = FileCompression::GZIP;
+#else
+        helpers::getLogLog ().warn (
+            LOG4CPLUS_TEXT ("Compression gzip is not available"));
+#endif
+    }
+    else if (compression_str == LOG4CPLUS_TEXT ("zstd"))
+    {
+#if defined (LOG4CPLUS_WITH_ZSTD)
+        compression = FileCompression::ZSTD;
+#else
+        helpers::getLogLog ().warn (
+            LOG4CPLUS_TEXT ("Compression zstd is not available"));
+#endif
+    }
+    else if (! compression_str.empty ()
+        && compression_str != LOG4CPLUS_TEXT ("none"))
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("Unknown Compression: ") + compression_str);
+
+    props.getBool (asyncRollover, LOG4CPLUS_TEXT("AsyncRollover"));
+    if (compression != FileCompression::NONE)
+        asyncRollover = true;
 }
 
 
+FileAppenderBase::~FileAppenderBase() = default;
+
+
 void
 FileAppenderBase::init()
 {
@@ -254,7 +1016,9 @@ FileAppenderBase::init()
         lockFileName += LOG4CPLUS_TEXT(".lock");
     }
 
-    if (bufferSize != 0)
+    if (fileEngine == FEFd)
+        fdFile = std::make_unique<FdFile> (bufferSize, syncPolicy);
+    else if (bufferSize != 0)
     {
         buffer.reset (new tchar[bufferSize]);
         out.rdbuf ()->pubsetbuf (buffer.get (), bufferSize);
@@ -281,6 +1045,11 @@ FileAppenderBase::init()
 
     open(fileOpenMode);
     imbue (internal::get_locale_by_name (localeName));
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (flushInterval.count () != 0)
+        FlushTimer::get ().add (this, flushInterval);
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -290,14 +1059,38 @@ FileAppenderBase::init()
 void
 FileAppenderBase::close()
 {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // The timer has to be left before access_mutex is taken because the
+    // timer takes access_mutex while flushing.
+    if (flushInterval.count () != 0)
+        FlushTimer::get ().remove (this);
+#endif
+
     thread::MutexGuard guard (access_mutex);
 
-    out.close();
+    closeFile ();
     buffer.reset ();
+    unflushedBytes = 0;
+    unflushedEvents = 0;
     closed = true;
 }
 
 
+void
+FileAppenderBase::flushExpired()
+{
+    thread::MutexGuard guard (access_mutex);
+
+    if (unflushedEvents != 0
+        && std::chrono::steady_clock::now () - firstUnflushed >= flushInterval)
+    {
+        flushFile ();
+        unflushedBytes = 0;
+        unflushedEvents = 0;
+    }
+}
+
+
 std::locale
 FileAppenderBase::imbue(std::locale const& loc)
 {
@@ -318,14 +1111,14 @@ FileAppenderBase::getloc () const
 
 // This method does not need to be locked since it is called by
 // doAppend() which performs the locking
-void
-FileAppenderBase::append(const spi::InternalLoggingEvent& event)
+bool
+FileAppenderBase::prepareForAppend()
 {
-    if(!out.good()) {
+    if(!isFileGood()) {
         if(!reopen()) {
             getErrorHandler()->error(  LOG4CPLUS_TEXT("file is not open: ")
                                      + filename);
-            return;
+            return false;
         }
         // Resets the error handler to make it
         // ready to handle a future append error.
@@ -334,12 +1127,96 @@ FileAppenderBase::append(const spi::InternalLoggingEvent& event)
     }
 
     if (useLockFile)
-        out.seekp (0, std::ios_base::end);
+        seekFileEnd ();
+
+    return true;
+}
+
+
+void
+FileAppenderBase::append(const spi::InternalLoggingEvent& event)
+{
+    if (! prepareForAppend ())
+        return;
 
-    layout->formatAndAppend(out, event);
+    tstring const & str = formatEvent (event);
+    writeFile (str);
 
-    if(immediateFlush || useLockFile)
-        out.flush();
+    commitAppend (str.size (), 1);
+}
+
+
+void
+FileAppenderBase::appendBatch(
+    std::span<const spi::InternalLoggingEvent> events)
+{
+    if (! supportsBatchWrite ())
+    {
+        Appender::appendBatch (events);
+        return;
+    }
+
+    if (! prepareForAppend ())
+        return;
+
+    tstring & str = internal::get_appender_sp ().str;
+    str.clear ();
+    std::size_t accepted = 0;
+    for (auto const & event : events)
+        if (isAccepted (event))
+        {
+            layout->formatInto (str, event);
+            ++accepted;
+        }
+
+    if (str.empty ())
+        return;
+
+    writeFile (str);
+
+    commitAppend (str.size (), accepted);
+}
+
+
+bool
+FileAppenderBase::supportsBatchWrite() const
+{
+    return true;
+}
+
+
+void
+FileAppenderBase::commitAppend(std::size_t chars, std::size_t events)
+{
+    if (immediateFlush || useLockFile)
+    {
+        flushFile ();
+        return;
+    }
+
+    if (flushBytes == 0 && flushEvents == 0 && flushInterval.count () == 0)
+        return;
+
+    std::chrono::steady_clock::time_point now;
+    if (flushInterval.count () != 0)
+    {
+        now = std::chrono::steady_clock::now ();
+        if (unflushedEvents == 0)
+            firstUnflushed = now;
+    }
+
+    unflushedBytes += chars * sizeof (tchar);
+    unflushedEvents += events;
+
+    if ((flushBytes != 0 && unflushedBytes >= flushBytes)
+        || (flushEvents != 0 && unflushedEvents >= flushEvents)
+        || (flushInterval.count () != 0
+            && now - firstUnflushed >= flushInterval))
+    {
+        flushFile ();
+        unflushedBytes = 0;
+        unflushedEvents = 0;
+    }
 }
 
 void
@@ -348,9 +1225,11 @@ FileAppenderBase::open(std::ios_base::openmode mode)
     if (createDirs)
         internal::make_dirs (filename);
 
-    out.open(std::filesystem::path (filename), mode);
+    openFile (filename, mode);
+    unflushedBytes = 0;
+    unflushedEvents = 0;
 
-    if(!out.good()) {
+    if(!isFileGood()) {
         getErrorHandler()->error(LOG4CPLUS_TEXT("Unable to open file: ") + filename);
         return;
     }
@@ -373,10 +1252,7 @@ FileAppenderBase::reopen()
             || reopenDelay == 0)
         {
             // Close the current file
-            out.close();
-            // reset flags since the C++ standard specified that all
-            // the flags should remain unchanged on a close
-            out.clear();
+            closeFile ();
 
             // Re-open the file.
             open(std::ios_base::out | std::ios_base::ate | std::ios_base::app);
@@ -385,11 +1261,206 @@ FileAppenderBase::reopen()
             reopen_time = log4cplus::helpers::Time ();
 
             // Succeed if no errors are found.
-            if(out.good())
+            if(isFileGood())
                 return true;
         }
     }
-    return false;
+    return false;
+}
+
+
+void
+FileAppenderBase::openFile(const tstring& name, std::ios_base::openmode mode)
+{
+    if (fdFile)
+    {
+        bool const truncate = (mode & std::ios_base::trunc) != 0
+            || (mode & (std::ios_base::app | std::ios_base::ate)) == 0;
+        fdFile->open (name, truncate);
+    }
+    else
+        out.open(std::filesystem::path (name), mode);
+}
+
+
+void
+FileAppenderBase::closeFile()
+{
+    if (fdFile)
+        fdFile->close ();
+    else
+    {
+        out.close();
+        // Reset flags since the C++ standard specified that all the
+        // flags should remain unchanged on a close.
+        out.clear();
+    }
+}
+
+
+bool
+FileAppenderBase::isFileGood() const
+{
+    return fdFile ? fdFile->good () : out.good ();
+}
+
+
+void
+FileAppenderBase::writeFile(const tstring& str)
+{
+    if (fdFile)
+        fdFile->write (str);
+    else
+        out.write (str.data (), static_cast<std::streamsize>(str.size ()));
+}
+
+
+void
+FileAppenderBase::flushFile()
+{
+    if (fdFile)
+        fdFile->flush ();
+    else
+        out.flush ();
+}
+
+
+std::streamoff
+FileAppenderBase::getFileSize()
+{
+    if (fdFile)
+        return fdFile->size ();
+    else
+        return out.tellp ();
+}
+
+
+void
+FileAppenderBase::seekFileEnd()
+{
+    if (fdFile)
+        fdFile->refreshSize ();
+    else
+        out.seekp (0, std::ios_base::end);
+}
+
+
+bool
+FileAppenderBase::switchToNextFile(const tstring& staged)
+{
+    helpers::LogLog & loglog = helpers::getLogLog();
+    tstring const next = filename + LOG4CPLUS_TEXT(".next");
+
+    // Open the new file first so that we can keep on logging into the
+    // current one if it fails.
+    std::unique_ptr<FdFile> nextFdFile;
+    std::unique_ptr<tchar[]> nextBuffer;
+    tofstream nextOut;
+    bool good;
+    if (fdFile)
+    {
+        nextFdFile = std::make_unique<FdFile> (bufferSize, syncPolicy);
+        nextFdFile->open (next, true);
+        good = nextFdFile->good ();
+    }
+    else
+    {
+        if (bufferSize != 0)
+        {
+            nextBuffer.reset (new tchar[bufferSize]);
+            nextOut.rdbuf ()->pubsetbuf (nextBuffer.get (), bufferSize);
+        }
+        nextOut.imbue (out.getloc ());
+        nextOut.open (std::filesystem::path (next),
+            std::ios_base::out | std::ios_base::trunc);
+        good = nextOut.good ();
+    }
+
+    if (! good)
+    {
+        loglog_opening_result (loglog, false, next);
+        return false;
+    }
+
+    // Renaming files that are open fails on Windows, in that case we
+    // fall back to synchronous rollover.
+    long ret = file_rename (filename, staged);
+    loglog_renaming_result (loglog, filename, staged, ret);
+    if (ret == 0)
+    {
+        ret = file_rename (next, filename);
+        loglog_renaming_result (loglog, next, filename, ret);
+        if (ret != 0)
+            file_rename (staged, filename);
+    }
+
+    if (ret != 0)
+    {
+        if (nextFdFile)
+            nextFdFile->close ();
+        else
+            nextOut.close ();
+        file_remove (next);
+        return false;
+    }
+
+    // The current file still refers to the staged file so whatever is
+    // buffered ends up there.
+    closeFile ();
+    if (fdFile)
+        fdFile = std::move (nextFdFile);
+    else
+    {
+        out.swap (nextOut);
+        buffer.swap (nextBuffer);
+    }
+    unflushedBytes = 0;
+    unflushedEvents = 0;
+    return true;
+}
+
+
+bool
+FileAppenderBase::rolloverInBackground(
+    std::function<void (const tstring&)> job)
+{
+    tstring const staged = staging_filename (filename);
+    if (! switchToNextFile (staged))
+    {
+        if (compression == FileCompression::NONE)
+            return false;
+
+        // Compressed backups are made from the staged file in any case.
+        // Move the file after it is closed; this is the only way on
+        // Windows, where open files cannot be renamed.
+        helpers::LogLog & loglog = helpers::getLogLog();
+        closeFile ();
+        long const ret = file_rename (filename, staged);
+        loglog_renaming_result (loglog, filename, staged, ret);
+        if (ret != 0)
+        {
+            // Keep on logging into the current file.
+            open (std::ios_base::out | std::ios_base::ate
+                | std::ios_base::app);
+            loglog_opening_result (loglog, isFileGood (), filename);
+            return true;
+        }
+
+        open (std::ios_base::out | std::ios_base::trunc);
+        loglog_opening_result (loglog, isFileGood (), filename);
+    }
+
+    // Other processes shift the backups under the lock file, too, so
+    // the job cannot be left to the background worker.
+    if (useLockFile)
+        job (staged);
+    else
+        post_rollover_job (
+            [job = std::move (job), staged]
+            {
+                job (staged);
+            });
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -514,32 +1585,36 @@ RollingFileAppender::append(const spi::InternalLoggingEvent& event)
     // Seek to the end of log file so that tellp() below returns the
     // right size.
     if (useLockFile)
-        out.seekp (0, std::ios_base::end);
+        seekFileEnd ();
 
     // Rotate log file if needed before appending to it.
-    if (out.tellp() > maxFileSize)
+    if (getFileSize() > maxFileSize)
         rollover(true);
 
     FileAppender::append(event);
 
     // Rotate log file if needed after appending to it.
-    if (out.tellp() > maxFileSize)
+    if (getFileSize() > maxFileSize)
         rollover(true);
 }
 
 
+void
+RollingFileAppender::appendBatch(
+    std::span<const spi::InternalLoggingEvent> events)
+{
+    // Size has to be checked after each event to keep files within
+    // MaxFileSize, append them one by one.
+    Appender::appendBatch(events);
+}
+
+
 void
 RollingFileAppender::rollover(bool alreadyLocked)
 {
     helpers::LogLog & loglog = helpers::getLogLog();
     helpers::LockFileGuard guard;
 
-    // Close the current file
-    out.close();
-    // Reset flags since the C++ standard specified that all the flags
-    // should remain unchanged on a close.
-    out.clear();
-
     if (useLockFile)
     {
         if (! alreadyLocked)
@@ -563,15 +1638,34 @@ RollingFileAppender::rollover(bool alreadyLocked)
         {
             // The file has already been rolled by another
             // process. Just reopen with the new file.
+            closeFile ();
 
             // Open it up again.
             open (std::ios_base::out | std::ios_base::ate | std::ios_base::app);
-            loglog_opening_result (loglog, out, filename);
+            loglog_opening_result (loglog, isFileGood (), filename);
 
             return;
         }
     }
 
+    // Leave renaming of the backups and the compression to the
+    // background worker. The worker runs the jobs in order so the
+    // backups are shifted consistently.
+    if (asyncRollover && maxBackupIndex > 0
+        && rolloverInBackground (
+            [filename = filename, index = maxBackupIndex, comp = compression]
+            (tstring const & staged)
+            {
+                tstring const suffix = compression_suffix (comp);
+                rolloverFiles (filename, index, suffix);
+                move_rolled_file (staged,
+                    filename + LOG4CPLUS_TEXT (".1") + suffix, comp);
+            }))
+        return;
+
+    // Close the current file
+    closeFile ();
+
     // If maxBackups <= 0, then there is no file renaming to be done.
     if (maxBackupIndex > 0)
     {
@@ -603,7 +1697,7 @@ RollingFileAppender::rollover(bool alreadyLocked)
 
     // Open it up again in truncation mode
     open(std::ios::out | std::ios::trunc);
-    loglog_opening_result (loglog, out, filename);
+    loglog_opening_result (loglog, isFileGood (), filename);
 }
 
 
@@ -741,7 +1835,12 @@ void
 DailyRollingFileAppender::close()
 {
     if (rollOnClose)
+    {
+        // The flush timer and appending threads touch the file under
+        // access_mutex, too.
+        thread::MutexGuard guard (access_mutex);
         rollover();
+    }
     FileAppender::close();
 }
 
@@ -764,6 +1863,27 @@ DailyRollingFileAppender::append(const spi::InternalLoggingEvent& event)
 }
 
 
+void
+DailyRollingFileAppender::appendBatch(
+    std::span<const spi::InternalLoggingEvent> events)
+{
+    // Split the batch at events that trigger rollover.
+    while (! events.empty ())
+    {
+        if(events.front ().getTimestamp() >= nextRolloverTime) {
+            rollover(true);
+        }
+
+        auto const it = std::find_if (events.begin () + 1, events.end (),
+            [this] (spi::InternalLoggingEvent const & ev)
+            { return ev.getTimestamp () >= nextRolloverTime; });
+        auto const count = static_cast<std::size_t>(it - events.begin ());
+        FileAppender::appendBatch(events.first (count));
+        events = events.subspan (count);
+    }
+}
+
+
 
 void
 DailyRollingFileAppender::rollover(bool alreadyLocked)
@@ -782,56 +1902,72 @@ DailyRollingFileAppender::rollover(bool alreadyLocked)
         }
     }
 
-    // Close the current file
-    out.close();
-    // reset flags since the C++ standard specified that all the flags
-    // should remain unchanged on a close
-    out.clear();
-
-    // If we've already rolled over this time period, we'll make sure that we
-    // don't overwrite any of those previous files.
-    // E.g. if "log.2009-11-07.1" already exists we rename it
-    // to "log.2009-11-07.2", etc.
-    rolloverFiles(scheduledFilename, maxBackupIndex);
-
-    // Do not overwriet the newest file either, e.g. if "log.2009-11-07"
-    // already exists rename it to "log.2009-11-07.1"
-    tostringstream backup_target_oss;
-    backup_target_oss << scheduledFilename << LOG4CPLUS_TEXT(".") << 1;
-    tstring backupTarget = backup_target_oss.str();
-
     helpers::LogLog & loglog = helpers::getLogLog();
-    long ret;
+
+    // Leave renaming of the backups and the compression to the
+    // background worker.
+    if (! asyncRollover
+        || ! rolloverInBackground (
+            [scheduled = scheduledFilename, index = maxBackupIndex,
+                comp = compression]
+            (tstring const & staged)
+            {
+                tstring const suffix = compression_suffix (comp);
+                tstring const target = scheduled + suffix;
+                tstring const backup
+                    = scheduled + LOG4CPLUS_TEXT (".1") + suffix;
+                rolloverFiles (scheduled, index, suffix);
+                move_rolled_file (target, backup, FileCompression::NONE);
+                move_rolled_file (staged, target, comp);
+            }))
+    {
+        // Close the current file
+        closeFile ();
+
+        // If we've already rolled over this time period, we'll make sure
+        // that we don't overwrite any of those previous files.
+        // E.g. if "log.2009-11-07.1" already exists we rename it
+        // to "log.2009-11-07.2", etc.
+        rolloverFiles(scheduledFilename, maxBackupIndex);
+
+        // Do not overwriet the newest file either, e.g. if "log.2009-11-07"
+        // already exists rename it to "log.2009-11-07.1"
+        tostringstream backup_target_oss;
+        backup_target_oss << scheduledFilename << LOG4CPLUS_TEXT(".") << 1;
+        tstring backupTarget = backup_target_oss.str();
+
+        long ret;
 
 #if defined (_WIN32)
-    // Try to remove the target first. It seems it is not
-    // possible to rename over existing file, e.g. "log.2009-11-07.1".
-    ret = file_remove (backupTarget);
+        // Try to remove the target first. It seems it is not
+        // possible to rename over existing file, e.g. "log.2009-11-07.1".
+        ret = file_remove (backupTarget);
 #endif
 
-    // Rename e.g. "log.2009-11-07" to "log.2009-11-07.1".
-    ret = file_rename (scheduledFilename, backupTarget);
-    loglog_renaming_result (loglog, scheduledFilename, backupTarget, ret);
+        // Rename e.g. "log.2009-11-07" to "log.2009-11-07.1".
+        ret = file_rename (scheduledFilename, backupTarget);
+        loglog_renaming_result (loglog, scheduledFilename, backupTarget, ret);
 
 #if defined (_WIN32)
-    // Try to remove the target first. It seems it is not
-    // possible to rename over existing file, e.g. "log.2009-11-07".
-    ret = file_remove (scheduledFilename);
+        // Try to remove the target first. It seems it is not
+        // possible to rename over existing file, e.g. "log.2009-11-07".
+        ret = file_remove (scheduledFilename);
 #endif
 
-    // Rename filename to scheduledFilename,
-    // e.g. rename "log" to "log.2009-11-07".
-    loglog.debug(
-        LOG4CPLUS_TEXT("Renaming file ")
-        + filename
-        + LOG4CPLUS_TEXT(" to ")
-        + scheduledFilename);
-    ret = file_rename (filename, scheduledFilename);
-    loglog_renaming_result (loglog, filename, scheduledFilename, ret);
-
-    // Open a new file, e.g. "log".
-    open(std::ios::out | std::ios::trunc);
-    loglog_opening_result (loglog, out, filename);
+        // Rename filename to scheduledFilename,
+        // e.g. rename "log" to "log.2009-11-07".
+        loglog.debug(
+            LOG4CPLUS_TEXT("Renaming file ")
+            + filename
+            + LOG4CPLUS_TEXT(" to ")
+            + scheduledFilename);
+        ret = file_rename (filename, scheduledFilename);
+        loglog_renaming_result (loglog, filename, scheduledFilename, ret);
+
+        // Open a new file, e.g. "log".
+        open(std::ios::out | std::ios::trunc);
+        loglog_opening_result (loglog, isFileGood (), filename);
+    }
 
     // Calculate the next rollover time
     log4cplus::helpers::Time now = helpers::now ();
@@ -1347,6 +2483,27 @@ TimeBasedRollingFileAppender::append(const spi::InternalLoggingEvent& event)
     FileAppenderBase::append(event);
 }
 
+
+void
+TimeBasedRollingFileAppender::appendBatch(
+    std::span<const spi::InternalLoggingEvent> events)
+{
+    // Split the batch at events that trigger rollover.
+    while (! events.empty ())
+    {
+        if(events.front ().getTimestamp() >= nextRolloverTime) {
+            rollover(true);
+        }
+
+        auto const it = std::find_if (events.begin () + 1, events.end (),
+            [this] (spi::InternalLoggingEvent const & ev)
+            { return ev.getTimestamp () >= nextRolloverTime; });
+        auto const count = static_cast<std::size_t>(it - events.begin ());
+        FileAppenderBase::appendBatch(events.first (count));
+        events = events.subspan (count);
+    }
+}
+
 void
 TimeBasedRollingFileAppender::open(std::ios_base::openmode mode)
 {
@@ -1359,8 +2516,8 @@ TimeBasedRollingFileAppender::open(std::ios_base::openmode mode)
     if (createDirs)
         internal::make_dirs (currentFilename);
 
-    out.open(std::filesystem::path (currentFilename), mode);
-    if(!out.good())
+    openFile (currentFilename, mode);
+    if(!isFileGood())
     {
         getErrorHandler()->error(LOG4CPLUS_TEXT("Unable to open file: ") + currentFilename);
         return;
@@ -1372,7 +2529,12 @@ void
 TimeBasedRollingFileAppender::close()
 {
     if (rollOnClose)
+    {
+        // The flush timer and appending threads touch the file under
+        // access_mutex, too.
+        thread::MutexGuard guard (access_mutex);
         rollover();
+    }
     FileAppenderBase::close();
 }
 
@@ -1393,11 +2555,29 @@ TimeBasedRollingFileAppender::rollover(bool alreadyLocked)
         }
     }
 
+    Time now = helpers::now();
+
+    // Move the file to scheduledFilename, and compress it, in the
+    // background. When the names are the same and there is nothing to
+    // compress, there is nothing to do either.
+    tstring const target = scheduledFilename
+        + compression_suffix (compression);
+    if (asyncRollover && filename != target
+        && rolloverInBackground (
+            [target, comp = compression] (tstring const & staged)
+            {
+                move_rolled_file (staged, target, comp);
+            }))
+    {
+        scheduledFilename = helpers::getFormattedTime(filenamePattern, now,
+            false);
+        clean(now);
+        nextRolloverTime = calculateNextRolloverTime(now);
+        return;
+    }
+
     // Close the current file
-    out.close();
-    // reset flags since the C++ standard specified that all the flags
-    // should remain unchanged on a close
-    out.clear();
+    closeFile ();
 
     if (filename != scheduledFilename)
     {
@@ -1419,7 +2599,6 @@ TimeBasedRollingFileAppender::rollover(bool alreadyLocked)
         loglog_renaming_result (loglog, filename, scheduledFilename, ret);
     }
 
-    Time now = helpers::now();
     clean(now);
 
     open(std::ios::out | std::ios::trunc);
@@ -1439,16 +2618,34 @@ TimeBasedRollingFileAppender::clean(Time time)
     Time::duration period = getRolloverPeriodDuration();
     long periods = long(interval.count () / period.count ());
 
-    helpers::LogLog & loglog = helpers::getLogLog();
+    std::vector<tstring> filesToRemove;
     for (long i = 0; i < periods; i++)
     {
         long periodToRemove = (-maxHistory - 1) - i;
         Time timeToRemove = time + periodToRemove * period;
         tstring filenameToRemove = helpers::getFormattedTime(filenamePattern, timeToRemove, false);
-        loglog.debug(LOG4CPLUS_TEXT("Removing file ") + filenameToRemove);
-        file_remove(filenameToRemove);
+        if (compression != FileCompression::NONE)
+            filesToRemove.push_back (
+                filenameToRemove + compression_suffix (compression));
+        filesToRemove.push_back (std::move (filenameToRemove));
     }
 
+    auto removeFiles = [files = std::move (filesToRemove)]
+    {
+        helpers::LogLog & loglog = helpers::getLogLog();
+        for (tstring const & file : files)
+        {
+            loglog.debug(LOG4CPLUS_TEXT("Removing file ") + file);
+            file_remove(file);
+        }
+    };
+
+    // Removing files is left to the background worker as well.
+    if (asyncRollover)
+        post_rollover_job (std::move (removeFiles));
+    else
+        removeFiles ();
+
     lastHeartBeat = time;
 }
 
@@ -1506,6 +2703,616 @@ CATCH_TEST_CASE ("TimeBasedRollingFileAppender", "[appender]")
     }
 
 }
+
+
+CATCH_TEST_CASE ("FileAppender batch", "[appender]")
+{
+    tstring const file_name (LOG4CPLUS_TEXT ("fileappender_batch_test.log"));
+    spi::InternalLoggingEvent const events[] = {
+        {LOG4CPLUS_TEXT ("test"), DEBUG_LOG_LEVEL, LOG4CPLUS_TEXT ("a"),
+            __FILE__, __LINE__},
+        {LOG4CPLUS_TEXT ("test"), INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("b"),
+            __FILE__, __LINE__},
+        {LOG4CPLUS_TEXT ("test"), WARN_LOG_LEVEL, LOG4CPLUS_TEXT ("c"),
+            __FILE__, __LINE__}};
+
+    {
+        SharedAppenderPtr appender (new FileAppender (file_name));
+        appender->setLayout (std::unique_ptr<Layout> (
+            new PatternLayout (LOG4CPLUS_TEXT ("%p %m%n"))));
+        appender->setThreshold (INFO_LOG_LEVEL);
+        appender->syncDoAppendBatch (events);
+        appender->syncDoAppendBatch (
+            std::span<spi::InternalLoggingEvent const> (events).first (1));
+        appender->close ();
+    }
+
+    tifstream file {std::filesystem::path (file_name)};
+    tostringstream contents;
+    contents << file.rdbuf ();
+    file.close ();
+    file_remove (file_name);
+
+    CATCH_REQUIRE (contents.str () == LOG4CPLUS_TEXT ("INFO b\nWARN c\n"));
+}
+
+
+namespace
+{
+
+//! Messages of events appended in the tests below are 10 characters
+//! long with "%m%n" layout.
+std::size_t const event_chars = 10;
+
+//! Number of events after which rolling file appenders created with
+//! make_rolling_props() roll over.
+std::size_t const events_per_file = 200 * 1024 / event_chars + 1;
+
+
+//! \return Event rendered as <code>event_chars</code> characters by
+//! appenders created with make_test_appender().
+spi::InternalLoggingEvent
+make_test_event ()
+{
+    return spi::InternalLoggingEvent (LOG4CPLUS_TEXT ("test"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("123456789"), __FILE__, __LINE__);
+}
+
+
+//! \return Appender of type <code>T</code> configured with
+//! <code>props</code> and with "%m%n" layout.
+template <typename T>
+SharedAppenderPtr
+make_test_appender (helpers::Properties const & props)
+{
+    SharedAppenderPtr appender (new T (props));
+    appender->setLayout (std::unique_ptr<Layout> (
+        new PatternLayout (LOG4CPLUS_TEXT ("%m%n"))));
+    return appender;
+}
+
+
+//! \return Properties of RollingFileAppender writing into
+//! <code>file_name</code> that rolls over after
+//! <code>events_per_file</code> events and keeps
+//! <code>max_backup_index</code> backups.
+helpers::Properties
+make_rolling_props (tstring const & file_name, int max_backup_index)
+{
+    helpers::Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("File"), file_name);
+    props.setProperty (LOG4CPLUS_TEXT ("MaxFileSize"),
+        LOG4CPLUS_TEXT ("200KB"));
+    props.setProperty (LOG4CPLUS_TEXT ("MaxBackupIndex"),
+        helpers::convertIntegerToString (max_backup_index));
+    props.setProperty (LOG4CPLUS_TEXT ("ImmediateFlush"),
+        LOG4CPLUS_TEXT ("false"));
+    return props;
+}
+
+
+//! \return Name of backup number <code>i</code> of
+//! <code>file_name</code>.
+tstring
+make_backup_name (tstring const & file_name, int i,
+    tstring const & suffix = tstring ())
+{
+    return file_name + LOG4CPLUS_TEXT (".")
+        + helpers::convertIntegerToString (i) + suffix;
+}
+
+
+//! \return Number of files in current directory whose names start with
+//! <code>prefix</code>.
+std::size_t
+count_files_with_prefix (tstring const & prefix)
+{
+    std::string const narrow_prefix (LOG4CPLUS_TSTRING_TO_STRING (prefix));
+    std::size_t files = 0;
+    for (auto const & entry : std::filesystem::directory_iterator (
+            std::filesystem::current_path ()))
+        if (entry.path ().filename ().string ().starts_with (narrow_prefix))
+            ++files;
+    return files;
+}
+
+} // namespace
+
+
+CATCH_TEST_CASE ("FileAppender group commit", "[appender]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("fileappender_group_commit_test.log"));
+    std::filesystem::path const path (file_name);
+    spi::InternalLoggingEvent const event (make_test_event ());
+    std::size_t const event_size = event_chars * sizeof (tchar);
+
+    auto make_appender = [&] (tchar const * key, tstring const & value) {
+        helpers::Properties props;
+        props.setProperty (LOG4CPLUS_TEXT ("File"), file_name);
+        props.setProperty (key, value);
+        return make_test_appender<FileAppender> (props);
+    };
+
+    CATCH_SECTION ("events")
+    {
+        SharedAppenderPtr appender = make_appender (
+            LOG4CPLUS_TEXT ("FlushEvents"), LOG4CPLUS_TEXT ("3"));
+        appender->doAppend (event);
+        appender->doAppend (event);
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 0);
+        appender->doAppend (event);
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 3 * event_size);
+        appender->close ();
+    }
+
+    CATCH_SECTION ("bytes")
+    {
+        SharedAppenderPtr appender = make_appender (
+            LOG4CPLUS_TEXT ("FlushBytes"),
+            helpers::convertIntegerToString (25 * sizeof (tchar)));
+        appender->doAppend (event);
+        appender->doAppend (event);
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 0);
+        appender->doAppend (event);
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 3 * event_size);
+        appender->close ();
+    }
+
+    CATCH_SECTION ("interval")
+    {
+        SharedAppenderPtr appender = make_appender (
+            LOG4CPLUS_TEXT ("FlushInterval"), LOG4CPLUS_TEXT ("20"));
+        appender->doAppend (event);
+
+        // Background timer flushes the idle appender.
+        auto const deadline = std::chrono::steady_clock::now ()
+            + std::chrono::seconds (5);
+        while (std::filesystem::file_size (path) == 0
+            && std::chrono::steady_clock::now () < deadline)
+            std::this_thread::sleep_for (std::chrono::milliseconds (5));
+        CATCH_REQUIRE (std::filesystem::file_size (path) == event_size);
+        appender->close ();
+    }
+
+    file_remove (file_name);
+}
+
+#if defined (LOG4CPLUS_WITH_ZLIB)
+CATCH_TEST_CASE ("RollingFileAppender compression", "[appender]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("fileappender_compression_test.log"));
+    spi::InternalLoggingEvent const event (make_test_event ());
+
+    auto backup_name = [&] (int i) {
+        return make_backup_name (file_name, i, LOG4CPLUS_TEXT (".gz"));
+    };
+
+    auto gunzip_size = [] (tstring const & name) {
+        gzFile gz = gzopen (LOG4CPLUS_TSTRING_TO_STRING (name).c_str (), "rb");
+        CATCH_REQUIRE (gz);
+        std::size_t size = 0;
+        char buf[4096];
+        int ret;
+        while ((ret = gzread (gz, buf, sizeof (buf))) > 0)
+            size += static_cast<std::size_t>(ret);
+        gzclose (gz);
+        return size;
+    };
+
+    tstring const lock_name (
+        LOG4CPLUS_TEXT ("fileappender_compression_test.lock"));
+
+    auto test = [&] (bool use_lock_file) {
+        {
+            helpers::Properties props (make_rolling_props (file_name, 2));
+            props.setProperty (LOG4CPLUS_TEXT ("Compression"),
+                LOG4CPLUS_TEXT ("gzip"));
+            if (use_lock_file)
+            {
+                props.setProperty (LOG4CPLUS_TEXT ("UseLockFile"),
+                    LOG4CPLUS_TEXT ("true"));
+                props.setProperty (LOG4CPLUS_TEXT ("LockFile"), lock_name);
+            }
+            SharedAppenderPtr appender
+                = make_test_appender<RollingFileAppender> (props);
+
+            // Three rollovers with two backups kept.
+            for (std::size_t i = 0; i != 3 * events_per_file + 5; ++i)
+                appender->doAppend (event);
+            appender->close ();
+        }
+
+        shutdownRolloverWorker ();
+
+        CATCH_REQUIRE (gunzip_size (backup_name (1))
+            == events_per_file * event_chars);
+        CATCH_REQUIRE (gunzip_size (backup_name (2))
+            == events_per_file * event_chars);
+        CATCH_REQUIRE (! std::filesystem::exists (
+            std::filesystem::path (backup_name (3))));
+        CATCH_REQUIRE (std::filesystem::file_size (
+            std::filesystem::path (file_name))
+            == 5 * event_chars * sizeof (tchar));
+
+        // No uncompressed, staged or partially compressed files are left
+        // behind.
+        return count_files_with_prefix (file_name);
+    };
+
+    auto cleanup = [&] {
+        file_remove (file_name);
+        file_remove (backup_name (1));
+        file_remove (backup_name (2));
+        file_remove (lock_name);
+    };
+
+    CATCH_SECTION ("next file opened first")
+    {
+        CATCH_REQUIRE (test (false) == 3);
+        cleanup ();
+    }
+
+    CATCH_SECTION ("next file cannot be opened")
+    {
+        // The current file is closed before it is moved then, as it
+        // is on Windows.
+        std::filesystem::path const next (file_name + LOG4CPLUS_TEXT (".next"));
+        std::filesystem::create_directory (next);
+        std::size_t const files = test (false);
+        std::filesystem::remove (next);
+        CATCH_REQUIRE (files == 4);
+        cleanup ();
+    }
+
+    CATCH_SECTION ("lock file")
+    {
+        CATCH_REQUIRE (test (true) == 3);
+        cleanup ();
+    }
+}
+#endif
+
+
+CATCH_TEST_CASE ("RollingFileAppender async rollover", "[appender]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("fileappender_async_rollover_test.log"));
+    spi::InternalLoggingEvent const event (make_test_event ());
+
+    auto backup_name = [&] (int i) {
+        return make_backup_name (file_name, i);
+    };
+
+    auto file_size = [] (tstring const & name) {
+        return static_cast<std::size_t>(std::filesystem::file_size (
+            std::filesystem::path (name)));
+    };
+
+    auto test = [&] (tchar const * engine) {
+        {
+            helpers::Properties props (make_rolling_props (file_name, 2));
+            props.setProperty (LOG4CPLUS_TEXT ("BufferSize"),
+                LOG4CPLUS_TEXT ("4096"));
+            props.setProperty (LOG4CPLUS_TEXT ("FileEngine"), engine);
+            props.setProperty (LOG4CPLUS_TEXT ("AsyncRollover"),
+                LOG4CPLUS_TEXT ("true"));
+            SharedAppenderPtr appender
+                = make_test_appender<RollingFileAppender> (props);
+
+            // Three rollovers with two backups kept.
+            for (std::size_t i = 0; i != 3 * events_per_file + 5; ++i)
+                appender->doAppend (event);
+            appender->close ();
+        }
+
+        shutdownRolloverWorker ();
+
+        // The fd engine writes UTF-8.
+        std::size_t const event_size = event_chars
+            * (tstring (engine) == LOG4CPLUS_TEXT ("fd") ? 1 : sizeof (tchar));
+        CATCH_REQUIRE (file_size (backup_name (1))
+            == events_per_file * event_size);
+        CATCH_REQUIRE (file_size (backup_name (2))
+            == events_per_file * event_size);
+        CATCH_REQUIRE (file_size (file_name) == 5 * event_size);
+        CATCH_REQUIRE (! std::filesystem::exists (
+            std::filesystem::path (backup_name (3))));
+
+        // No staged or pre-opened files are left behind.
+        CATCH_REQUIRE (count_files_with_prefix (file_name) == 3);
+
+        file_remove (file_name);
+        file_remove (backup_name (1));
+        file_remove (backup_name (2));
+    };
+
+    CATCH_SECTION ("stream")
+    {
+        test (LOG4CPLUS_TEXT ("stream"));
+    }
+
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+    CATCH_SECTION ("fd")
+    {
+        test (LOG4CPLUS_TEXT ("fd"));
+    }
+#endif
+}
+
+
+#if defined (LOG4CPLUS_USE_FD_FILE_ENGINE)
+CATCH_TEST_CASE ("FileAppender fd engine", "[appender]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("fileappender_fd_engine_test.log"));
+    tstring const backup_name (make_backup_name (file_name, 1));
+    std::filesystem::path const path (file_name);
+    // The fd engine writes UTF-8, events are event_chars bytes long also
+    // in UNICODE builds.
+    spi::InternalLoggingEvent const event (make_test_event ());
+
+    CATCH_SECTION ("flush")
+    {
+        helpers::Properties props;
+        props.setProperty (LOG4CPLUS_TEXT ("File"), file_name);
+        props.setProperty (LOG4CPLUS_TEXT ("FileEngine"),
+            LOG4CPLUS_TEXT ("fd"));
+        props.setProperty (LOG4CPLUS_TEXT ("FlushEvents"),
+            LOG4CPLUS_TEXT ("3"));
+        SharedAppenderPtr appender = make_test_appender<FileAppender> (props);
+        appender->doAppend (event);
+        appender->doAppend (event);
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 0);
+        appender->doAppend (event);
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 3 * event_chars);
+        appender->doAppend (event);
+        appender->close ();
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 4 * event_chars);
+    }
+
+    CATCH_SECTION ("rollover")
+    {
+        helpers::Properties props (make_rolling_props (file_name, 1));
+        props.setProperty (LOG4CPLUS_TEXT ("FileEngine"),
+            LOG4CPLUS_TEXT ("fd"));
+        props.setProperty (LOG4CPLUS_TEXT ("SyncPolicy"),
+            LOG4CPLUS_TEXT ("close"));
+        SharedAppenderPtr appender
+            = make_test_appender<RollingFileAppender> (props);
+
+        // The file is rolled over once the event that crosses
+        // the limit has been appended.
+        for (std::size_t i = 0; i != events_per_file + 5; ++i)
+            appender->doAppend (event);
+        appender->close ();
+
+        CATCH_REQUIRE (std::filesystem::file_size (backup_name)
+            == events_per_file * event_chars);
+        CATCH_REQUIRE (std::filesystem::file_size (path) == 5 * event_chars);
+        file_remove (backup_name);
+    }
+
+    file_remove (file_name);
+}
+#endif
+
+
+namespace
+{
+
+class CountingFileAppender
+    : public FileAppender
+{
+public:
+    using FileAppender::FileAppender;
+
+    std::size_t appended = 0;
+    bool batchWrite = false;
+
+protected:
+    void
+    append (spi::InternalLoggingEvent const & event) override
+    {
+        ++appended;
+        FileAppender::append (event);
+    }
+
+    bool
+    supportsBatchWrite () const override
+    {
+        return batchWrite;
+    }
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("FileAppender batch with append override", "[appender]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("fileappender_batch_override_test.log"));
+    spi::InternalLoggingEvent const events[] = {
+        {LOG4CPLUS_TEXT ("test"), DEBUG_LOG_LEVEL, LOG4CPLUS_TEXT ("a"),
+            __FILE__, __LINE__},
+        {LOG4CPLUS_TEXT ("test"), INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("b"),
+            __FILE__, __LINE__},
+        {LOG4CPLUS_TEXT ("test"), WARN_LOG_LEVEL, LOG4CPLUS_TEXT ("c"),
+            __FILE__, __LINE__}};
+
+    helpers::SharedObjectPtr<CountingFileAppender> appender (
+        new CountingFileAppender (file_name));
+    appender->setLayout (std::unique_ptr<Layout> (
+        new PatternLayout (LOG4CPLUS_TEXT ("%p %m%n"))));
+    appender->setThreshold (INFO_LOG_LEVEL);
+
+    CATCH_SECTION ("events go through append()")
+    {
+        appender->syncDoAppendBatch (events);
+        CATCH_REQUIRE (appender->appended == 2);
+    }
+
+    CATCH_SECTION ("batch write bypasses append()")
+    {
+        appender->batchWrite = true;
+        appender->syncDoAppendBatch (events);
+        CATCH_REQUIRE (appender->appended == 0);
+    }
+
+    appender->close ();
+
+    tifstream file {std::filesystem::path (file_name)};
+    tstring line;
+    CATCH_REQUIRE (std::getline (file, line));
+    CATCH_REQUIRE (line == LOG4CPLUS_TEXT ("INFO b"));
+    CATCH_REQUIRE (std::getline (file, line));
+    CATCH_REQUIRE (line == LOG4CPLUS_TEXT ("WARN c"));
+    CATCH_REQUIRE (! std::getline (file, line));
+    file.close ();
+    file_remove (file_name);
+}
+
+
+namespace
+{
+
+class CountingLayout
+    : public PatternLayout
+{
+public:
+    CountingLayout ()
+        : PatternLayout (LOG4CPLUS_TEXT ("%m%n"))
+    { }
+
+    void
+    formatInto (tstring & buffer, spi::InternalLoggingEvent const & event)
+        override
+    {
+        ++count;
+        PatternLayout::formatInto (buffer, event);
+    }
+
+    std::atomic<std::size_t> count {0};
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("FileAppender FormatOutsideLock", "[appender]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("fileappender_format_outside_lock_test.log"));
+    unsigned const threads_count = 4;
+    unsigned const per_thread = 500;
+    CountingLayout * layout = new CountingLayout;
+
+    {
+        helpers::Properties props;
+        props.setProperty (LOG4CPLUS_TEXT ("File"), file_name);
+        props.setProperty (LOG4CPLUS_TEXT ("Threshold"),
+            LOG4CPLUS_TEXT ("INFO"));
+        props.setProperty (LOG4CPLUS_TEXT ("FormatOutsideLock"),
+            LOG4CPLUS_TEXT ("true"));
+        SharedAppenderPtr appender (new FileAppender (props));
+        appender->setLayout (std::unique_ptr<Layout> (layout));
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t != threads_count; ++t)
+            threads.emplace_back ([&appender, t] {
+                tstring const msg = LOG4CPLUS_TEXT ("thread ")
+                    + helpers::convertIntegerToString (t);
+                for (unsigned i = 0; i != per_thread; ++i)
+                {
+                    appender->doAppend (spi::InternalLoggingEvent (
+                        LOG4CPLUS_TEXT ("test"), INFO_LOG_LEVEL, msg,
+                        __FILE__, __LINE__));
+                    appender->doAppend (spi::InternalLoggingEvent (
+                        LOG4CPLUS_TEXT ("test"), DEBUG_LOG_LEVEL, msg,
+                        __FILE__, __LINE__));
+                }
+            });
+        for (auto & thread : threads)
+            thread.join ();
+
+        // Each accepted event is formatted exactly once and the
+        // filtered out events are not formatted at all.
+        CATCH_REQUIRE (layout->count == threads_count * per_thread);
+        appender->close ();
+    }
+
+    tifstream file {std::filesystem::path (file_name)};
+    tstring line;
+    std::size_t lines = 0;
+    while (std::getline (file, line))
+    {
+        CATCH_REQUIRE (line.size () == 8);
+        CATCH_REQUIRE (line.compare (0, 7, LOG4CPLUS_TEXT ("thread ")) == 0);
+        ++lines;
+    }
+    file.close ();
+    file_remove (file_name);
+
+    CATCH_REQUIRE (lines == threads_count * per_thread);
+}
+
+
+CATCH_TEST_CASE ("FileAppender FormatOutsideLock with setLayout()",
+    "[appender]")
+{
+    tstring const file_name (
+        LOG4CPLUS_TEXT ("fileappender_format_outside_lock_layout_test.log"));
+    unsigned const threads_count = 2;
+    unsigned const per_thread = 500;
+
+    {
+        helpers::Properties props;
+        props.setProperty (LOG4CPLUS_TEXT ("File"), file_name);
+        props.setProperty (LOG4CPLUS_TEXT ("FormatOutsideLock"),
+            LOG4CPLUS_TEXT ("true"));
+        SharedAppenderPtr appender (new FileAppender (props));
+        appender->setLayout (std::unique_ptr<Layout> (
+            new PatternLayout (LOG4CPLUS_TEXT ("%m%n"))));
+
+        std::atomic<bool> done {false};
+        std::thread setter ([&appender, &done] {
+            // Layout changes while events are formatted and appended
+            // must neither deadlock nor use a destroyed layout.
+            while (! done.load ())
+                appender->setLayout (std::unique_ptr<Layout> (
+                    new PatternLayout (LOG4CPLUS_TEXT ("%m%n"))));
+        });
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t != threads_count; ++t)
+            threads.emplace_back ([&appender, t] {
+                tstring const msg = LOG4CPLUS_TEXT ("thread ")
+                    + helpers::convertIntegerToString (t);
+                for (unsigned i = 0; i != per_thread; ++i)
+                    appender->doAppend (spi::InternalLoggingEvent (
+                        LOG4CPLUS_TEXT ("test"), INFO_LOG_LEVEL, msg,
+                        __FILE__, __LINE__));
+            });
+        for (auto & thread : threads)
+            thread.join ();
+        done = true;
+        setter.join ();
+        appender->close ();
+    }
+
+    tifstream file {std::filesystem::path (file_name)};
+    tstring line;
+    std::size_t lines = 0;
+    while (std::getline (file, line))
+    {
+        CATCH_REQUIRE (line.compare (0, 7, LOG4CPLUS_TEXT ("thread ")) == 0);
+        ++lines;
+    }
+    file.close ();
+    file_remove (file_name);
+
+    CATCH_REQUIRE (lines == threads_count * per_thread);
+}
 #endif
 
 
@@ -32,7 +32,6 @@
 #include <log4cplus/logger.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/mdc.h>
-#include <log4cplus/helpers/eventcounter.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/internal/customloglevelmanager.h>
 #include <log4cplus/internal/internal.h>
@@ -108,6 +107,9 @@ Initializer::Initializer ()
 // Forward declaration. Defined in this file.
 void shutdownThreadPool();
 
+// Forward declaration. Defined in fileappender.cxx.
+void shutdownRolloverWorker();
+
 Initializer::~Initializer ()
 {
     bool destroy = false;
@@ -188,6 +190,7 @@ struct DefaultContext
     Hierarchy hierarchy;
     ThreadPoolHolder thread_pool;
     std::atomic<bool> block_on_full {true};
+    std::atomic<std::size_t> queue_size_limit {0};
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
     progschj::ThreadPool *
@@ -367,45 +370,31 @@ getMDC ()
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED) \
     && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
-void
-enqueueAsyncDoAppend (SharedAppenderPtr const & appender,
-    spi::InternalLoggingEvent const & event)
-{
-    static helpers::SteadyClockGate gate (helpers::SteadyClockGate::Duration {std::chrono::minutes (5)});
-
-    DefaultContext * dc = get_dc ();
-    progschj::ThreadPool * tp = dc->get_thread_pool (true);
-    auto func = [=] () {
-        appender->asyncDoAppend (event);
-    };
-    if (dc->block_on_full)
-        tp->enqueue_block (std::move (func));
-    else
-    {
-        std::future<void> future = tp->enqueue (std::move (func));
-        if (future.wait_for (std::chrono::seconds (0)) == std::future_status::ready)
-        {
-            try
-            {
-                future.get ();
-            }
-            catch (const progschj::would_block &)
-            {
-                gate.record_event ();
-                helpers::SteadyClockGate::Info info;
-                if (gate.latch_open (info))
-                {
-                    helpers::LogLog & loglog = helpers::getLogLog ();
-                    log4cplus::tostringstream oss;
-                    oss << LOG4CPLUS_TEXT ("Asynchronous logging queue is full. Dropped ")
-                        << info.count << LOG4CPLUS_TEXT (" events in last ")
-                        << std::chrono::duration_cast<std::chrono::seconds> (info.time_span).count ()
-                        << LOG4CPLUS_TEXT (" seconds");
-                    loglog.warn (oss.str ());
-                }
-            }
-        }
-    }
+bool
+enqueueAsyncDrain (SharedAppenderPtr const & appender)
+{
+    progschj::ThreadPool * tp = get_dc ()->get_thread_pool (true);
+    if (! tp)
+        return false;
+
+    // There is at most one drain task per appender in the pool queue,
+    // the events themselves wait in the appender's own queue.
+    tp->enqueue_block ([appender] { appender->drainAsyncQueue (); });
+    return true;
+}
+
+
+std::size_t
+getAsyncQueueSizeLimit ()
+{
+    return get_dc ()->queue_size_limit.load (std::memory_order_relaxed);
+}
+
+
+bool
+getThreadPoolBlockOnFull ()
+{
+    return get_dc ()->block_on_full.load (std::memory_order_relaxed);
 }
 
 #endif
@@ -478,9 +467,7 @@ namespace internal
 
 
 gft_scratch_pad::gft_scratch_pad ()
-    : uc_q_str_valid (false)
-    , q_str_valid (false)
-    , s_str_valid (false)
+    : cache_victim (0)
 { }
 
 
@@ -638,6 +625,7 @@ deinitialize ()
 {
     Logger::shutdown ();
     shutdownThreadPool();
+    shutdownRolloverWorker();
 }
 
 
@@ -699,9 +687,10 @@ void
 setThreadPoolQueueSizeLimit (std::size_t LOG4CPLUS_THREADED (queue_size_limit))
 {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    auto const thread_pool = get_dc ()->get_thread_pool (true);
-    if (thread_pool)
-        thread_pool->set_queue_size_limit (queue_size_limit);
+    // The limit applies to each asynchronous appender's queue. The
+    // thread pool queue only holds one drain task per appender.
+    get_dc ()->queue_size_limit.store (queue_size_limit,
+        std::memory_order_relaxed);
 
 #endif
 }
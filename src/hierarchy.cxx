@@ -26,6 +26,14 @@
 #include <utility>
 #include <limits>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/helpers/stringhelper.h>
+#include <catch_amalgamated.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#endif
+
 
 namespace log4cplus
 {
@@ -67,10 +75,12 @@ const LogLevel Hierarchy::DISABLE_OVERRIDE = -2;
 
 Hierarchy::Hierarchy()
   : defaultFactory(new DefaultLoggerFactory())
+  , loggerCache(new LoggerCacheShard[LOGGER_CACHE_SHARDS])
   , root(nullptr)
   // Don't disable any LogLevel level by default.
   , disableValue(DISABLE_OFF)
   , emittedNoAppenderWarning(false)
+  , logLevelGeneration(0)
 {
     root = Logger( new spi::RootLogger(*this, DEBUG_LOG_LEVEL) );
 }
@@ -92,8 +102,17 @@ Hierarchy::clear()
 {
     thread::MutexGuard guard (hashtable_mutex);
 
+    // Loggers that are dropped recompute their chained LogLevel once
+    // more but they are not invalidated any longer.
+    invalidateLogLevelCaches();
+
     provisionNodes.erase(provisionNodes.begin(), provisionNodes.end());
     loggerPtrs.erase(loggerPtrs.begin(), loggerPtrs.end());
+    for (std::size_t i = 0; i != LOGGER_CACHE_SHARDS; ++i)
+    {
+        std::unique_lock shard_guard (loggerCache[i].mutex);
+        loggerCache[i].loggers.clear();
+    }
 }
 
 
@@ -104,10 +123,10 @@ Hierarchy::exists(const tstring_view& name)
     if (name.empty ())
         return true;
 
-    thread::MutexGuard guard (hashtable_mutex);
+    LoggerCacheShard & shard = getLoggerCacheShard(name);
+    std::shared_lock shard_guard (shard.mutex);
 
-    auto it = loggerPtrs.find(name);
-    return it != loggerPtrs.end();
+    return shard.loggers.find(name) != shard.loggers.end();
 }
 
 
@@ -167,6 +186,16 @@ Hierarchy::getInstance(const tstring_view& name)
 Logger
 Hierarchy::getInstance(const tstring_view& name, spi::LoggerFactory& factory)
 {
+    // Fast path for existing loggers. It takes only shared lock of one
+    // shard of the loggers cache.
+    if (! name.empty ())
+    {
+        LoggerCacheShard & shard = getLoggerCacheShard(name);
+        std::shared_lock shard_guard (shard.mutex);
+        if (auto it = shard.loggers.find(name); it != shard.loggers.end())
+            return it->second;
+    }
+
     thread::MutexGuard guard (hashtable_mutex);
 
     return getInstanceImpl(name, factory);
@@ -216,6 +245,7 @@ Hierarchy::resetConfiguration()
         logger.setAdditivity(true);
     }
 
+    invalidateLogLevelCaches();
 }
 
 
@@ -303,12 +333,26 @@ Hierarchy::getInstanceImpl(const tstring_view& name,
             provisionNodes.erase(pnm_it);
         }
         updateParents(logger);
+        invalidateLogLevelCaches();
+
+        // Publish the logger for the fast path only after it has been
+        // linked into the hierarchy.
+        LoggerCacheShard & shard = getLoggerCacheShard(name);
+        std::unique_lock shard_guard (shard.mutex);
+        shard.loggers.emplace(name, logger);
     }
 
     return logger;
 }
 
 
+Hierarchy::LoggerCacheShard &
+Hierarchy::getLoggerCacheShard(const tstring_view& name) const
+{
+    return loggerCache[helpers::tstring_hash{}(name) % LOGGER_CACHE_SHARDS];
+}
+
+
 void
 Hierarchy::initializeLoggerList(LoggerList& list) const
 {
@@ -380,4 +424,87 @@ Hierarchy::updateChildren(ProvisionNode& pn, Logger const & logger)
 }
 
 
+void
+Hierarchy::invalidateLogLevelCaches()
+{
+    thread::MutexGuard guard (hashtable_mutex);
+
+    ++logLevelGeneration;
+    // Root logger sets its LogLevel before it is assigned to root.
+    if (root.value)
+        root.value->invalidateLogLevelCache(logLevelGeneration);
+    for (auto & kv : loggerPtrs)
+        kv.second.value->invalidateLogLevelCache(logLevelGeneration);
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Hierarchy loggers cache", "[hierarchy]")
+{
+    Hierarchy h;
+
+    CATCH_SECTION ("existing logger is returned")
+    {
+        CATCH_REQUIRE (! h.exists (LOG4CPLUS_TEXT ("a.b")));
+        Logger const logger = h.getInstance (LOG4CPLUS_TEXT ("a.b"));
+        CATCH_REQUIRE (h.exists (LOG4CPLUS_TEXT ("a.b")));
+        // Loggers sharing implementation share also name string.
+        CATCH_REQUIRE (&h.getInstance (LOG4CPLUS_TEXT ("a.b")).getName ()
+            == &logger.getName ());
+        CATCH_REQUIRE (&logger.getParent ().getName ()
+            == &h.getRoot ().getName ());
+    }
+
+    CATCH_SECTION ("clear() removes cached loggers")
+    {
+        Logger const logger = h.getInstance (LOG4CPLUS_TEXT ("a.b"));
+        h.clear ();
+        CATCH_REQUIRE (! h.exists (LOG4CPLUS_TEXT ("a.b")));
+        CATCH_REQUIRE (&h.getInstance (LOG4CPLUS_TEXT ("a.b")).getName ()
+            != &logger.getName ());
+    }
+}
+
+
+CATCH_TEST_CASE ("Hierarchy::getInstance() benchmark",
+    "[.][hierarchy][benchmark]")
+{
+    Hierarchy h;
+    std::vector<tstring> names;
+    for (int i = 0; i != 256; ++i)
+    {
+        names.push_back (LOG4CPLUS_TEXT ("tenant.")
+            + helpers::convertIntegerToString (i)
+            + LOG4CPLUS_TEXT (".module"));
+        h.getInstance (names.back ());
+    }
+
+    constexpr std::size_t lookups = 200000;
+    unsigned const max_threads
+        = (std::max) (std::thread::hardware_concurrency (), 1u);
+    // The second round looks up single hot name from all threads.
+    for (std::size_t const spread : {names.size (), std::size_t (1)})
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+        {
+            auto const start = std::chrono::steady_clock::now ();
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t != threads; ++t)
+                workers.emplace_back ([&h, &names, spread, t] {
+                    for (std::size_t i = 0; i != lookups; ++i)
+                        h.getInstance (names[(i + t * 7) % spread]);
+                });
+            for (auto & worker : workers)
+                worker.join ();
+            auto const ns
+                = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now () - start).count ();
+
+            CATCH_WARN (spread << " names, " << threads << " threads: "
+                << (static_cast<double>(lookups) * threads * 1e9 / ns)
+                << " lookups/s");
+        }
+}
+#endif
+
+
 } // namespace log4cplus
@@ -45,7 +45,7 @@ HierarchyLocker::HierarchyLocker(Hierarchy& _h)
     try
     {
         for (it = loggerList.begin(); it != loggerList.end(); ++it)
-            it->value->appender_list_mutex.lock ();
+            it->value->lockAppenderList ();
     }
     catch (...)
     {
@@ -54,7 +54,7 @@ HierarchyLocker::HierarchyLocker(Hierarchy& _h)
             LOG4CPLUS_TEXT("- An error occurred while locking"));
         auto range_end = it;
         for (it = loggerList.begin (); it != range_end; ++it)
-            it->value->appender_list_mutex.unlock ();
+            it->value->unlockAppenderList ();
         throw;
     }
 }
@@ -64,7 +64,7 @@ HierarchyLocker::~HierarchyLocker() LOG4CPLUS_NOEXCEPT_FALSE
 {
     try {
         for (auto & logger : loggerList)
-            logger.value->appender_list_mutex.unlock ();
+            logger.value->unlockAppenderList ();
     }
     catch(...) {
         helpers::getLogLog().error(LOG4CPLUS_TEXT("HierarchyLocker::dtor()- An error occurred while unlocking"));
@@ -117,9 +117,9 @@ HierarchyLocker::addAppender(Logger& logger, SharedAppenderPtr& appender)
     {
         if (l.value == logger.value)
         {
-            logger.value->appender_list_mutex.unlock ();
+            logger.value->unlockAppenderList ();
             logger.addAppender(appender);
-            logger.value->appender_list_mutex.lock ();
+            logger.value->lockAppenderList ();
             return;
         }
     }
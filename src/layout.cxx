@@ -60,6 +60,17 @@ Layout::Layout (const log4cplus::helpers::Properties&)
 Layout::~Layout() = default;
 
 
+void
+Layout::formatInto (log4cplus::tstring & buffer,
+    const log4cplus::spi::InternalLoggingEvent& event)
+{
+    tostringstream & oss = internal::get_ptd ()->layout_oss;
+    detail::clear_tostringstream (oss);
+    formatAndAppend (oss, event);
+    buffer.append (oss.view ());
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::SimpleLayout public methods
 ///////////////////////////////////////////////////////////////////////////////
@@ -86,6 +97,17 @@ SimpleLayout::formatAndAppend(log4cplus::tostream& output,
 }
 
 
+void
+SimpleLayout::formatInto(log4cplus::tstring& buffer,
+                         const log4cplus::spi::InternalLoggingEvent& event)
+{
+    buffer += llmCache.toString(event.getLogLevel());
+    buffer += LOG4CPLUS_TEXT(" - ");
+    buffer += event.getMessage();
+    buffer += LOG4CPLUS_TEXT('\n');
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::TTCCLayout ctors and dtor
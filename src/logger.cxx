@@ -223,6 +223,13 @@ Logger::removeAppender (const log4cplus::tstring& name)
 }
 
 
+void
+Logger::replaceAllAppenders (const SharedAppenderPtrList& newAppenders)
+{
+    value->replaceAllAppenders (newAppenders);
+}
+
+
 void
 Logger::assertion (bool assertionVal, const log4cplus::tstring_view& msg) const
 {
@@ -23,6 +23,7 @@
 #include <log4cplus/appender.h>
 #include <log4cplus/hierarchy.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/spi/rootlogger.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
@@ -34,11 +35,12 @@ namespace log4cplus::spi {
 // Logger Constructors and Destructor
 //////////////////////////////////////////////////////////////////////////////
 LoggerImpl::LoggerImpl(const log4cplus::tstring_view& name_, Hierarchy& h)
-  : name(name_),
+  : name(helpers::makeStringHandle(name_)),
     ll(NOT_SET_LOG_LEVEL),
     parent(nullptr),
     additive(true),
-    hierarchy(h)
+    hierarchy(h),
+    cachedChainedLogLevel(0)
 {
 }
 
@@ -93,7 +95,47 @@ LoggerImpl::isEnabledFor(LogLevel loglevel) const
     if(hierarchy.disableValue >= loglevel) {
         return false;
     }
-    return loglevel >= getChainedLogLevel();
+    return loglevel >= getCachedChainedLogLevel();
+}
+
+
+namespace
+{
+
+//! Set in LoggerImpl::cachedChainedLogLevel when it holds valid LogLevel.
+std::uint64_t const CACHED_LOG_LEVEL_VALID = std::uint64_t (1) << 32;
+
+} // namespace
+
+
+LogLevel
+LoggerImpl::getCachedChainedLogLevel() const
+{
+    std::uint64_t cached
+        = cachedChainedLogLevel.load(std::memory_order_relaxed);
+    if (cached & CACHED_LOG_LEVEL_VALID) [[likely]] {
+        return static_cast<LogLevel>(static_cast<std::int32_t>(
+            cached & 0xFFFFFFFFu));
+    }
+
+    // Pairs with the release store in invalidateLogLevelCache() so that
+    // the logger chain is walked with the changes that invalidated the
+    // cache. The exchange fails and the next call recomputes the level
+    // again if the cache has been invalidated meanwhile.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    LogLevel const chained = getChainedLogLevel();
+    cachedChainedLogLevel.compare_exchange_strong(cached,
+        cached | CACHED_LOG_LEVEL_VALID | static_cast<std::uint32_t>(chained),
+        std::memory_order_relaxed, std::memory_order_relaxed);
+    return chained;
+}
+
+
+void
+LoggerImpl::invalidateLogLevelCache(std::uint32_t generation)
+{
+    cachedChainedLogLevel.store(std::uint64_t (generation) << 33,
+        std::memory_order_release);
 }
 
 
@@ -134,6 +176,14 @@ LoggerImpl::getChainedLogLevel() const
 }
 
 
+void
+LoggerImpl::setLogLevel(LogLevel _ll)
+{
+    ll = _ll;
+    hierarchy.invalidateLogLevelCaches();
+}
+
+
 Hierarchy&
 LoggerImpl::getHierarchy() const
 {
@@ -164,8 +214,8 @@ LoggerImpl::forcedLog(LogLevel loglevel,
 {
     spi::InternalLoggingEvent & ev = internal::get_ptd ()->forced_log_ev;
     assert (function);
-    ev.setLoggingEvent (this->getName(), loglevel, message, file, line,
-        function);
+    ev.setLoggingEvent (this->getNameHandle(), loglevel, message, file,
+        line, function);
     callAppenders(ev);
 }
 
@@ -19,8 +19,16 @@
 // limitations under the License.
 
 #include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/internal/internal.h>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#endif
 
 
 namespace log4cplus::spi {
@@ -38,7 +46,7 @@ InternalLoggingEvent::InternalLoggingEvent(
     LogLevel loglevel, const log4cplus::tstring_view& message_,
     const char* filename, int line_, const char * function_)
     : message(message_)
-    , loggerName(logger)
+    , loggerName(helpers::makeStringHandle(logger))
     , ll(loglevel)
     , timestamp(log4cplus::helpers::now ())
     , file(filename
@@ -52,6 +60,8 @@ InternalLoggingEvent::InternalLoggingEvent(
     , thread2Cached(false)
     , ndcCached(false)
     , mdcCached(false)
+    , packedRecord(nullptr)
+    , packedFields(0)
 {
 }
 
@@ -67,12 +77,12 @@ InternalLoggingEvent::InternalLoggingEvent(
     const log4cplus::tstring_view& file_, int line_,
     const log4cplus::tstring_view& function_)
     : message(message_)
-    , loggerName(logger)
+    , loggerName(helpers::makeStringHandle(logger))
     , ll(loglevel)
     , ndc(ndc_)
     , mdc(mdc_)
-    , thread(thread_)
-    , thread2(thread2_)
+    , thread(helpers::makeStringHandle(thread_))
+    , thread2(helpers::makeStringHandle(thread2_))
     , timestamp(time)
     , file(file_)
     , function (function_.data ()
@@ -83,29 +93,36 @@ InternalLoggingEvent::InternalLoggingEvent(
     , thread2Cached(true)
     , ndcCached(true)
     , mdcCached(true)
+    , packedRecord(nullptr)
+    , packedFields(0)
 {
 }
 
 
 InternalLoggingEvent::InternalLoggingEvent ()
-    : ll (NOT_SET_LOG_LEVEL)
+    : loggerName (helpers::getEmptyStringHandle ())
+    , ll (NOT_SET_LOG_LEVEL)
+    , thread (helpers::getEmptyStringHandle ())
+    , thread2 (helpers::getEmptyStringHandle ())
     , line (0)
     , threadCached(false)
     , thread2Cached(false)
     , ndcCached(false)
     , mdcCached(false)
+    , packedRecord(nullptr)
+    , packedFields(0)
 { }
 
 
 InternalLoggingEvent::InternalLoggingEvent(
     const log4cplus::spi::InternalLoggingEvent& rhs)
     : message(rhs.getMessage())
-    , loggerName(rhs.getLoggerName())
+    , loggerName((rhs.getLoggerName(), rhs.loggerName))
     , ll(rhs.getLogLevel())
     , ndc(rhs.getNDC())
     , mdc(rhs.getMDCCopy())
-    , thread(rhs.getThread())
-    , thread2(rhs.getThread2())
+    , thread((rhs.getThread(), rhs.thread))
+    , thread2((rhs.getThread2(), rhs.thread2))
     , timestamp(rhs.getTimestamp())
     , file(rhs.getFile())
     , function(rhs.getFunction())
@@ -114,6 +131,32 @@ InternalLoggingEvent::InternalLoggingEvent(
     , thread2Cached(true)
     , ndcCached(true)
     , mdcCached(true)
+    , packedRecord(nullptr)
+    , packedFields(0)
+{
+}
+
+
+InternalLoggingEvent::InternalLoggingEvent(
+    log4cplus::spi::InternalLoggingEvent&& rhs) noexcept
+    : message(std::move(rhs.message))
+    // Handles are copied so that rhs stays usable.
+    , loggerName(rhs.loggerName)
+    , ll(rhs.ll)
+    , ndc(std::move(rhs.ndc))
+    , mdc(std::move(rhs.mdc))
+    , thread(rhs.thread)
+    , thread2(rhs.thread2)
+    , timestamp(rhs.timestamp)
+    , file(std::move(rhs.file))
+    , function(std::move(rhs.function))
+    , line(rhs.line)
+    , threadCached(rhs.threadCached)
+    , thread2Cached(rhs.thread2Cached)
+    , ndcCached(rhs.ndcCached)
+    , mdcCached(rhs.mdcCached)
+    , packedRecord(rhs.packedRecord)
+    , packedFields(rhs.packedFields)
 {
 }
 
@@ -150,7 +193,26 @@ InternalLoggingEvent::setLoggingEvent (const log4cplus::tstring_view & logger,
     // But that defeats the optimization of using thread local instance
     // of InternalLoggingEvent to avoid memory allocation.
 
+    helpers::assignStringHandle (loggerName, logger);
+    setLoggingEventData (loglevel, msg, filename, fline, function_);
+}
+
+
+void
+InternalLoggingEvent::setLoggingEvent (tstring_handle const & logger,
+    LogLevel loglevel, const log4cplus::tstring_view & msg,
+    const char * filename, int fline, const char * function_)
+{
     loggerName = logger;
+    setLoggingEventData (loglevel, msg, filename, fline, function_);
+}
+
+
+void
+InternalLoggingEvent::setLoggingEventData (LogLevel loglevel,
+    const log4cplus::tstring_view & msg, const char * filename, int fline,
+    const char * function_)
+{
     ll = loglevel;
     message = msg;
     timestamp = helpers::now ();
@@ -170,6 +232,8 @@ InternalLoggingEvent::setLoggingEvent (const log4cplus::tstring_view & logger,
     thread2Cached = false;
     ndcCached = false;
     mdcCached = false;
+    packedRecord = nullptr;
+    packedFields = 0;
 }
 
 
@@ -180,6 +244,7 @@ InternalLoggingEvent::setFunction (char const * func)
         function = LOG4CPLUS_C_STR_TO_TSTRING (func);
     else
         function.clear ();
+    packedFields &= ~PFFunction;
 }
 
 
@@ -190,12 +255,15 @@ InternalLoggingEvent::setFunction (log4cplus::tstring_view const & func)
         function = func;
     else
         function.clear ();
+    packedFields &= ~PFFunction;
 }
 
 
 const log4cplus::tstring&
 InternalLoggingEvent::getMessage() const
 {
+    if (packedFields & PFMessage)
+        unpackFields (PFMessage);
     return message;
 }
 
@@ -236,6 +304,14 @@ InternalLoggingEvent::operator = (const InternalLoggingEvent& rhs)
 }
 
 
+InternalLoggingEvent &
+InternalLoggingEvent::operator = (InternalLoggingEvent&& rhs) noexcept
+{
+    swap (rhs);
+    return *this;
+}
+
+
 void
 InternalLoggingEvent::gatherThreadSpecificData () const
 {
@@ -265,7 +341,254 @@ InternalLoggingEvent::swap (InternalLoggingEvent & other)
     swap (threadCached, other.threadCached);
     swap (thread2Cached, other.thread2Cached);
     swap (ndcCached, other.ndcCached);
+    swap (mdcCached, other.mdcCached);
+    swap (packedRecord, other.packedRecord);
+    swap (packedFields, other.packedFields);
+}
+
+
+namespace
+{
+
+//! Fixed size header of record produced by InternalLoggingEvent::pack().
+//! It is followed by lengths of MDC keys and values, then by characters
+//! of all strings and then by padding to alignment of the header.
+struct PackedEventHeader
+{
+    enum Field
+    {
+        MESSAGE, LOGGER, NDC, THREAD, THREAD2, FILE, FUNCTION,
+        FIELD_COUNT
+    };
+
+    //! Size of the whole record including padding.
+    std::uint32_t size;
+    std::int32_t ll;
+    std::int32_t line;
+    std::uint32_t mdc_count;
+    std::int64_t timestamp;
+    //! End offsets of fields' characters, in characters.
+    std::uint32_t ends[FIELD_COUNT];
+};
+
+
+static_assert (sizeof (PackedEventHeader) % sizeof (tchar) == 0);
+
+
+static
+void
+pack_string (char * & chars, tstring const & str)
+{
+    std::size_t const bytes = str.size () * sizeof (tchar);
+    std::memcpy (chars, str.data (), bytes);
+    chars += bytes;
+}
+
+
+} // namespace
+
+
+void
+InternalLoggingEvent::pack (std::vector<char> & buffer) const
+{
+    gatherThreadSpecificData ();
+    unpackFields (PFAll);
+
+    tstring const * const fields[PackedEventHeader::FIELD_COUNT] = {
+        &message, loggerName.get (), &ndc, thread.get (), thread2.get (),
+        &file, &function };
+
+    PackedEventHeader hdr;
+    hdr.ll = ll;
+    hdr.line = line;
+    hdr.mdc_count = static_cast<std::uint32_t>(mdc.size ());
+    hdr.timestamp = static_cast<std::int64_t>(
+        timestamp.time_since_epoch ().count ());
+
+    std::size_t chars = 0;
+    for (std::size_t i = 0; i != PackedEventHeader::FIELD_COUNT; ++i)
+    {
+        chars += fields[i]->size ();
+        hdr.ends[i] = static_cast<std::uint32_t>(chars);
+    }
+    for (auto const & kv : mdc)
+        chars += kv.first.size () + kv.second.size ();
+
+    std::size_t const lens_size
+        = 2 * mdc.size () * sizeof (std::uint32_t);
+    std::size_t const align = alignof (PackedEventHeader);
+    std::size_t const size = (sizeof (hdr) + lens_size
+        + chars * sizeof (tchar) + align - 1) / align * align;
+    hdr.size = static_cast<std::uint32_t>(size);
+
+    std::size_t const start = buffer.size ();
+    buffer.resize (start + size);
+    char * p = buffer.data () + start;
+    std::memcpy (p, &hdr, sizeof (hdr));
+    p += sizeof (hdr);
+
+    char * str_p = p + lens_size;
+    for (tstring const * field : fields)
+        pack_string (str_p, *field);
+
+    for (auto const & kv : mdc)
+    {
+        std::uint32_t const lens[2] = {
+            static_cast<std::uint32_t>(kv.first.size ()),
+            static_cast<std::uint32_t>(kv.second.size ()) };
+        std::memcpy (p, lens, sizeof (lens));
+        p += sizeof (lens);
+        pack_string (str_p, kv.first);
+        pack_string (str_p, kv.second);
+    }
+}
+
+
+char const *
+InternalLoggingEvent::unpack (char const * record)
+{
+    PackedEventHeader hdr;
+    std::memcpy (&hdr, record, sizeof (hdr));
+
+    ll = hdr.ll;
+    line = hdr.line;
+    timestamp = helpers::Time (helpers::Time::duration (hdr.timestamp));
+    threadCached = true;
+    thread2Cached = true;
+    ndcCached = true;
+    mdcCached = true;
+    packedRecord = record;
+    packedFields = PFAll;
+
+    return record + hdr.size;
+}
+
+
+void
+InternalLoggingEvent::unpackFields (unsigned fields) const
+{
+    fields &= packedFields;
+    if (! fields)
+        return;
+
+    PackedEventHeader hdr;
+    std::memcpy (&hdr, packedRecord, sizeof (hdr));
+    char const * p = packedRecord + sizeof (hdr);
+    tchar const * const chars = reinterpret_cast<tchar const *>(
+        p + 2 * hdr.mdc_count * sizeof (std::uint32_t));
+
+    auto field = [&hdr, chars] (PackedEventHeader::Field f) {
+        std::uint32_t const begin = f == 0 ? 0 : hdr.ends[f - 1];
+        return tstring_view (chars + begin, hdr.ends[f] - begin);
+    };
+
+    if (fields & PFMessage)
+        message.assign (field (PackedEventHeader::MESSAGE));
+    if (fields & PFLogger)
+        helpers::assignStringHandle (loggerName,
+            field (PackedEventHeader::LOGGER));
+    if (fields & PFNdc)
+        ndc.assign (field (PackedEventHeader::NDC));
+    if (fields & PFThread)
+        helpers::assignStringHandle (thread,
+            field (PackedEventHeader::THREAD));
+    if (fields & PFThread2)
+        helpers::assignStringHandle (thread2,
+            field (PackedEventHeader::THREAD2));
+    if (fields & PFFile)
+        file.assign (field (PackedEventHeader::FILE));
+    if (fields & PFFunction)
+        function.assign (field (PackedEventHeader::FUNCTION));
+
+    if (fields & PFMdc)
+    {
+        mdc.clear ();
+        tchar const * kv = chars
+            + hdr.ends[PackedEventHeader::FIELD_COUNT - 1];
+        for (std::uint32_t i = 0; i != hdr.mdc_count; ++i)
+        {
+            std::uint32_t lens[2];
+            std::memcpy (lens, p, sizeof (lens));
+            p += sizeof (lens);
+            tstring_view const key (kv, lens[0]);
+            tstring_view const value (kv + lens[0], lens[1]);
+            kv += lens[0] + lens[1];
+            mdc.emplace (key, value);
+        }
+    }
+
+    packedFields &= ~fields;
+    if (! packedFields)
+        packedRecord = nullptr;
+}
+
+
+std::size_t
+InternalLoggingEvent::packedSize (char const * record)
+{
+    std::uint32_t size;
+    std::memcpy (&size, record + offsetof (PackedEventHeader, size),
+        sizeof (size));
+    return size;
+}
+
+
+LogLevel
+InternalLoggingEvent::packedLogLevel (char const * record)
+{
+    std::int32_t ll;
+    std::memcpy (&ll, record + offsetof (PackedEventHeader, ll), sizeof (ll));
+    return ll;
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Shared event names", "[loggingevent]")
+{
+    InternalLoggingEvent ev (LOG4CPLUS_TEXT ("logger"), INFO_LOG_LEVEL,
+        LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+
+    CATCH_SECTION ("thread names are shared with per thread data")
+    {
+        CATCH_REQUIRE (&ev.getThread () == &thread::getCurrentThreadName ());
+        CATCH_REQUIRE (&ev.getThread2 ()
+            == &thread::getCurrentThreadName2 ());
+    }
+
+    CATCH_SECTION ("copies share names")
+    {
+        InternalLoggingEvent const copy (ev);
+        CATCH_REQUIRE (&copy.getLoggerName () == &ev.getLoggerName ());
+        CATCH_REQUIRE (&copy.getThread () == &ev.getThread ());
+    }
+
+    CATCH_SECTION ("logger name handle is shared")
+    {
+        tstring_handle const name = helpers::makeStringHandle (
+            LOG4CPLUS_TEXT ("shared"));
+        ev.setLoggingEvent (name, INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("m"),
+            __FILE__, __LINE__);
+        CATCH_REQUIRE (&ev.getLoggerName () == name.get ());
+    }
+
+    CATCH_SECTION ("equal logger name is kept")
+    {
+        tstring const * const name = &ev.getLoggerName ();
+        ev.setLoggingEvent (LOG4CPLUS_TEXT ("logger"), INFO_LOG_LEVEL,
+            LOG4CPLUS_TEXT ("m"), __FILE__, __LINE__);
+        CATCH_REQUIRE (&ev.getLoggerName () == name);
+    }
+
+    CATCH_SECTION ("shared logger name is not modified")
+    {
+        InternalLoggingEvent const copy (ev);
+        ev.setLoggingEvent (LOG4CPLUS_TEXT ("other"), INFO_LOG_LEVEL,
+            LOG4CPLUS_TEXT ("m"), __FILE__, __LINE__);
+        CATCH_REQUIRE (copy.getLoggerName () == LOG4CPLUS_TEXT ("logger"));
+        CATCH_REQUIRE (ev.getLoggerName () == LOG4CPLUS_TEXT ("other"));
+    }
 }
+#endif
 
 
 } // namespace log4cplus::spi
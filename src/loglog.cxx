@@ -28,6 +28,10 @@
 #include <ostream>
 #include <stdexcept>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#endif
+
 
 namespace log4cplus::helpers {
 
@@ -38,6 +42,17 @@ static tchar const PREFIX[] = LOG4CPLUS_TEXT("log4cplus: ");
 static tchar const WARN_PREFIX[] = LOG4CPLUS_TEXT("log4cplus:WARN ");
 static tchar const ERR_PREFIX[] = LOG4CPLUS_TEXT("log4cplus:ERROR ");
 
+
+static
+bool
+get_bool_from_env (tchar const * envvar_name)
+{
+    tstring envvar_value;
+    bool value = false;
+    return internal::get_env_var (envvar_value, envvar_name)
+        && internal::parse_bool (value, envvar_value) && value;
+}
+
 } // namespace
 
 
@@ -49,8 +64,11 @@ LogLog::getLogLog()
 
 
 LogLog::LogLog()
-    : debugEnabled(TriUndef)
-    , quietMode(TriUndef)
+    : flags(
+        (get_bool_from_env (LOG4CPLUS_TEXT ("LOG4CPLUS_LOGLOG_DEBUGENABLED"))
+            ? fDebugEnabled : 0u)
+        | (get_bool_from_env (LOG4CPLUS_TEXT ("LOG4CPLUS_LOGLOG_QUIETMODE"))
+            ? fQuietMode : 0u))
 { }
 
 
@@ -60,53 +78,59 @@ LogLog::~LogLog() = default;
 void
 LogLog::setInternalDebugging(bool enabled)
 {
-    thread::MutexGuard guard (mutex);
-
-    debugEnabled = enabled ? TriTrue : TriFalse;
+    if (enabled)
+        flags.fetch_or (fDebugEnabled, std::memory_order_relaxed);
+    else
+        flags.fetch_and (~static_cast<unsigned>(fDebugEnabled),
+            std::memory_order_relaxed);
 }
 
 
 void
 LogLog::setQuietMode(bool quietModeVal)
 {
-    thread::MutexGuard guard (mutex);
-
-    quietMode = quietModeVal ? TriTrue : TriFalse;
+    if (quietModeVal)
+        flags.fetch_or (fQuietMode, std::memory_order_relaxed);
+    else
+        flags.fetch_and (~static_cast<unsigned>(fQuietMode),
+            std::memory_order_relaxed);
 }
 
 
 void
 LogLog::debug(const log4cplus::tstring& msg) const
 {
-    logging_worker (tcout, &LogLog::get_debug_mode, PREFIX, msg);
+    if (isDebugEnabled ()) [[unlikely]]
+        logging_worker (tcout, true, PREFIX, msg);
 }
 
 
 void
 LogLog::debug(tchar const * msg) const
 {
-    logging_worker (tcout, &LogLog::get_debug_mode, PREFIX, msg);
+    if (isDebugEnabled ()) [[unlikely]]
+        logging_worker (tcout, true, PREFIX, msg);
 }
 
 
 void
 LogLog::warn(const log4cplus::tstring& msg) const
 {
-    logging_worker (tcerr, &LogLog::get_not_quiet_mode, WARN_PREFIX, msg);
+    logging_worker (tcerr, ! get_quiet_mode (), WARN_PREFIX, msg);
 }
 
 
 void
 LogLog::warn(tchar const * msg) const
 {
-    logging_worker (tcerr, &LogLog::get_not_quiet_mode, WARN_PREFIX, msg);
+    logging_worker (tcerr, ! get_quiet_mode (), WARN_PREFIX, msg);
 }
 
 
 void
 LogLog::error(const log4cplus::tstring& msg, bool throw_flag) const
 {
-    logging_worker (tcerr, &LogLog::get_not_quiet_mode, ERR_PREFIX, msg,
+    logging_worker (tcerr, ! get_quiet_mode (), ERR_PREFIX, msg,
         throw_flag);
 }
 
@@ -114,7 +138,7 @@ LogLog::error(const log4cplus::tstring& msg, bool throw_flag) const
 void
 LogLog::error(tchar const * msg, bool throw_flag) const
 {
-    logging_worker (tcerr, &LogLog::get_not_quiet_mode, ERR_PREFIX, msg,
+    logging_worker (tcerr, ! get_quiet_mode (), ERR_PREFIX, msg,
         throw_flag);
 }
 
@@ -122,56 +146,15 @@ LogLog::error(tchar const * msg, bool throw_flag) const
 bool
 LogLog::get_quiet_mode () const
 {
-    if (quietMode == TriUndef) [[unlikely]]
-        set_tristate_from_env (&quietMode,
-            LOG4CPLUS_TEXT ("LOG4CPLUS_LOGLOG_QUIETMODE"));
-
-    return quietMode == TriTrue;
-}
-
-
-bool
-LogLog::get_not_quiet_mode () const
-{
-    return ! get_quiet_mode ();
-}
-
-
-bool
-LogLog::get_debug_mode () const
-{
-    if (debugEnabled == TriUndef) [[unlikely]]
-        set_tristate_from_env (&debugEnabled,
-            LOG4CPLUS_TEXT ("LOG4CPLUS_LOGLOG_DEBUGENABLED"));
-
-    return debugEnabled && ! get_quiet_mode ();
-}
-
-
-void
-LogLog::set_tristate_from_env (TriState * result, tchar const * envvar_name)
-{
-    tstring envvar_value;
-    bool exists = internal::get_env_var (envvar_value, envvar_name);
-    bool value = false;
-    if (exists && internal::parse_bool (value, envvar_value) && value)
-        *result = TriTrue;
-    else
-        *result = TriFalse;
+    return (flags.load (std::memory_order_relaxed) & fQuietMode) != 0;
 }
 
 
 template <typename StringType>
 void
-LogLog::logging_worker (tostream & os, bool (LogLog:: * cond) () const,
+LogLog::logging_worker (tostream & os, bool output,
     tchar const * prefix, StringType const & msg, bool throw_flag) const
 {
-    bool output;
-    {
-        thread::MutexGuard guard (mutex);
-        output = (this->*cond) ();
-    }
-
     if (output) [[unlikely]]
     {
         // XXX This is potential recursive lock of
@@ -185,4 +168,25 @@ LogLog::logging_worker (tostream & os, bool (LogLog:: * cond) () const,
 }
 
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("LogLog flags", "[loglog]")
+{
+    LogLog loglog;
+    loglog.setQuietMode (false);
+
+    loglog.setInternalDebugging (true);
+    CATCH_REQUIRE (loglog.isDebugEnabled ());
+
+    loglog.setQuietMode (true);
+    CATCH_REQUIRE (! loglog.isDebugEnabled ());
+
+    loglog.setQuietMode (false);
+    CATCH_REQUIRE (loglog.isDebugEnabled ());
+
+    loglog.setInternalDebugging (false);
+    CATCH_REQUIRE (! loglog.isDebugEnabled ());
+}
+#endif
+
+
 } // namespace log4cplus::helpers
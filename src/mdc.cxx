@@ -21,6 +21,10 @@
 //  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
 //  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <stdexcept>
 #include <utility>
 #include <memory>
 #include <type_traits>
@@ -28,13 +32,293 @@
 #include <log4cplus/internal/internal.h>
 
 #if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/helpers/stringhelper.h>
 #include <catch_amalgamated.hpp>
+#include <chrono>
 #endif
 
 
 namespace log4cplus
 {
 
+//
+// MappedDiagnosticContextMap
+//
+
+//! Reference counted storage of MappedDiagnosticContextMap. Entries
+//! follow the header in the same allocation.
+struct alignas (MappedDiagnosticContextMap::value_type)
+    MappedDiagnosticContextMap::Rep
+{
+    std::atomic<std::size_t> refs {1};
+    size_type size = 0;
+    size_type capacity;
+
+    explicit Rep (size_type cap)
+        : capacity (cap)
+    { }
+
+    value_type *
+    data () noexcept
+    {
+        return reinterpret_cast<value_type *>(this + 1);
+    }
+
+    static
+    Rep *
+    allocate (size_type capacity)
+    {
+        void * mem = ::operator new (
+            sizeof (Rep) + capacity * sizeof (value_type));
+        return new (mem) Rep (capacity);
+    }
+
+    static
+    void
+    release (Rep * rep) noexcept
+    {
+        if (! rep || rep->refs.fetch_sub (1, std::memory_order_acq_rel) != 1)
+            return;
+
+        std::destroy_n (rep->data (), rep->size);
+        rep->~Rep ();
+        ::operator delete (rep);
+    }
+
+    //! Creates unshared storage of given capacity with copies of
+    //! entries of <code>src</code>, or moved entries when
+    //! <code>src</code> is not shared.
+    static
+    Rep *
+    clone (Rep * src, size_type capacity)
+    {
+        Rep * rep = allocate (capacity);
+        if (src->refs.load (std::memory_order_acquire) == 1)
+            std::uninitialized_move_n (src->data (), src->size, rep->data ());
+        else
+        {
+            try
+            {
+                std::uninitialized_copy_n (src->data (), src->size,
+                    rep->data ());
+            }
+            catch (...)
+            {
+                rep->~Rep ();
+                ::operator delete (rep);
+                throw;
+            }
+        }
+        rep->size = src->size;
+        return rep;
+    }
+
+    static constexpr size_type initial_capacity = 8;
+};
+
+
+MappedDiagnosticContextMap::MappedDiagnosticContextMap (
+    MappedDiagnosticContextMap const & other) noexcept
+    : rep (other.rep)
+{
+    if (rep)
+        rep->refs.fetch_add (1, std::memory_order_relaxed);
+}
+
+
+MappedDiagnosticContextMap::~MappedDiagnosticContextMap ()
+{
+    Rep::release (rep);
+}
+
+
+MappedDiagnosticContextMap &
+MappedDiagnosticContextMap::operator = (
+    MappedDiagnosticContextMap const & other) noexcept
+{
+    MappedDiagnosticContextMap (other).swap (*this);
+    return *this;
+}
+
+
+MappedDiagnosticContextMap &
+MappedDiagnosticContextMap::operator = (
+    MappedDiagnosticContextMap && other) noexcept
+{
+    MappedDiagnosticContextMap (std::move (other)).swap (*this);
+    return *this;
+}
+
+
+MappedDiagnosticContextMap::size_type
+MappedDiagnosticContextMap::size () const noexcept
+{
+    return rep ? rep->size : 0;
+}
+
+
+MappedDiagnosticContextMap::const_iterator
+MappedDiagnosticContextMap::begin () const noexcept
+{
+    return rep ? rep->data () : nullptr;
+}
+
+
+MappedDiagnosticContextMap::size_type
+MappedDiagnosticContextMap::lowerBound (tstring_view const & key) const
+{
+    const_iterator const first = begin ();
+    return static_cast<size_type>(std::lower_bound (first, first + size (),
+        key, [](value_type const & kv, tstring_view const & k) {
+            return tstring_view (kv.first) < k; }) - first);
+}
+
+
+MappedDiagnosticContextMap::const_iterator
+MappedDiagnosticContextMap::find (tstring_view const & key) const
+{
+    size_type const pos = lowerBound (key);
+    if (pos != size () && begin ()[pos].first == key)
+        return begin () + pos;
+    else
+        return end ();
+}
+
+
+MappedDiagnosticContextMap::mapped_type const &
+MappedDiagnosticContextMap::at (tstring_view const & key) const
+{
+    const_iterator const it = find (key);
+    if (it == end ())
+        throw std::out_of_range ("MappedDiagnosticContextMap::at");
+
+    return it->second;
+}
+
+
+MappedDiagnosticContextMap::mapped_type &
+MappedDiagnosticContextMap::at (tstring_view const & key)
+{
+    size_type const pos = lowerBound (key);
+    if (pos == size () || begin ()[pos].first != key)
+        throw std::out_of_range ("MappedDiagnosticContextMap::at");
+
+    detach ();
+    return rep->data ()[pos].second;
+}
+
+
+MappedDiagnosticContextMap::mapped_type &
+MappedDiagnosticContextMap::operator [] (tstring_view const & key)
+{
+    size_type const pos = lowerBound (key);
+    if (pos != size () && begin ()[pos].first == key)
+    {
+        detach ();
+        return rep->data ()[pos].second;
+    }
+
+    return insertAt (pos, tstring (key), tstring ())->second;
+}
+
+
+MappedDiagnosticContextMap::value_type *
+MappedDiagnosticContextMap::insertAt (size_type pos, tstring && key,
+    tstring && value)
+{
+    size_type const count = size ();
+    if (! rep)
+        rep = Rep::allocate (Rep::initial_capacity);
+    else if (count == rep->capacity
+        || rep->refs.load (std::memory_order_acquire) != 1)
+    {
+        Rep * const new_rep = Rep::clone (rep, count == rep->capacity
+            ? 2 * rep->capacity : rep->capacity);
+        Rep::release (rep);
+        rep = new_rep;
+    }
+
+    // Moves of strings do not throw.
+    value_type * const data = rep->data ();
+    if (pos == count)
+        new (data + count) value_type (std::move (key), std::move (value));
+    else
+    {
+        new (data + count) value_type (std::move (data[count - 1]));
+        std::move_backward (data + pos, data + count - 1, data + count);
+        data[pos].first = std::move (key);
+        data[pos].second = std::move (value);
+    }
+    ++rep->size;
+
+    return data + pos;
+}
+
+
+MappedDiagnosticContextMap::size_type
+MappedDiagnosticContextMap::erase (tstring_view const & key)
+{
+    size_type const pos = lowerBound (key);
+    if (pos == size () || rep->data ()[pos].first != key)
+        return 0;
+
+    detach ();
+    value_type * const data = rep->data ();
+    std::move (data + pos + 1, data + rep->size, data + pos);
+    std::destroy_at (data + rep->size - 1);
+    --rep->size;
+    return 1;
+}
+
+
+void
+MappedDiagnosticContextMap::clear () noexcept
+{
+    if (! rep)
+        return;
+    else if (rep->refs.load (std::memory_order_acquire) != 1)
+    {
+        Rep::release (rep);
+        rep = nullptr;
+    }
+    else
+    {
+        // Keep the allocation for the next entries.
+        std::destroy_n (rep->data (), rep->size);
+        rep->size = 0;
+    }
+}
+
+
+bool
+MappedDiagnosticContextMap::shared () const noexcept
+{
+    return rep && rep->refs.load (std::memory_order_acquire) != 1;
+}
+
+
+bool
+MappedDiagnosticContextMap::operator == (
+    MappedDiagnosticContextMap const & other) const
+{
+    return rep == other.rep
+        || std::equal (begin (), end (), other.begin (), other.end ());
+}
+
+
+void
+MappedDiagnosticContextMap::detach ()
+{
+    if (rep && rep->refs.load (std::memory_order_acquire) != 1)
+    {
+        Rep * const new_rep = Rep::clone (rep, rep->capacity);
+        Rep::release (rep);
+        rep = new_rep;
+    }
+}
+
+
 //
 // MappedDiagnosticContext
 //
@@ -101,6 +385,27 @@ insert_or_assign (Map & map, Key && key, Value && value)
 }
 
 
+//! MappedDiagnosticContextMap gives read only access through iterators.
+template <typename Key, typename Value>
+static
+std::optional<tstring>
+insert_or_assign (MappedDiagnosticContextMap & map, Key && key,
+    Value && value)
+{
+    tstring_view const k (key);
+    if (! map.contains (k))
+    {
+        map.emplace (std::forward<Key>(key), std::forward<Value> (value));
+        return std::optional<tstring> ();
+    }
+
+    tstring & map_value = map.at (k);
+    tstring old_value {std::move (map_value)};
+    map_value = std::forward<Value> (value);
+    return std::optional<tstring> (std::move (old_value));
+}
+
+
 void
 MDC::put (tstring_view const & key, tstring const & value)
 {
@@ -388,6 +693,151 @@ CATCH_TEST_CASE ("MDC", "[MDC]")
     }
 }
 
+
+CATCH_TEST_CASE ("MappedDiagnosticContextMap", "[MDC]")
+{
+    MappedDiagnosticContextMap map;
+    map.emplace (LOG4CPLUS_TEXT ("c"), LOG4CPLUS_TEXT ("3"));
+    map.emplace (LOG4CPLUS_TEXT ("a"), LOG4CPLUS_TEXT ("1"));
+    map.emplace (tstring_view (LOG4CPLUS_TEXT ("b")), LOG4CPLUS_TEXT ("2"));
+
+    CATCH_SECTION ("sorted")
+    {
+        CATCH_REQUIRE (map.size () == 3);
+        tstring keys;
+        for (auto const & [key, value] : map)
+            keys += key;
+        CATCH_REQUIRE (keys == LOG4CPLUS_TEXT ("abc"));
+        CATCH_REQUIRE (! map.emplace (LOG4CPLUS_TEXT ("b"),
+            LOG4CPLUS_TEXT ("x")).second);
+        CATCH_REQUIRE (map.find (LOG4CPLUS_TEXT ("b"))->second
+            == LOG4CPLUS_TEXT ("2"));
+        CATCH_REQUIRE (! map.contains (LOG4CPLUS_TEXT ("d")));
+    }
+
+    CATCH_SECTION ("map interface")
+    {
+        static_assert (std::is_const_v<
+            std::remove_reference_t<decltype (*map.begin ())>>);
+        static_assert (std::is_const_v<std::remove_reference_t<
+            decltype (*map.emplace (tstring (), tstring ()).first)>>);
+
+        CATCH_REQUIRE (map.insert ({LOG4CPLUS_TEXT ("d"),
+            LOG4CPLUS_TEXT ("4")}).second);
+        CATCH_REQUIRE (! map.insert ({LOG4CPLUS_TEXT ("a"),
+            LOG4CPLUS_TEXT ("x")}).second);
+        CATCH_REQUIRE (map.count (LOG4CPLUS_TEXT ("d")) == 1);
+        CATCH_REQUIRE (map.count (LOG4CPLUS_TEXT ("e")) == 0);
+        CATCH_REQUIRE (map.lower_bound (LOG4CPLUS_TEXT ("bb"))->first
+            == LOG4CPLUS_TEXT ("c"));
+        CATCH_REQUIRE (map.lower_bound (LOG4CPLUS_TEXT ("e")) == map.end ());
+
+        CATCH_REQUIRE (std::as_const (map).at (LOG4CPLUS_TEXT ("a"))
+            == LOG4CPLUS_TEXT ("1"));
+        CATCH_REQUIRE_THROWS_AS (map.at (LOG4CPLUS_TEXT ("e")),
+            std::out_of_range);
+
+        MappedDiagnosticContextMap const snapshot (map);
+        map.at (LOG4CPLUS_TEXT ("a")) = LOG4CPLUS_TEXT ("changed");
+        CATCH_REQUIRE (map.at (LOG4CPLUS_TEXT ("a"))
+            == LOG4CPLUS_TEXT ("changed"));
+        CATCH_REQUIRE (snapshot.at (LOG4CPLUS_TEXT ("a"))
+            == LOG4CPLUS_TEXT ("1"));
+    }
+
+    CATCH_SECTION ("erase")
+    {
+        CATCH_REQUIRE (map.erase (LOG4CPLUS_TEXT ("b")) == 1);
+        CATCH_REQUIRE (map.erase (LOG4CPLUS_TEXT ("b")) == 0);
+        CATCH_REQUIRE (map.size () == 2);
+        CATCH_REQUIRE (map.begin ()->first == LOG4CPLUS_TEXT ("a"));
+        CATCH_REQUIRE ((map.begin () + 1)->first == LOG4CPLUS_TEXT ("c"));
+    }
+
+    CATCH_SECTION ("growth")
+    {
+        for (int i = 0; i != 20; ++i)
+            map[helpers::convertIntegerToString (i + 100)]
+                = helpers::convertIntegerToString (i);
+        CATCH_REQUIRE (map.size () == 23);
+        CATCH_REQUIRE (std::is_sorted (map.cbegin (), map.cend ()));
+        CATCH_REQUIRE (map.find (LOG4CPLUS_TEXT ("119"))->second
+            == LOG4CPLUS_TEXT ("19"));
+    }
+
+    CATCH_SECTION ("copy on write")
+    {
+        MappedDiagnosticContextMap const snapshot (map);
+        CATCH_REQUIRE (map.shared ());
+        CATCH_REQUIRE (snapshot.begin () == std::as_const (map).begin ());
+
+        map[LOG4CPLUS_TEXT ("a")] = LOG4CPLUS_TEXT ("changed");
+        CATCH_REQUIRE (! map.shared ());
+        CATCH_REQUIRE (! snapshot.shared ());
+        CATCH_REQUIRE (snapshot.find (LOG4CPLUS_TEXT ("a"))->second
+            == LOG4CPLUS_TEXT ("1"));
+        CATCH_REQUIRE (! (snapshot == map));
+
+        MappedDiagnosticContextMap copy (snapshot);
+        copy.clear ();
+        CATCH_REQUIRE (copy.empty ());
+        CATCH_REQUIRE (snapshot.size () == 3);
+    }
+
+    CATCH_SECTION ("event snapshot")
+    {
+        MDC & mdc = getMDC ();
+        mdc.clear ();
+        mdc.put (LOG4CPLUS_TEXT ("key"), LOG4CPLUS_TEXT ("value1"));
+        spi::InternalLoggingEvent const event (LOG4CPLUS_TEXT ("test"),
+            INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+        MappedDiagnosticContextMap const & captured = event.getMDCCopy ();
+        CATCH_REQUIRE (captured.begin () == mdc.getContext ().begin ());
+
+        mdc.put (LOG4CPLUS_TEXT ("key"), LOG4CPLUS_TEXT ("value2"));
+        CATCH_REQUIRE (event.getMDC (LOG4CPLUS_TEXT ("key"))
+            == LOG4CPLUS_TEXT ("value1"));
+        CATCH_REQUIRE (*mdc.get (LOG4CPLUS_TEXT ("key"))
+            == LOG4CPLUS_TEXT ("value2"));
+        mdc.clear ();
+    }
+}
+
+
+CATCH_TEST_CASE ("MDC capture benchmark", "[.][MDC][benchmark]")
+{
+    MDC & mdc = getMDC ();
+    mdc.clear ();
+    mdc.put (LOG4CPLUS_TEXT ("request"), LOG4CPLUS_TEXT ("7f3a9c2e"));
+    mdc.put (LOG4CPLUS_TEXT ("tenant"), LOG4CPLUS_TEXT ("acme"));
+    mdc.put (LOG4CPLUS_TEXT ("user"), LOG4CPLUS_TEXT ("u-1042"));
+    mdc.put (LOG4CPLUS_TEXT ("span"), LOG4CPLUS_TEXT ("0"));
+    tstring const spans[] = {
+        LOG4CPLUS_TEXT ("a1b2c3"), LOG4CPLUS_TEXT ("d4e5f6") };
+
+    constexpr std::size_t events = 200000;
+    std::size_t total = 0;
+
+    // Each event captures MDC for asynchronous appending and every
+    // fourth event is preceded by MDC change.
+    auto const start = std::chrono::steady_clock::now ();
+    for (std::size_t i = 0; i != events; ++i)
+    {
+        if (i % 4 == 0)
+            mdc.put (LOG4CPLUS_TEXT ("span"), spans[i / 4 % 2]);
+
+        spi::InternalLoggingEvent const event (LOG4CPLUS_TEXT ("bench"),
+            INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+        total += event.getMDCCopy ().size ();
+    }
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now () - start).count ();
+
+    CATCH_REQUIRE (total == 4 * events);
+    CATCH_WARN ((static_cast<double>(ns) / events) << " ns/event");
+    mdc.clear ();
+}
+
 #endif
 
 } // namespace log4cplus
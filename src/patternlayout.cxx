@@ -27,18 +27,25 @@
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/internal/internal.h>
 #include <log4cplus/internal/env.h>
+#include <algorithm>
 #include <limits>
 #include <cstdlib>
 #include <memory>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#include <chrono>
+#endif
+
 
 namespace
 {
 
 
 static
-log4cplus::tstring
-get_basename (const log4cplus::tstring& filename)
+void
+append_basename (log4cplus::tstring & result,
+    const log4cplus::tstring& filename)
 {
 #if defined(_WIN32)
     log4cplus::tchar const dir_sep(LOG4CPLUS_TEXT('\\'));
@@ -48,9 +55,9 @@ get_basename (const log4cplus::tstring& filename)
 
     log4cplus::tstring::size_type pos = filename.rfind(dir_sep);
     if (pos != log4cplus::tstring::npos)
-        return filename.substr(pos+1);
+        result.append (filename, pos + 1, log4cplus::tstring::npos);
     else
-        return filename;
+        result += filename;
 }
 
 
@@ -62,10 +69,6 @@ namespace log4cplus
 
 static tchar const ESCAPE_CHAR = LOG4CPLUS_TEXT('%');
 
-extern void formatRelativeTimestamp (log4cplus::tostream & output,
-    log4cplus::spi::InternalLoggingEvent const & event);
-
-
 namespace pattern
 {
 
@@ -83,32 +86,112 @@ struct FormattingInfo {
 
     void reset();
     void dump(helpers::LogLog&);
+
+    //! \returns true if formatting with this info does neither pad nor
+    //! truncate the converted field.
+    bool isDefault() const
+    { return minLen <= 0 && maxLen == std::numeric_limits<std::size_t>::max (); }
+
+    //! Pads or truncates \c buffer contents starting at \c start.
+    void apply(tstring & buffer, std::size_t start) const;
+};
+
+
+/**
+ * Opcodes of CompiledPattern instructions. Fields that are formatted
+ * by BasicPatternConverter use its converter type as opcode.
+ */
+enum Opcode : unsigned char {
+    THREAD_CONVERTER,
+    THREAD2_CONVERTER,
+    PROCESS_CONVERTER,
+    LOGLEVEL_CONVERTER,
+    NDC_CONVERTER,
+    MESSAGE_CONVERTER,
+    NEWLINE_CONVERTER,
+    BASENAME_CONVERTER,
+    FILE_CONVERTER,
+    LINE_CONVERTER,
+    FULL_LOCATION_CONVERTER,
+    FUNCTION_CONVERTER,
+    LITERAL_OPCODE,
+    LOGGER_OPCODE,
+    CONVERTER_OPCODE
+};
+
+
+class PatternConverter;
+
+
+/**
+ * This is a single step of CompiledPattern.
+ */
+struct Instruction {
+    Opcode op;
+    //! False when \c info is default and padding can be skipped.
+    bool padded;
+    FormattingInfo info;
+    //! Offset of literal text or logger name precision.
+    std::size_t arg;
+    //! Length of literal text.
+    std::size_t len;
+    //! Converter for \c CONVERTER_OPCODE.
+    PatternConverter * converter;
+};
+
+
+/**
+ * This is a pattern compiled into a flat array of instructions. Most
+ * fields are formatted directly by its interpreter loop, adjacent
+ * literals are merged into single instruction and only the remaining
+ * complex converters are called through virtual functions.
+ */
+class CompiledPattern
+{
+public:
+    CompiledPattern();
+
+    //! Appends constant text, already padded or truncated by \c info.
+    void emitLiteral(tstring const & str, FormattingInfo const & info);
+    void emit(Opcode op, FormattingInfo const & info, std::size_t arg = 0,
+        PatternConverter * converter = nullptr);
+
+    void run(tstring & buffer, const spi::InternalLoggingEvent& event) const;
+
+private:
+    std::vector<Instruction> program;
+    tstring literals;
+    LogLevelManager & llmCache;
 };
 
 
 
 /**
  * This is the base class of all "Converter" classes that format a
- * field of InternalLoggingEvent objects.  In fact, the PatternLayout
- * class simply uses an array of PatternConverter objects to format
- * and append a logging event.
+ * field of InternalLoggingEvent objects.  The PatternLayout class
+ * compiles an array of PatternConverter objects into CompiledPattern
+ * which it uses to format and append a logging event.
  */
 class PatternConverter
 {
 public:
     explicit PatternConverter(const FormattingInfo& info);
     virtual ~PatternConverter() = default;
-    void formatAndAppend(tostream& output,
+
+    //! Appends converted and padded or truncated field to \c buffer.
+    void formatInto(tstring & buffer,
         const spi::InternalLoggingEvent& event);
 
-    virtual void convert(tstring & result,
+    //! Appends converted field to \c result without any padding.
+    virtual void append(tstring & result,
         const spi::InternalLoggingEvent& event) = 0;
 
-private:
-    int minLen;
-    std::size_t maxLen;
-    bool leftAlign : 1;
-    bool trimStart : 1;
+    //! Emits instructions formatting this converter's field into
+    //! \c program. The default emits call of this converter.
+    virtual void compile(CompiledPattern & program);
+
+protected:
+    FormattingInfo info;
 };
 
 
@@ -123,10 +206,15 @@ class LiteralPatternConverter : public PatternConverter
 public:
     LiteralPatternConverter();
     explicit LiteralPatternConverter(const tstring& str);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent&) override
     {
-        result = str;
+        result += str;
+    }
+
+    void compile(CompiledPattern & program) override
+    {
+        program.emitLiteral(str, info);
     }
 
 private:
@@ -142,21 +230,13 @@ class BasicPatternConverter
     : public PatternConverter
 {
 public:
-    enum Type { THREAD_CONVERTER,
-                THREAD2_CONVERTER,
-                PROCESS_CONVERTER,
-                LOGLEVEL_CONVERTER,
-                NDC_CONVERTER,
-                MESSAGE_CONVERTER,
-                NEWLINE_CONVERTER,
-                BASENAME_CONVERTER,
-                FILE_CONVERTER,
-                LINE_CONVERTER,
-                FULL_LOCATION_CONVERTER,
-                FUNCTION_CONVERTER };
+    using Type = Opcode;
+    using enum Opcode;
+
     BasicPatternConverter(const FormattingInfo& info, Type type);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
+    void compile(CompiledPattern & program) override;
 
 private:
   // Disable copy
@@ -176,8 +256,9 @@ private:
 class LoggerPatternConverter : public PatternConverter {
 public:
     LoggerPatternConverter(const FormattingInfo& info, int precision);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
+    void compile(CompiledPattern & program) override;
 
 private:
     int precision;
@@ -195,7 +276,7 @@ public:
     DatePatternConverter(const FormattingInfo& info,
                          const tstring& pattern,
                          bool use_gmtime);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
 
 private:
@@ -211,7 +292,7 @@ class EnvPatternConverter : public PatternConverter {
 public:
     EnvPatternConverter(const FormattingInfo& info,
                         const log4cplus::tstring& env);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
 
 private:
@@ -223,7 +304,7 @@ private:
 class RelativeTimestampConverter: public PatternConverter {
 public:
     explicit RelativeTimestampConverter(const FormattingInfo& info);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
 };
 
@@ -234,8 +315,9 @@ public:
 class HostnamePatternConverter : public PatternConverter {
 public:
     HostnamePatternConverter(const FormattingInfo& info, bool fqdn);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
+    void compile(CompiledPattern & program) override;
 
 private:
     tstring hostname_;
@@ -252,7 +334,7 @@ class MDCPatternConverter
 {
 public:
     MDCPatternConverter(const FormattingInfo& info, tstring const & k);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
 
 private:
@@ -268,7 +350,7 @@ private:
 class NDCPatternConverter : public PatternConverter {
 public:
     NDCPatternConverter(const FormattingInfo& info, int precision);
-    void convert(tstring & result,
+    void append(tstring & result,
         const spi::InternalLoggingEvent& event) override;
 
 private:
@@ -337,6 +419,29 @@ FormattingInfo::dump(helpers::LogLog& loglog) {
 }
 
 
+void
+FormattingInfo::apply(tstring & buffer, std::size_t start) const
+{
+    std::size_t const len = buffer.size () - start;
+
+    if (len > maxLen)
+    {
+        if (trimStart)
+            buffer.erase (start, len - maxLen);
+        else
+            buffer.resize (start + maxLen);
+    }
+    else if (static_cast<int>(len) < minLen)
+    {
+        std::size_t const padding = minLen - len;
+        if (leftAlign)
+            buffer.append (padding, LOG4CPLUS_TEXT(' '));
+        else
+            buffer.insert (start, padding, LOG4CPLUS_TEXT(' '));
+    }
+}
+
+
 
 
 ////////////////////////////////////////////////
@@ -344,43 +449,25 @@ FormattingInfo::dump(helpers::LogLog& loglog) {
 ////////////////////////////////////////////////
 
 PatternConverter::PatternConverter(const FormattingInfo& i)
-{
-    minLen = i.minLen;
-    maxLen = i.maxLen;
-    leftAlign = i.leftAlign;
-    trimStart = i.trimStart;
-}
+    : info (i)
+{ }
 
 
 
 void
-PatternConverter::formatAndAppend(
-    tostream& output, const spi::InternalLoggingEvent& event)
+PatternConverter::formatInto(
+    tstring & buffer, const spi::InternalLoggingEvent& event)
 {
-    tstring & s = internal::get_ptd ()->faa_str;
-    convert (s, event);
-    std::size_t len = s.length();
+    std::size_t const start = buffer.size ();
+    append (buffer, event);
+    info.apply (buffer, start);
+}
 
-    if (len > maxLen)
-    {
-        if (trimStart)
-            output << s.substr(len - maxLen);
-        else
-            output << s.substr(0, maxLen);
-    }
-    else if (static_cast<int>(len) < minLen)
-    {
-        std::ios_base::fmtflags const original_flags = output.flags ();
-        tchar const fill = output.fill (LOG4CPLUS_TEXT(' '));
-        output.setf (leftAlign ? std::ios_base::left : std::ios_base::right,
-            std::ios_base::adjustfield);
-        output.width (minLen);
-        output << s;
-        output.fill (fill);
-        output.flags (original_flags);
-    }
-    else
-        output << s;
+
+void
+PatternConverter::compile(CompiledPattern & program)
+{
+    program.emit (CONVERTER_OPCODE, info, 0, this);
 }
 
 
@@ -417,54 +504,61 @@ BasicPatternConverter::BasicPatternConverter(
 
 
 
+static inline
 void
-BasicPatternConverter::convert(tstring & result,
-    const spi::InternalLoggingEvent& event)
+appendBasicField(tstring & result, Opcode type,
+    const spi::InternalLoggingEvent& event, LogLevelManager & llmCache)
 {
     switch(type)
     {
     case LOGLEVEL_CONVERTER:
-        result = llmCache.toString(event.getLogLevel());
+        result += llmCache.toString(event.getLogLevel());
         return;
 
     case BASENAME_CONVERTER:
-        result = get_basename(event.getFile());
+        append_basename(result, event.getFile());
         return;
 
     case PROCESS_CONVERTER:
-        helpers::convertIntegerToString(result, internal::get_process_id ());
-        return;
+        {
+            tstring & tmp = internal::get_ptd ()->faa_str;
+            helpers::convertIntegerToString(tmp, internal::get_process_id ());
+            result += tmp;
+            return;
+        }
 
     case NDC_CONVERTER:
-        result = event.getNDC();
+        result += event.getNDC();
         return;
 
     case MESSAGE_CONVERTER:
-        result = event.getMessage();
+        result += event.getMessage();
         return;
 
     case NEWLINE_CONVERTER:
-        result = LOG4CPLUS_TEXT("\n");
+        result += LOG4CPLUS_TEXT('\n');
         return;
 
     case FILE_CONVERTER:
-        result = event.getFile();
+        result += event.getFile();
         return;
 
     case THREAD_CONVERTER:
-        result = event.getThread();
+        result += event.getThread();
         return;
 
     case THREAD2_CONVERTER:
-        result = event.getThread2();
+        result += event.getThread2();
         return;
 
     case LINE_CONVERTER:
         {
             if(event.getLine() != -1)
-                helpers::convertIntegerToString(result, event.getLine());
-            else
-                result.clear ();
+            {
+                tstring & tmp = internal::get_ptd ()->faa_str;
+                helpers::convertIntegerToString(tmp, event.getLine());
+                result += tmp;
+            }
             return;
         }
 
@@ -473,21 +567,46 @@ BasicPatternConverter::convert(tstring & result,
             tstring const & file = event.getFile();
             if (! file.empty ())
             {
-                result = file;
-                result += LOG4CPLUS_TEXT(":");
-                result += helpers::convertIntegerToString(event.getLine());
+                tstring & tmp = internal::get_ptd ()->faa_str;
+                helpers::convertIntegerToString(tmp, event.getLine());
+                result += file;
+                result += LOG4CPLUS_TEXT(':');
+                result += tmp;
             }
             else
-                result = LOG4CPLUS_TEXT(":");
+                result += LOG4CPLUS_TEXT(':');
             return;
         }
 
     case FUNCTION_CONVERTER:
-        result = event.getFunction ();
+        result += event.getFunction ();
         return;
+
+    case LITERAL_OPCODE:
+    case LOGGER_OPCODE:
+    case CONVERTER_OPCODE:
+        break;
     }
 
-    result = LOG4CPLUS_TEXT("INTERNAL LOG4CPLUS ERROR");
+    result += LOG4CPLUS_TEXT("INTERNAL LOG4CPLUS ERROR");
+}
+
+
+void
+BasicPatternConverter::append(tstring & result,
+    const spi::InternalLoggingEvent& event)
+{
+    appendBasicField(result, type, event, llmCache);
+}
+
+
+void
+BasicPatternConverter::compile(CompiledPattern & program)
+{
+    if (type == NEWLINE_CONVERTER)
+        program.emitLiteral(LOG4CPLUS_TEXT("\n"), info);
+    else
+        program.emit(type, info);
 }
 
 
@@ -505,13 +624,12 @@ LoggerPatternConverter::LoggerPatternConverter(
 
 
 
+static
 void
-LoggerPatternConverter::convert(tstring & result,
-    const spi::InternalLoggingEvent& event)
+appendLoggerName(tstring & result, const tstring & name, int precision)
 {
-    const tstring& name = event.getLoggerName();
     if (precision <= 0) {
-        result = name;
+        result += name;
     }
     else {
         auto len = name.length();
@@ -524,15 +642,31 @@ LoggerPatternConverter::convert(tstring & result,
         {
             end = name.rfind(LOG4CPLUS_TEXT('.'), end - 1);
             if(end == tstring::npos) {
-                result = name;
+                result += name;
                 return;
             }
         }
-        result.assign (name, end + 1, tstring::npos);
+        result.append (name, end + 1, tstring::npos);
     }
 }
 
 
+void
+LoggerPatternConverter::append(tstring & result,
+    const spi::InternalLoggingEvent& event)
+{
+    appendLoggerName(result, event.getLoggerName(), precision);
+}
+
+
+void
+LoggerPatternConverter::compile(CompiledPattern & program)
+{
+    program.emit(LOGGER_OPCODE, info,
+        static_cast<std::size_t>((std::max) (precision, 0)));
+}
+
+
 
 ////////////////////////////////////////////////
 // DatePatternConverter methods:
@@ -551,10 +685,10 @@ DatePatternConverter::DatePatternConverter(
 
 
 void
-DatePatternConverter::convert(tstring & result,
+DatePatternConverter::append(tstring & result,
     const spi::InternalLoggingEvent& event)
 {
-    result = helpers::getFormattedTime(format, event.getTimestamp(),
+    helpers::appendFormattedTime(result, format, event.getTimestamp(),
         use_gmtime);
 }
 
@@ -572,14 +706,13 @@ EnvPatternConverter::EnvPatternConverter(
 
 
 void
-EnvPatternConverter::convert(tstring & result,
+EnvPatternConverter::append(tstring & result,
     const spi::InternalLoggingEvent&)
 {
-    if (! internal::get_env_var (result, envKey))
-    {
-        // Variable doesn't exist, return empty string.
-        result.clear ();
-    }
+    tstring & value = internal::get_ptd ()->faa_str;
+    // Variable that does not exist is formatted as empty string.
+    if (internal::get_env_var (value, envKey))
+        result += value;
 }
 
 
@@ -593,13 +726,17 @@ RelativeTimestampConverter::RelativeTimestampConverter (FormattingInfo const & i
 
 
 void
-RelativeTimestampConverter::convert (tstring & result,
+RelativeTimestampConverter::append (tstring & result,
     spi::InternalLoggingEvent const & event)
 {
-    tostringstream & oss = internal::get_ptd ()->layout_oss;
-    detail::clear_tostringstream (oss);
-    log4cplus::formatRelativeTimestamp (oss, event);
-    result = oss.str ();
+    auto const duration
+        = event.getTimestamp () - getTTCCLayoutTimeBase ();
+    tstring & tmp = internal::get_ptd ()->faa_str;
+    helpers::convertIntegerToString (tmp,
+        helpers::chrono::duration_cast<
+            helpers::chrono::duration<long long, std::milli>>(
+                duration).count ());
+    result += tmp;
 }
 
 
@@ -615,10 +752,17 @@ HostnamePatternConverter::HostnamePatternConverter (
 
 
 void
-HostnamePatternConverter::convert (
+HostnamePatternConverter::append (
     tstring & result, const spi::InternalLoggingEvent&)
 {
-    result = hostname_;
+    result += hostname_;
+}
+
+
+void
+HostnamePatternConverter::compile (CompiledPattern & program)
+{
+    program.emitLiteral (hostname_, info);
 }
 
 
@@ -635,17 +779,15 @@ log4cplus::pattern::MDCPatternConverter::MDCPatternConverter (
 
 
 void
-log4cplus::pattern::MDCPatternConverter::convert (tstring & result,
+log4cplus::pattern::MDCPatternConverter::append (tstring & result,
     const spi::InternalLoggingEvent& event)
 {
     if (!key.empty())
     {
-        result = event.getMDC (key);
+        result += event.getMDC (key);
     }
     else
     {
-        result.clear ();
-
         MappedDiagnosticContextMap const & mdcMap = event.getMDCCopy();
         for (auto const & [name, value] : mdcMap)
         {
@@ -672,19 +814,90 @@ log4cplus::pattern::NDCPatternConverter::NDCPatternConverter (
 
 
 void
-log4cplus::pattern::NDCPatternConverter::convert (tstring & result,
+log4cplus::pattern::NDCPatternConverter::append (tstring & result,
     const spi::InternalLoggingEvent& event)
 {
     const log4cplus::tstring& text = event.getNDC();
     if (precision <= 0)
-        result = text;
+        result += text;
     else
     {
         tstring::size_type p = text.find(LOG4CPLUS_TEXT(' '));
         for (int i = 1; i < precision && p != tstring::npos; ++i)
             p = text.find(LOG4CPLUS_TEXT(' '), p + 1);
 
-        result.assign (text, 0, p);
+        result.append (text, 0, p);
+    }
+}
+
+
+
+////////////////////////////////////////////////
+// CompiledPattern methods:
+////////////////////////////////////////////////
+
+CompiledPattern::CompiledPattern()
+    : llmCache(getLogLevelManager())
+{ }
+
+
+void
+CompiledPattern::emitLiteral(tstring const & str, FormattingInfo const & info)
+{
+    std::size_t const start = literals.size ();
+    literals += str;
+    info.apply (literals, start);
+    std::size_t const len = literals.size () - start;
+
+    // Literals are only ever appended to the pool so the last literal
+    // instruction can be extended when the new text follows it.
+    if (! program.empty () && program.back ().op == LITERAL_OPCODE)
+        program.back ().len += len;
+    else
+        program.push_back (Instruction {LITERAL_OPCODE, false,
+            FormattingInfo (), start, len, nullptr});
+}
+
+
+void
+CompiledPattern::emit(Opcode op, FormattingInfo const & info,
+    std::size_t arg, PatternConverter * converter)
+{
+    program.push_back (Instruction {op, ! info.isDefault (), info, arg, 0,
+        converter});
+}
+
+
+void
+CompiledPattern::run(tstring & buffer,
+    const spi::InternalLoggingEvent& event) const
+{
+    for (Instruction const & instr : program)
+    {
+        std::size_t const start = buffer.size ();
+
+        switch (instr.op)
+        {
+        case LITERAL_OPCODE:
+            buffer.append (literals.data () + instr.arg, instr.len);
+            continue;
+
+        case LOGGER_OPCODE:
+            appendLoggerName (buffer, event.getLoggerName (),
+                static_cast<int>(instr.arg));
+            break;
+
+        case CONVERTER_OPCODE:
+            instr.converter->append (buffer, event);
+            break;
+
+        default:
+            appendBasicField (buffer, instr.op, event, llmCache);
+            break;
+        }
+
+        if (instr.padded)
+            instr.info.apply (buffer, start);
     }
 }
 
@@ -1099,6 +1312,10 @@ PatternLayout::init(const tstring& pattern_, unsigned ndcMaxDepth)
                 new pattern::BasicPatternConverter(pattern::FormattingInfo(),
                     pattern::BasicPatternConverter::MESSAGE_CONVERTER));
     }
+
+    compiledPattern = std::make_unique<pattern::CompiledPattern> ();
+    for (auto & pc : parsedPattern)
+        pc->compile (*compiledPattern);
 }
 
 
@@ -1111,11 +1328,127 @@ void
 PatternLayout::formatAndAppend(tostream& output,
                                const spi::InternalLoggingEvent& event)
 {
-    for (auto const & pc : parsedPattern)
+    tstring & buffer = internal::get_ptd ()->layout_str;
+    buffer.clear ();
+    formatInto (buffer, event);
+    output.write (buffer.data (), static_cast<std::streamsize>(buffer.size ()));
+}
+
+
+void
+PatternLayout::formatInto(tstring& buffer,
+                          const spi::InternalLoggingEvent& event)
+{
+    compiledPattern->run(buffer, event);
+}
+
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+namespace
+{
+
+//! Exposes formatting through uncompiled converter list for comparison
+//! with the compiled pattern.
+class ConverterListPatternLayout
+    : public PatternLayout
+{
+public:
+    using PatternLayout::PatternLayout;
+
+    void
+    formatWithConverters (tstring & buffer,
+        spi::InternalLoggingEvent const & event)
+    {
+        for (auto const & pc : parsedPattern)
+            pc->formatInto (buffer, event);
+    }
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("PatternLayout", "[layout]")
+{
+    spi::InternalLoggingEvent const ev (
+        LOG4CPLUS_TEXT ("a.b.logger"), INFO_LOG_LEVEL,
+        LOG4CPLUS_TEXT ("message"), "file.cxx", 42, nullptr);
+
+    auto format = [&ev] (tstring const & pattern)
     {
-        pc->formatAndAppend(output, event);
+        ConverterListPatternLayout layout (pattern);
+        tstring buffer (LOG4CPLUS_TEXT ("prefix:"));
+        layout.formatInto (buffer, ev);
+
+        tostringstream oss;
+        layout.formatAndAppend (oss, ev);
+        CATCH_REQUIRE (LOG4CPLUS_TEXT ("prefix:") + oss.str () == buffer);
+
+        tstring converters_buffer (LOG4CPLUS_TEXT ("prefix:"));
+        layout.formatWithConverters (converters_buffer, ev);
+        CATCH_REQUIRE (converters_buffer == buffer);
+
+        return buffer.substr (7);
+    };
+
+    CATCH_SECTION ("plain fields")
+    {
+        CATCH_REQUIRE (format (LOG4CPLUS_TEXT ("%p %c{1} - %m [%L]%n"))
+            == LOG4CPLUS_TEXT ("INFO logger - message [42]\n"));
     }
+
+    CATCH_SECTION ("padding")
+    {
+        CATCH_REQUIRE (format (LOG4CPLUS_TEXT ("[%-6p][%6p][%-8c{2}]"))
+            == LOG4CPLUS_TEXT ("[INFO  ][  INFO][b.logger]"));
+    }
+
+    CATCH_SECTION ("truncation")
+    {
+        CATCH_REQUIRE (format (LOG4CPLUS_TEXT ("[%.3m][%.-3m]"))
+            == LOG4CPLUS_TEXT ("[age][mes]"));
+    }
+
+    CATCH_SECTION ("padded constants")
+    {
+        CATCH_REQUIRE (format (LOG4CPLUS_TEXT ("%m%3n%%%-3n|"))
+            == LOG4CPLUS_TEXT ("message  \n%\n  |"));
+    }
+}
+
+
+CATCH_TEST_CASE ("PatternLayout benchmark", "[.][layout][benchmark]")
+{
+    spi::InternalLoggingEvent const ev (
+        LOG4CPLUS_TEXT ("a.b.logger"), INFO_LOG_LEVEL,
+        LOG4CPLUS_TEXT ("This is a benchmark log message."), "file.cxx",
+        42, nullptr);
+    ConverterListPatternLayout layout (
+        LOG4CPLUS_TEXT ("%d [%t] %-5p %c - %m%n"));
+    constexpr int iterations = 1000000;
+    tstring buffer;
+
+    auto measure = [&] (auto && format)
+    {
+        auto const start = std::chrono::steady_clock::now ();
+        for (int i = 0; i != iterations; ++i)
+        {
+            buffer.clear ();
+            format ();
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now () - start).count () / iterations;
+    };
+
+    auto const converters_ns = measure ([&] {
+        layout.formatWithConverters (buffer, ev); });
+    auto const compiled_ns = measure ([&] {
+        layout.formatInto (buffer, ev); });
+
+    CATCH_WARN ("converter list: " << converters_ns << " ns/event, "
+        << "compiled pattern: " << compiled_ns << " ns/event");
 }
+#endif
 
 
 } // namespace log4cplus
@@ -25,21 +25,52 @@
 #ifndef LOG4CPLUS_SINGLE_THREADED
 
 #include <log4cplus/helpers/queue.h>
+#include <log4cplus/helpers/eventcounter.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
 #include <stdexcept>
 #include <algorithm>
 #include <iterator>
+#include <thread>
+#include <vector>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#endif
 
 
 namespace log4cplus::thread {
 
 
-Queue::Queue (unsigned len)
-    : ev_consumer (false)
-    , sem (len, len)
+AbstractQueue::AbstractQueue () = default;
+
+
+AbstractQueue::~AbstractQueue () = default;
+
+
+helpers::OverflowPolicy const &
+AbstractQueue::getOverflowPolicy () const
+{
+    return overflow;
+}
+
+
+//
+// Queue
+//
+
+Queue::Queue (unsigned len, helpers::OverflowPolicy const & policy)
+    : arena_head (0)
+    , count (0)
+    , capacity (len)
+    , ev_consumer (false)
+    , ev_producers (false)
     , flags (DRAIN)
-{ }
+{
+    overflow = policy;
+}
 
 
 Queue::~Queue () = default;
@@ -52,27 +83,58 @@ Queue::put_event (spi::InternalLoggingEvent const & ev)
     try
     {
         ev.gatherThreadSpecificData ();
+        LogLevel const ll = ev.getLogLevel ();
 
-        SemaphoreGuard semguard (sem);
-        MutexGuard mguard (mutex);
+        while (true)
+        {
+            MutexGuard mguard (mutex);
 
-        ret_flags |= flags;
+            ret_flags |= flags;
 
-        if (flags & EXIT)
-        {
-            ret_flags &= ~(ERROR_BIT | ERROR_AFTER);
-            return ret_flags;
-        }
-        else
-        {
-            queue.push_back (ev);
+            if (flags & EXIT)
+            {
+                ret_flags &= ~(ERROR_BIT | ERROR_AFTER);
+                return ret_flags;
+            }
+
+            helpers::OverflowPolicy::Decision const decision
+                = overflow.decide (ll, count, capacity);
+            if (decision == helpers::OverflowPolicy::ODWait)
+            {
+                // Wait for the consumer to take the queued events or
+                // for signal_exit().
+                ev_producers.reset ();
+                mguard.unlock ();
+                mguard.detach ();
+                ev_producers.wait ();
+                continue;
+            }
+            else if (decision == helpers::OverflowPolicy::ODDrop)
+            {
+                overflow.recordDrop (ll);
+                ret_flags &= ~(ERROR_BIT | ERROR_AFTER);
+                return ret_flags;
+            }
+            else if (decision == helpers::OverflowPolicy::ODEvict)
+            {
+                if (! overflow.evictPacked (arena, arena_head, count))
+                {
+                    overflow.recordDrop (ll);
+                    ret_flags &= ~(ERROR_BIT | ERROR_AFTER);
+                    return ret_flags;
+                }
+                --count;
+            }
+
+            ev.pack (arena);
+            ++count;
             ret_flags |= ERROR_AFTER;
-            semguard.detach ();
             flags |= QUEUE;
             ret_flags |= flags;
             mguard.unlock ();
             mguard.detach ();
             ev_consumer.signal ();
+            break;
         }
     }
     catch (std::runtime_error const & e)
@@ -110,6 +172,7 @@ Queue::signal_exit (bool drain)
             mguard.unlock ();
             mguard.detach ();
             ev_consumer.signal ();
+            ev_producers.signal ();
         }
     }
     catch (std::runtime_error const & e)
@@ -129,6 +192,8 @@ Queue::flags_type
 Queue::get_events (queue_storage_type * buf)
 {
     flags_type ret_flags = 0;
+    std::size_t events = 0;
+    std::size_t head = 0;
 
     try
     {
@@ -141,25 +206,31 @@ Queue::get_events (queue_storage_type * buf)
             if (((QUEUE & flags) && ! (EXIT & flags))
                 || ((EXIT | DRAIN | QUEUE) & flags) == (EXIT | DRAIN | QUEUE))
             {
-                assert (! queue.empty ());
-
-                std::size_t const count = queue.size ();
-                queue.swap (*buf);
-                queue.clear ();
+                assert (count != 0);
+
+                events = count;
+                head = arena_head;
+                // Events of the previous batch refer to consumer_arena
+                // until now.
+                consumer_arena.clear ();
+                arena.swap (consumer_arena);
+                arena_head = 0;
+                count = 0;
                 flags &= ~QUEUE;
-                for (std::size_t i = 0; i != count; ++i)
-                    sem.unlock ();
+                ev_producers.signal ();
 
                 ret_flags = flags | EVENT;
                 break;
             }
             else if (((EXIT | QUEUE) & flags) == (EXIT | QUEUE))
             {
-                assert (! queue.empty ());
-                queue.clear ();
+                assert (count != 0);
+                arena.clear ();
+                arena_head = 0;
+                count = 0;
                 flags &= ~QUEUE;
                 ev_consumer.reset ();
-                sem.unlock ();
+                ev_producers.signal ();
                 ret_flags = flags;
                 break;
             }
@@ -173,6 +244,15 @@ Queue::get_events (queue_storage_type * buf)
                 ev_consumer.wait ();
             }
         }
+
+        // Unpack events outside of the lock.
+        if (ret_flags & EVENT)
+        {
+            buf->resize (events);
+            char const * record = consumer_arena.data () + head;
+            for (auto & ev : *buf)
+                record = ev.unpack (record);
+        }
     }
     catch (std::runtime_error const & e)
     {
@@ -186,6 +266,618 @@ Queue::get_events (queue_storage_type * buf)
 }
 
 
+//
+// LockFreeQueue
+//
+
+namespace
+{
+
+static
+std::size_t
+round_up_capacity (unsigned len)
+{
+    std::size_t cap = 2;
+    while (cap < len)
+        cap <<= 1;
+    return cap;
+}
+
+} // namespace
+
+
+LockFreeQueue::LockFreeQueue (unsigned len,
+    helpers::OverflowPolicy const & policy)
+    : slots (new Slot[round_up_capacity (len)])
+    , capacity (round_up_capacity (len))
+    , enqueue_pos (0)
+    , produced_seq (0)
+    , consumed_seq (0)
+    , dequeue_pos (0)
+    , flags (DRAIN)
+{
+    for (std::size_t i = 0; i != capacity; ++i)
+        slots[i].sequence.store (i, std::memory_order_relaxed);
+
+    overflow = policy;
+    if (overflow.action == helpers::OverflowPolicy::OPDropOldest)
+        helpers::getLogLog ().warn (
+            LOG4CPLUS_TEXT ("LockFreeQueue cannot drop oldest events,")
+            LOG4CPLUS_TEXT (" dropping newest instead."));
+}
+
+
+LockFreeQueue::~LockFreeQueue () = default;
+
+
+LockFreeQueue::flags_type
+LockFreeQueue::put_event (spi::InternalLoggingEvent const & ev)
+{
+    flags_type ret_flags = ERROR_BIT;
+    try
+    {
+        ev.gatherThreadSpecificData ();
+    }
+    catch (std::runtime_error const & e)
+    {
+        log4cplus::helpers::getLogLog().error(
+            LOG4CPLUS_TEXT("put_event() exception: ")
+            + LOG4CPLUS_C_STR_TO_TSTRING(e.what()));
+        return ret_flags;
+    }
+
+    LogLevel const ll = ev.getLogLevel ();
+    // Reservation and sampling need the number of queued events. It is
+    // only approximate here because the consumer publishes its position
+    // once per batch.
+    bool const need_size = overflow.reservedCapacity != 0
+        || overflow.action == helpers::OverflowPolicy::OPSample;
+
+    Slot * slot;
+    std::size_t pos;
+    std::size_t enq = enqueue_pos.load (std::memory_order_relaxed);
+    while (true)
+    {
+        if (enq & POS_CLOSED)
+        {
+            ret_flags = flags.load (std::memory_order_acquire);
+            return ret_flags;
+        }
+
+        pos = enq / POS_STEP;
+        slot = &slots[pos & (capacity - 1)];
+        std::size_t const seq = slot->sequence.load (
+            std::memory_order_acquire);
+        auto const diff = static_cast<std::ptrdiff_t>(seq)
+            - static_cast<std::ptrdiff_t>(pos);
+        if (diff > 0)
+        {
+            enq = enqueue_pos.load (std::memory_order_relaxed);
+            continue;
+        }
+
+        std::size_t size = capacity;
+        std::size_t deq = 0;
+        if (diff == 0 && need_size)
+        {
+            deq = dequeue_pos.load (std::memory_order_acquire);
+            size = pos > deq ? pos - deq : 0;
+        }
+
+        helpers::OverflowPolicy::Decision const decision
+            = diff == 0 && ! need_size
+            ? helpers::OverflowPolicy::ODAccept
+            : overflow.decide (ll, size, capacity);
+        if (decision == helpers::OverflowPolicy::ODAccept)
+        {
+            if (enqueue_pos.compare_exchange_weak (enq, enq + POS_STEP,
+                    std::memory_order_relaxed))
+                break;
+        }
+        else if (decision == helpers::OverflowPolicy::ODWait)
+        {
+            // The ring is full. Wait for the consumer to release some
+            // slots or for signal_exit().
+            std::uint32_t const seen = consumed_seq.load (
+                std::memory_order_acquire);
+            bool const unchanged = diff == 0
+                ? dequeue_pos.load (std::memory_order_acquire) == deq
+                : slot->sequence.load (std::memory_order_acquire) == seq;
+            if (unchanged
+                && ! (enqueue_pos.load (std::memory_order_relaxed)
+                    & POS_CLOSED))
+                consumed_seq.wait (seen, std::memory_order_acquire);
+            enq = enqueue_pos.load (std::memory_order_relaxed);
+        }
+        else
+        {
+            // Dropping the oldest event would race with the consumer,
+            // the new event is dropped instead.
+            overflow.recordDrop (ll);
+            return flags.load (std::memory_order_relaxed);
+        }
+    }
+
+    // The slot has been claimed. It has to be published whatever
+    // happens, otherwise the consumer would wait for it forever.
+    ret_flags |= ERROR_AFTER;
+    try
+    {
+        slot->record.clear ();
+        ev.pack (slot->record);
+        slot->valid = true;
+        ret_flags &= ~(ERROR_BIT | ERROR_AFTER);
+    }
+    catch (std::exception const & e)
+    {
+        slot->valid = false;
+        log4cplus::helpers::getLogLog().error(
+            LOG4CPLUS_TEXT("put_event() exception: ")
+            + LOG4CPLUS_C_STR_TO_TSTRING(e.what()));
+    }
+
+    slot->sequence.store (pos + 1, std::memory_order_release);
+    produced_seq.fetch_add (1, std::memory_order_release);
+    produced_seq.notify_one ();
+
+    ret_flags |= flags.load (std::memory_order_relaxed) | QUEUE;
+    return ret_flags;
+}
+
+
+LockFreeQueue::flags_type
+LockFreeQueue::signal_exit (bool drain)
+{
+    flags_type ret_flags = flags.load (std::memory_order_acquire);
+    if (ret_flags & EXIT)
+        return ret_flags;
+
+    flags_type const new_flags = (drain ? (ret_flags | DRAIN)
+        : (ret_flags & ~DRAIN)) | EXIT;
+    flags.store (new_flags, std::memory_order_release);
+    enqueue_pos.fetch_or (POS_CLOSED, std::memory_order_acq_rel);
+
+    // Wake up the consumer and all producers blocked on full ring.
+    produced_seq.fetch_add (1, std::memory_order_release);
+    produced_seq.notify_one ();
+    consumed_seq.fetch_add (1, std::memory_order_release);
+    consumed_seq.notify_all ();
+
+    return new_flags;
+}
+
+
+LockFreeQueue::flags_type
+LockFreeQueue::get_events (queue_storage_type * buf)
+{
+    // Events of the previous batch refer to consumer_arena until now.
+    consumer_arena.clear ();
+
+    while (true)
+    {
+        std::uint32_t const seen = produced_seq.load (
+            std::memory_order_acquire);
+        std::size_t const enq = enqueue_pos.load (std::memory_order_acquire);
+        bool const closed = !! (enq & POS_CLOSED);
+        flags_type const cur_flags = flags.load (std::memory_order_acquire);
+        bool const drop = closed && ! (cur_flags & DRAIN);
+
+        // Take all published slots in order.
+        std::size_t count = 0;
+        std::size_t const deq = dequeue_pos.load (std::memory_order_relaxed);
+        std::size_t pos = deq;
+        while (true)
+        {
+            Slot & slot = slots[pos & (capacity - 1)];
+            if (slot.sequence.load (std::memory_order_acquire) != pos + 1)
+            {
+                // Once the queue is closed, no new slots are claimed.
+                // Wait for claimed but not yet published slots.
+                if (closed && pos < enq / POS_STEP)
+                {
+                    std::this_thread::yield ();
+                    continue;
+                }
+                break;
+            }
+
+            if (slot.valid && ! drop)
+            {
+                // The slot is reused by producers once it is released,
+                // the record is copied out of it.
+                consumer_arena.insert (consumer_arena.end (),
+                    slot.record.begin (), slot.record.end ());
+                ++count;
+            }
+
+            slot.sequence.store (pos + capacity, std::memory_order_release);
+            ++pos;
+
+            if (count == capacity)
+                break;
+        }
+
+        if (pos != deq)
+        {
+            dequeue_pos.store (pos, std::memory_order_release);
+            consumed_seq.fetch_add (1, std::memory_order_release);
+            consumed_seq.notify_all ();
+        }
+
+        if (count != 0)
+        {
+            buf->resize (count);
+            char const * record = consumer_arena.data ();
+            for (auto & ev : *buf)
+                record = ev.unpack (record);
+            return cur_flags | EVENT;
+        }
+
+        if (closed)
+        {
+            buf->clear ();
+            return cur_flags;
+        }
+
+        // The ring is empty. Sleep until a producer publishes something
+        // or until signal_exit() is called.
+        Slot & next = slots[pos & (capacity - 1)];
+        if (next.sequence.load (std::memory_order_acquire) != pos + 1)
+            produced_seq.wait (seen, std::memory_order_acquire);
+    }
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("LockFreeQueue", "[queue]")
+{
+    unsigned const producers = 4;
+    unsigned const per_producer = 1000;
+
+    auto run_producers = [&] (AbstractQueue & q) {
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p != producers; ++p)
+            threads.emplace_back ([&q, p] {
+                for (unsigned i = 0; i != per_producer; ++i)
+                {
+                    spi::InternalLoggingEvent ev (
+                        LOG4CPLUS_TEXT ("queue"), INFO_LOG_LEVEL,
+                        helpers::convertIntegerToString (
+                            p * per_producer + i),
+                        __FILE__, __LINE__);
+                    q.put_event (ev);
+                }
+            });
+        return threads;
+    };
+
+    CATCH_SECTION ("all events delivered in per-producer order")
+    {
+        LockFreeQueue q (16);
+        auto threads = run_producers (q);
+
+        std::vector<unsigned> last (producers, 0);
+        std::size_t received = 0;
+        AbstractQueue::queue_storage_type buf;
+        while (received != producers * per_producer)
+        {
+            AbstractQueue::flags_type const flags = q.get_events (&buf);
+            CATCH_REQUIRE ((flags & AbstractQueue::EVENT));
+            for (auto const & ev : buf)
+            {
+                unsigned const n = static_cast<unsigned>(
+                    std::stoul (ev.getMessage ()));
+                unsigned const p = n / per_producer;
+                CATCH_REQUIRE (n % per_producer + 1 > last[p]);
+                last[p] = n % per_producer + 1;
+                ++received;
+            }
+        }
+
+        for (auto & t : threads)
+            t.join ();
+        CATCH_REQUIRE (received == producers * per_producer);
+    }
+
+    CATCH_SECTION ("signal_exit() drains queued events")
+    {
+        LockFreeQueue q (8);
+        for (unsigned i = 0; i != 5; ++i)
+            q.put_event (spi::InternalLoggingEvent (LOG4CPLUS_TEXT ("queue"),
+                    INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("drain"), __FILE__,
+                    __LINE__));
+        q.signal_exit (true);
+
+        AbstractQueue::queue_storage_type buf;
+        AbstractQueue::flags_type flags = q.get_events (&buf);
+        CATCH_REQUIRE ((flags & (AbstractQueue::EVENT | AbstractQueue::EXIT
+                | AbstractQueue::DRAIN))
+            == (AbstractQueue::EVENT | AbstractQueue::EXIT
+                | AbstractQueue::DRAIN));
+        CATCH_REQUIRE (buf.size () == 5);
+
+        flags = q.get_events (&buf);
+        CATCH_REQUIRE (! (flags & AbstractQueue::EVENT));
+        CATCH_REQUIRE ((flags & AbstractQueue::EXIT));
+
+        flags = q.put_event (spi::InternalLoggingEvent (
+                LOG4CPLUS_TEXT ("queue"), INFO_LOG_LEVEL,
+                LOG4CPLUS_TEXT ("late"), __FILE__, __LINE__));
+        CATCH_REQUIRE ((flags & AbstractQueue::EXIT));
+        CATCH_REQUIRE (! (flags & AbstractQueue::ERROR_BIT));
+    }
+
+    CATCH_SECTION ("signal_exit() without drain drops queued events")
+    {
+        LockFreeQueue q (8);
+        q.put_event (spi::InternalLoggingEvent (LOG4CPLUS_TEXT ("queue"),
+                INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("drop"), __FILE__, __LINE__));
+        q.signal_exit (false);
+
+        AbstractQueue::queue_storage_type buf;
+        AbstractQueue::flags_type const flags = q.get_events (&buf);
+        CATCH_REQUIRE (! (flags & AbstractQueue::EVENT));
+        CATCH_REQUIRE (buf.empty ());
+    }
+}
+
+
+CATCH_TEST_CASE ("Packed events", "[queue]")
+{
+    MappedDiagnosticContextMap mdc;
+    mdc[LOG4CPLUS_TEXT ("key")] = LOG4CPLUS_TEXT ("value");
+    mdc[LOG4CPLUS_TEXT ("empty")] = tstring ();
+    helpers::Time const time = helpers::now ();
+    spi::InternalLoggingEvent const ev (LOG4CPLUS_TEXT ("logger"),
+        WARN_LOG_LEVEL, LOG4CPLUS_TEXT ("ndc"), mdc,
+        LOG4CPLUS_TEXT ("message"), LOG4CPLUS_TEXT ("thread"),
+        LOG4CPLUS_TEXT ("thread2"), time, LOG4CPLUS_TEXT ("file"), 42,
+        LOG4CPLUS_TEXT ("function"));
+
+    auto require_same = [&] (spi::InternalLoggingEvent const & other) {
+        CATCH_REQUIRE (other.getLoggerName () == ev.getLoggerName ());
+        CATCH_REQUIRE (other.getLogLevel () == ev.getLogLevel ());
+        CATCH_REQUIRE (other.getNDC () == ev.getNDC ());
+        CATCH_REQUIRE (other.getMDCCopy () == mdc);
+        CATCH_REQUIRE (other.getMessage () == ev.getMessage ());
+        CATCH_REQUIRE (other.getThread () == ev.getThread ());
+        CATCH_REQUIRE (other.getThread2 () == ev.getThread2 ());
+        CATCH_REQUIRE (other.getTimestamp () == time);
+        CATCH_REQUIRE (other.getFile () == ev.getFile ());
+        CATCH_REQUIRE (other.getLine () == 42);
+        CATCH_REQUIRE (other.getFunction () == ev.getFunction ());
+    };
+
+    CATCH_SECTION ("pack() and unpack() round trip")
+    {
+        std::vector<char> arena;
+        ev.pack (arena);
+        std::size_t const first_size = arena.size ();
+        ev.pack (arena);
+        CATCH_REQUIRE (arena.size () == 2 * first_size);
+
+        spi::InternalLoggingEvent other (LOG4CPLUS_TEXT ("other"),
+            INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("other message"), nullptr, 0);
+        char const * record = other.unpack (arena.data ());
+        require_same (other);
+        record = other.unpack (record);
+        require_same (other);
+        CATCH_REQUIRE (record == arena.data () + arena.size ());
+    }
+
+    CATCH_SECTION ("copy of unpacked event does not refer to record")
+    {
+        std::vector<char> arena;
+        ev.pack (arena);
+
+        spi::InternalLoggingEvent other;
+        other.unpack (arena.data ());
+        CATCH_REQUIRE (other.getLogLevel () == ev.getLogLevel ());
+        CATCH_REQUIRE (other.getMessage () == ev.getMessage ());
+        spi::InternalLoggingEvent const copy (other);
+        std::fill (arena.begin (), arena.end (), char (0));
+        require_same (copy);
+    }
+
+    CATCH_SECTION ("events survive both queue types")
+    {
+        AbstractQueuePtr const queues[] = {
+            AbstractQueuePtr (new Queue (4)),
+            AbstractQueuePtr (new LockFreeQueue (4)) };
+        for (auto const & q : queues)
+        {
+            q->put_event (ev);
+            q->put_event (ev);
+            AbstractQueue::queue_storage_type buf;
+            AbstractQueue::flags_type const flags = q->get_events (&buf);
+            CATCH_REQUIRE ((flags & AbstractQueue::EVENT));
+            CATCH_REQUIRE (buf.size () == 2);
+            require_same (buf[0]);
+            require_same (buf[1]);
+        }
+    }
+}
+
+
+CATCH_TEST_CASE ("Queue overflow policies", "[queue]")
+{
+    using helpers::OverflowPolicy;
+
+    auto put = [] (AbstractQueue & q, LogLevel ll, unsigned i) {
+        q.put_event (spi::InternalLoggingEvent (LOG4CPLUS_TEXT ("queue"),
+            ll, helpers::convertIntegerToString (i), __FILE__, __LINE__));
+    };
+
+    auto take = [] (AbstractQueue & q) {
+        AbstractQueue::queue_storage_type buf;
+        std::vector<tstring> messages;
+        if (q.get_events (&buf) & AbstractQueue::EVENT)
+            for (auto const & ev : buf)
+                messages.push_back (ev.getMessage ());
+        return messages;
+    };
+
+    auto make_queues = [] (OverflowPolicy const & policy) {
+        return std::vector<AbstractQueuePtr> {
+            AbstractQueuePtr (new Queue (4, policy)),
+            AbstractQueuePtr (new LockFreeQueue (4, policy)) };
+    };
+
+    CATCH_SECTION ("drop newest")
+    {
+        OverflowPolicy policy;
+        policy.action = OverflowPolicy::OPDropNewest;
+        for (auto const & q : make_queues (policy))
+        {
+            for (unsigned i = 0; i != 6; ++i)
+                put (*q, INFO_LOG_LEVEL, i);
+            CATCH_REQUIRE (take (*q) == std::vector<tstring> {
+                LOG4CPLUS_TEXT ("0"), LOG4CPLUS_TEXT ("1"),
+                LOG4CPLUS_TEXT ("2"), LOG4CPLUS_TEXT ("3") });
+            CATCH_REQUIRE (q->getOverflowPolicy ().getDropCount (
+                INFO_LOG_LEVEL) == 2);
+            CATCH_REQUIRE (q->getOverflowPolicy ().getDropCount () == 2);
+        }
+    }
+
+    CATCH_SECTION ("drop oldest")
+    {
+        OverflowPolicy policy;
+        policy.action = OverflowPolicy::OPDropOldest;
+        Queue q (4, policy);
+        for (unsigned i = 0; i != 20; ++i)
+            put (q, i < 10 ? DEBUG_LOG_LEVEL : INFO_LOG_LEVEL, i);
+        CATCH_REQUIRE (take (q) == std::vector<tstring> {
+            LOG4CPLUS_TEXT ("16"), LOG4CPLUS_TEXT ("17"),
+            LOG4CPLUS_TEXT ("18"), LOG4CPLUS_TEXT ("19") });
+        CATCH_REQUIRE (q.getOverflowPolicy ().getDropCount (
+            DEBUG_LOG_LEVEL) == 10);
+        CATCH_REQUIRE (q.getOverflowPolicy ().getDropCount (
+            INFO_LOG_LEVEL) == 6);
+    }
+
+    CATCH_SECTION ("drop oldest keeps reserved levels")
+    {
+        OverflowPolicy policy;
+        policy.action = OverflowPolicy::OPDropOldest;
+        Queue q (4, policy);
+        put (q, FATAL_LOG_LEVEL, 0);
+        put (q, ERROR_LOG_LEVEL, 1);
+        put (q, DEBUG_LOG_LEVEL, 2);
+        put (q, FATAL_LOG_LEVEL, 3);
+        put (q, INFO_LOG_LEVEL, 4);
+        put (q, DEBUG_LOG_LEVEL, 5);
+        put (q, FATAL_LOG_LEVEL, 6);
+        // Only ERROR and FATAL events are queued, the new one is dropped.
+        put (q, DEBUG_LOG_LEVEL, 7);
+        CATCH_REQUIRE (take (q) == std::vector<tstring> {
+            LOG4CPLUS_TEXT ("0"), LOG4CPLUS_TEXT ("1"),
+            LOG4CPLUS_TEXT ("3"), LOG4CPLUS_TEXT ("6") });
+        CATCH_REQUIRE (q.getOverflowPolicy ().getDropCount (
+            DEBUG_LOG_LEVEL) == 3);
+        CATCH_REQUIRE (q.getOverflowPolicy ().getDropCount (
+            INFO_LOG_LEVEL) == 1);
+        CATCH_REQUIRE (q.getOverflowPolicy ().getDropCount (
+            ERROR_LOG_LEVEL) == 0);
+        CATCH_REQUIRE (q.getOverflowPolicy ().getDropCount (
+            FATAL_LOG_LEVEL) == 0);
+    }
+
+    CATCH_SECTION ("reserved capacity")
+    {
+        OverflowPolicy policy;
+        policy.action = OverflowPolicy::OPDropNewest;
+        policy.reservedCapacity = 2;
+        policy.reservedLevel = ERROR_LOG_LEVEL;
+        for (auto const & q : make_queues (policy))
+        {
+            for (unsigned i = 0; i != 3; ++i)
+                put (*q, DEBUG_LOG_LEVEL, i);
+            for (unsigned i = 10; i != 13; ++i)
+                put (*q, FATAL_LOG_LEVEL, i);
+            CATCH_REQUIRE (take (*q) == std::vector<tstring> {
+                LOG4CPLUS_TEXT ("0"), LOG4CPLUS_TEXT ("1"),
+                LOG4CPLUS_TEXT ("10"), LOG4CPLUS_TEXT ("11") });
+            CATCH_REQUIRE (q->getOverflowPolicy ().getDropCount (
+                DEBUG_LOG_LEVEL) == 1);
+            CATCH_REQUIRE (q->getOverflowPolicy ().getDropCount (
+                FATAL_LOG_LEVEL) == 1);
+        }
+    }
+
+    CATCH_SECTION ("drop below level")
+    {
+        OverflowPolicy policy;
+        policy.action = OverflowPolicy::OPDropBelowLevel;
+        policy.overflowLevel = WARN_LOG_LEVEL;
+        for (auto const & q : make_queues (policy))
+        {
+            for (unsigned i = 0; i != 4; ++i)
+                put (*q, ERROR_LOG_LEVEL, i);
+
+            // A full queue drops INFO at once...
+            put (*q, INFO_LOG_LEVEL, 4);
+            CATCH_REQUIRE (q->getOverflowPolicy ().getDropCount (
+                INFO_LOG_LEVEL) == 1);
+
+            // ...but ERROR waits until the consumer makes space.
+            std::thread producer ([&] { put (*q, ERROR_LOG_LEVEL, 5); });
+            std::vector<tstring> messages = take (*q);
+            producer.join ();
+            std::vector<tstring> const rest = take (*q);
+            messages.insert (messages.end (), rest.begin (), rest.end ());
+            CATCH_REQUIRE (messages == std::vector<tstring> {
+                LOG4CPLUS_TEXT ("0"), LOG4CPLUS_TEXT ("1"),
+                LOG4CPLUS_TEXT ("2"), LOG4CPLUS_TEXT ("3"),
+                LOG4CPLUS_TEXT ("5") });
+            CATCH_REQUIRE (q->getOverflowPolicy ().getDropCount (
+                ERROR_LOG_LEVEL) == 0);
+        }
+    }
+
+    CATCH_SECTION ("sample")
+    {
+        OverflowPolicy policy;
+        policy.action = OverflowPolicy::OPSample;
+        policy.sampleRate = 2;
+        Queue q (8, policy);
+        for (unsigned i = 0; i != 20; ++i)
+            put (q, INFO_LOG_LEVEL, i);
+        // Half of the queue fills up freely, then every other event
+        // is accepted until the queue is full.
+        CATCH_REQUIRE (take (q) == std::vector<tstring> {
+            LOG4CPLUS_TEXT ("0"), LOG4CPLUS_TEXT ("1"),
+            LOG4CPLUS_TEXT ("2"), LOG4CPLUS_TEXT ("3"),
+            LOG4CPLUS_TEXT ("4"), LOG4CPLUS_TEXT ("6"),
+            LOG4CPLUS_TEXT ("8"), LOG4CPLUS_TEXT ("10") });
+        CATCH_REQUIRE (q.getOverflowPolicy ().getDropCount () == 12);
+    }
+
+    CATCH_SECTION ("configure")
+    {
+        helpers::Properties props;
+        props.setProperty (LOG4CPLUS_TEXT ("OverflowPolicy"),
+            LOG4CPLUS_TEXT ("DropBelowLevel"));
+        props.setProperty (LOG4CPLUS_TEXT ("OverflowLevel"),
+            LOG4CPLUS_TEXT ("error"));
+        props.setProperty (LOG4CPLUS_TEXT ("SampleRate"),
+            LOG4CPLUS_TEXT ("5"));
+        props.setProperty (LOG4CPLUS_TEXT ("ReservedCapacity"),
+            LOG4CPLUS_TEXT ("16"));
+        props.setProperty (LOG4CPLUS_TEXT ("ReservedLevel"),
+            LOG4CPLUS_TEXT ("FATAL"));
+        OverflowPolicy policy;
+        policy.configure (props);
+        CATCH_REQUIRE (policy.action == OverflowPolicy::OPDropBelowLevel);
+        CATCH_REQUIRE (policy.overflowLevel == ERROR_LOG_LEVEL);
+        CATCH_REQUIRE (policy.sampleRate == 5);
+        CATCH_REQUIRE (policy.reservedCapacity == 16);
+        CATCH_REQUIRE (policy.reservedLevel == FATAL_LOG_LEVEL);
+    }
+}
+#endif
+
+
 } // namespace log4cplus::thread
 
 
@@ -0,0 +1,542 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Haisman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_SYS_TYPES_H)
+#include <sys/types.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_SYS_STAT_H)
+#include <sys/stat.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_FCNTL_H)
+#include <fcntl.h>
+#endif
+
+#if ! defined (_WIN32) && defined (_POSIX_MAPPED_FILES) \
+    && _POSIX_MAPPED_FILES > 0 && defined (LOG4CPLUS_HAVE_FCNTL_H) \
+    && defined (LOG4CPLUS_HAVE_SYS_STAT_H)
+#  define LOG4CPLUS_USE_MMAP_RING_FILE
+#  include <sys/mman.h>
+#endif
+
+#include <log4cplus/ringfileappender.h>
+#include <log4cplus/layout.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/thread/syncprims-pub-impl.h>
+#include <log4cplus/internal/env.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#include <cstdio>
+#endif
+
+
+namespace log4cplus
+{
+
+namespace
+{
+
+char const ring_file_magic[8] = { 'L', '4', 'C', 'P', 'R', 'I', 'N', 'G' };
+std::uint32_t const ring_file_version = 1;
+std::uint32_t const ring_file_header_size = 64;
+std::size_t const minimum_ring_data_size = 64 * 1024;
+
+static_assert (sizeof (RingFileHeader) <= ring_file_header_size);
+static_assert (sizeof (RingRecordHeader) % 8 == 0);
+
+
+static
+std::uint64_t
+align_record (std::uint64_t size)
+{
+    return (size + 7) & ~std::uint64_t (7);
+}
+
+
+//! \return Logical offset of the record following the one at
+//! <code>pos</code>.
+static
+std::uint64_t
+next_record (unsigned char const * data, std::uint64_t data_size,
+    std::uint64_t pos)
+{
+    std::uint64_t const phys = pos % data_size;
+    std::uint64_t const left = data_size - phys;
+    if (left < sizeof (RingRecordHeader))
+        return pos + left;
+
+    RingRecordHeader rec;
+    std::memcpy (&rec, data + phys, sizeof (rec));
+    return pos + align_record (sizeof (RingRecordHeader) + rec.size);
+}
+
+
+static
+std::uint64_t
+load_position (std::uint64_t & pos)
+{
+    return std::atomic_ref<std::uint64_t> (pos).load (
+        std::memory_order_acquire);
+}
+
+
+static
+void
+store_position (std::uint64_t & pos, std::uint64_t value)
+{
+    std::atomic_ref<std::uint64_t> (pos).store (value,
+        std::memory_order_release);
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// readRingFile
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+readRingFile (const tstring& filename,
+    std::function<void (RingRecordHeader const &, std::string_view)> const&
+        func)
+{
+    helpers::LogLog & loglog = helpers::getLogLog ();
+
+    std::ifstream in (std::filesystem::path (filename), std::ios_base::binary);
+    RingFileHeader hdr;
+    if (! in.read (reinterpret_cast<char *>(&hdr), sizeof (hdr)))
+    {
+        loglog.error (LOG4CPLUS_TEXT ("Failed to read ring file ")
+            + filename);
+        return false;
+    }
+
+    if (std::memcmp (hdr.magic, ring_file_magic, sizeof (hdr.magic)) != 0
+        || hdr.version != ring_file_version
+        || hdr.header_size < sizeof (hdr)
+        || hdr.data_size == 0
+        || hdr.tail > hdr.head
+        || hdr.head - hdr.tail > hdr.data_size)
+    {
+        loglog.error (filename + LOG4CPLUS_TEXT (" is not a ring file"));
+        return false;
+    }
+
+    std::vector<unsigned char> data (static_cast<std::size_t>(hdr.data_size));
+    in.seekg (hdr.header_size);
+    if (! in.read (reinterpret_cast<char *>(data.data ()),
+            static_cast<std::streamsize>(data.size ())))
+    {
+        loglog.error (LOG4CPLUS_TEXT ("Failed to read ring file ")
+            + filename);
+        return false;
+    }
+
+    for (std::uint64_t pos = hdr.tail; pos < hdr.head; )
+    {
+        std::uint64_t const phys = pos % hdr.data_size;
+        std::uint64_t const next = next_record (data.data (), hdr.data_size,
+            pos);
+        if (next - pos > hdr.data_size - phys || next > hdr.head)
+        {
+            loglog.error (LOG4CPLUS_TEXT ("Corrupted record in ring file ")
+                + filename);
+            return false;
+        }
+
+        if (hdr.data_size - phys >= sizeof (RingRecordHeader))
+        {
+            RingRecordHeader rec;
+            std::memcpy (&rec, data.data () + phys, sizeof (rec));
+            if (rec.type == RingRecordHeader::RTEvent)
+                func (rec, std::string_view (
+                    reinterpret_cast<char const *>(data.data ()) + phys
+                    + sizeof (rec), rec.size));
+        }
+
+        pos = next;
+    }
+
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RingFileAppender ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+RingFileAppender::RingFileAppender(const tstring& filename_,
+    std::size_t size, bool createDirs_)
+    : filename (filename_)
+    , dataSize (size)
+    , createDirs (createDirs_)
+    , mapping (nullptr)
+    , mappingSize (0)
+    , header (nullptr)
+    , data (nullptr)
+{
+    init ();
+}
+
+
+RingFileAppender::RingFileAppender(const helpers::Properties& properties)
+    : Appender (properties)
+    , dataSize (16 * 1024 * 1024)
+    , createDirs (false)
+    , mapping (nullptr)
+    , mappingSize (0)
+    , header (nullptr)
+    , data (nullptr)
+{
+    filename = properties.getProperty (LOG4CPLUS_TEXT ("File"));
+    properties.getBool (createDirs, LOG4CPLUS_TEXT ("CreateDirs"));
+
+    tstring tmp (
+        helpers::toUpper (
+            properties.getProperty (LOG4CPLUS_TEXT ("Size"))));
+    if (! tmp.empty ())
+    {
+        dataSize = std::strtoul (LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str (),
+            nullptr, 10);
+        tstring::size_type const len = tmp.length ();
+        if (len > 2
+            && tmp.compare (len - 2, 2, LOG4CPLUS_TEXT ("MB")) == 0)
+            dataSize *= 1024 * 1024;
+        else if (len > 2
+            && tmp.compare (len - 2, 2, LOG4CPLUS_TEXT ("KB")) == 0)
+            dataSize *= 1024;
+    }
+
+    init ();
+}
+
+
+RingFileAppender::~RingFileAppender()
+{
+    destructorImpl ();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RingFileAppender public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+RingFileAppender::close()
+{
+    thread::MutexGuard guard (access_mutex);
+
+#if defined (LOG4CPLUS_USE_MMAP_RING_FILE)
+    if (mapping)
+        ::munmap (mapping, mappingSize);
+#endif
+
+    mapping = nullptr;
+    header = nullptr;
+    data = nullptr;
+    closed = true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RingFileAppender protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+RingFileAppender::init()
+{
+    helpers::LogLog & loglog = helpers::getLogLog ();
+
+    if (dataSize < minimum_ring_data_size)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("RingFileAppender: Size property")
+            LOG4CPLUS_TEXT (" value is too small. Resetting to ")
+            << minimum_ring_data_size << ".";
+        loglog.warn (oss.str ());
+        dataSize = minimum_ring_data_size;
+    }
+    dataSize = static_cast<std::size_t>(align_record (dataSize));
+
+#if defined (LOG4CPLUS_USE_MMAP_RING_FILE)
+    if (createDirs)
+        internal::make_dirs (filename);
+
+    std::string const name = LOG4CPLUS_TSTRING_TO_STRING (filename);
+    int flags = O_RDWR | O_CREAT;
+#if defined (O_CLOEXEC)
+    flags |= O_CLOEXEC;
+#endif
+    int const fd = ::open (name.c_str (), flags, 0666);
+    if (fd == -1)
+    {
+        getErrorHandler ()->error (LOG4CPLUS_TEXT ("Unable to open file: ")
+            + filename);
+        return;
+    }
+
+    mappingSize = ring_file_header_size + dataSize;
+
+    struct stat st;
+    bool const resize = ::fstat (fd, &st) != 0
+        || static_cast<std::size_t>(st.st_size) != mappingSize;
+    int ret = 0;
+    if (resize)
+    {
+        ret = ::ftruncate (fd, 0);
+        if (ret == 0)
+            ret = ::ftruncate (fd, static_cast<off_t>(mappingSize));
+#if defined (_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+        // Allocate the blocks up front so that writes into the mapping
+        // cannot fail for lack of space with SIGBUS.
+        if (ret == 0)
+            ret = ::posix_fallocate (fd, 0,
+                static_cast<off_t>(mappingSize));
+#endif
+    }
+
+    void * addr = MAP_FAILED;
+    if (ret == 0)
+        addr = ::mmap (nullptr, mappingSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    ::close (fd);
+
+    if (addr == MAP_FAILED)
+    {
+        getErrorHandler ()->error (LOG4CPLUS_TEXT ("Unable to map file: ")
+            + filename);
+        return;
+    }
+
+    mapping = addr;
+    header = static_cast<RingFileHeader *>(mapping);
+    data = static_cast<unsigned char *>(mapping) + ring_file_header_size;
+
+    if (! resize
+        && std::memcmp (header->magic, ring_file_magic,
+            sizeof (header->magic)) == 0
+        && header->version == ring_file_version
+        && header->header_size == ring_file_header_size
+        && header->data_size == dataSize
+        && header->tail <= header->head
+        && header->head - header->tail <= dataSize)
+    {
+        loglog.debug (LOG4CPLUS_TEXT ("Appending to ring file: ")
+            + filename);
+        return;
+    }
+
+    RingFileHeader hdr {};
+    std::memcpy (hdr.magic, ring_file_magic, sizeof (hdr.magic));
+    hdr.version = ring_file_version;
+    hdr.header_size = ring_file_header_size;
+    hdr.data_size = dataSize;
+    *header = hdr;
+    loglog.debug (LOG4CPLUS_TEXT ("Initialized ring file: ") + filename);
+
+#else
+    getErrorHandler ()->error (
+        LOG4CPLUS_TEXT ("RingFileAppender is not supported on this platform"));
+
+#endif
+}
+
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+RingFileAppender::append(const spi::InternalLoggingEvent& event)
+{
+    if (! header)
+    {
+        getErrorHandler ()->error (LOG4CPLUS_TEXT ("file is not open: ")
+            + filename);
+        return;
+    }
+
+    tstring const & str = formatEvent (event);
+    std::string const & bytes = LOG4CPLUS_TSTRING_TO_STRING (str);
+
+    // Keep each record well below the capacity so that a single record
+    // does not evict the whole ring.
+    std::size_t const payload = (std::min) (bytes.size (),
+        dataSize / 4 - sizeof (RingRecordHeader));
+    std::uint64_t const size = align_record (
+        sizeof (RingRecordHeader) + payload);
+
+    std::uint64_t head = header->head;
+    std::uint64_t phys = head % dataSize;
+    std::uint64_t const left = dataSize - phys;
+    if (left < size)
+    {
+        // The record does not fit before the end of the data area.
+        // Cover the rest of it with padding and start at the beginning.
+        reserve (head + left);
+        if (left >= sizeof (RingRecordHeader))
+        {
+            RingRecordHeader pad {};
+            pad.size = static_cast<std::uint32_t>(
+                left - sizeof (RingRecordHeader));
+            pad.type = RingRecordHeader::RTPadding;
+            std::memcpy (data + phys, &pad, sizeof (pad));
+        }
+
+        head += left;
+        phys = 0;
+    }
+
+    reserve (head + size);
+
+    RingRecordHeader rec;
+    rec.size = static_cast<std::uint32_t>(payload);
+    rec.type = RingRecordHeader::RTEvent;
+    rec.sequence = header->sequence++;
+    rec.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+        event.getTimestamp ().time_since_epoch ()).count ();
+    std::memcpy (data + phys, &rec, sizeof (rec));
+    std::memcpy (data + phys + sizeof (rec), bytes.data (), payload);
+
+    // Publish the record only after it has been completely written.
+    store_position (header->head, head + size);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RingFileAppender private methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+RingFileAppender::reserve(std::uint64_t end)
+{
+    std::uint64_t tail = load_position (header->tail);
+    std::uint64_t const head = header->head;
+    if (tail + dataSize >= end)
+        return;
+
+    while (tail < head && tail + dataSize < end)
+        tail = next_record (data, dataSize, tail);
+
+    // Records are dropped before they are overwritten so that the range
+    // from tail to head stays intact even if the process crashes while
+    // writing.
+    store_position (header->tail, tail);
+}
+
+
+} // namespace log4cplus
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && defined (LOG4CPLUS_USE_MMAP_RING_FILE)
+namespace log4cplus
+{
+
+CATCH_TEST_CASE ("RingFileAppender", "[appender]")
+{
+    tstring const file_name (LOG4CPLUS_TEXT ("ringfileappender_test.ring"));
+    std::remove (LOG4CPLUS_TSTRING_TO_STRING (file_name).c_str ());
+
+    auto log_events = [&] (std::size_t first, std::size_t count) {
+        SharedAppenderPtr appender (new RingFileAppender (file_name,
+            minimum_ring_data_size));
+        appender->setLayout (std::unique_ptr<Layout> (
+            new PatternLayout (LOG4CPLUS_TEXT ("%m"))));
+        for (std::size_t i = first; i != first + count; ++i)
+        {
+            // Vary record sizes so that padding at the end of the data
+            // area is exercised.
+            tstring const msg = helpers::convertIntegerToString (i)
+                + tstring (i % 97, LOG4CPLUS_TEXT ('x'));
+            appender->doAppend (spi::InternalLoggingEvent (
+                LOG4CPLUS_TEXT ("test"), INFO_LOG_LEVEL, msg,
+                __FILE__, __LINE__));
+        }
+        appender->close ();
+    };
+
+    auto read_events = [&] (std::vector<std::string> & msgs,
+        std::vector<std::uint64_t> & seqs) {
+        return readRingFile (file_name,
+            [&] (RingRecordHeader const & rec, std::string_view msg) {
+                seqs.push_back (rec.sequence);
+                msgs.emplace_back (msg);
+            });
+    };
+
+    CATCH_SECTION ("without wrapping")
+    {
+        log_events (0, 100);
+
+        std::vector<std::string> msgs;
+        std::vector<std::uint64_t> seqs;
+        CATCH_REQUIRE (read_events (msgs, seqs));
+        CATCH_REQUIRE (msgs.size () == 100);
+        CATCH_REQUIRE (seqs.front () == 0);
+        CATCH_REQUIRE (msgs[42] == "42" + std::string (42, 'x'));
+    }
+
+    CATCH_SECTION ("wrapping and reopening")
+    {
+        std::size_t const total = 20000;
+        log_events (0, total / 2);
+        log_events (total / 2, total / 2);
+
+        std::vector<std::string> msgs;
+        std::vector<std::uint64_t> seqs;
+        CATCH_REQUIRE (read_events (msgs, seqs));
+        CATCH_REQUIRE (! msgs.empty ());
+        CATCH_REQUIRE (msgs.size () < total);
+        CATCH_REQUIRE (seqs.back () == total - 1);
+        for (std::size_t i = 0; i != seqs.size (); ++i)
+        {
+            std::size_t const n = total - seqs.size () + i;
+            CATCH_REQUIRE (seqs[i] == n);
+            CATCH_REQUIRE (msgs[i] == std::to_string (n)
+                + std::string (n % 97, 'x'));
+        }
+    }
+
+    std::remove (LOG4CPLUS_TSTRING_TO_STRING (file_name).c_str ());
+}
+
+} // namespace log4cplus
+#endif
@@ -59,6 +59,7 @@ SocketAppender::SocketAppender(const helpers::Properties & properties)
     properties.getUInt (port, LOG4CPLUS_TEXT("port"));
     serverName = properties.getProperty( LOG4CPLUS_TEXT("ServerName") );
     properties.getBool(ipv6, LOG4CPLUS_TEXT("IPv6"));
+    spool.configure (properties);
 
     openSocket();
     initConnector ();
@@ -121,22 +122,29 @@ void
 SocketAppender::append(const spi::InternalLoggingEvent& event)
 {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    if (! connected)
+    bool const spooling = ! connected;
+    if (spooling)
     {
         connector->trigger ();
-        return;
+        if (! spool.enabled ())
+            return;
     }
 
 #else
+    bool spooling = false;
     if(!socket.isOpen()) {
         openSocket();
         if(!socket.isOpen()) {
             helpers::getLogLog().error(
                 LOG4CPLUS_TEXT(
                     "SocketAppender::append()- Cannot connect to server"));
-            return;
+            if (! spool.enabled ())
+                return;
+            spooling = true;
         }
     }
+    if (! spooling && ! spool.empty ())
+        spooling = ! replaySpool ();
 #endif
 
     helpers::SocketBuffer msgBuffer(LOG4CPLUS_MAX_MESSAGE_SIZE
@@ -154,21 +162,55 @@ SocketAppender::append(const spi::InternalLoggingEvent& event)
     helpers::SocketBuffer buffer(sizeof(unsigned int));
     buffer.appendInt(static_cast<unsigned>(msgBuffer.getSize()));
 
-    bool ret = helpers::Socket::write(socket, buffer, msgBuffer);
+    bool ret = ! spooling
+        && helpers::Socket::write(socket, buffer, msgBuffer);
     if (! ret)
     {
-        helpers::getLogLog().error(
-            LOG4CPLUS_TEXT(
-                "SocketAppender::append()- Write failed"));
+        if (! spooling)
+            helpers::getLogLog().error(
+                LOG4CPLUS_TEXT(
+                    "SocketAppender::append()- Write failed"));
+
+        if (spool.enabled ())
+        {
+            std::string & record = internal::get_appender_sp ().chstr;
+            record.assign (buffer.getBuffer (), buffer.getSize ());
+            record.append (msgBuffer.getBuffer (), msgBuffer.getSize ());
+            spool.push (record);
+        }
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-        connected = false;
-        connector->trigger ();
+        if (! spooling)
+        {
+            connected = false;
+            connector->trigger ();
+        }
 #endif
     }
 }
 
 
+bool
+SocketAppender::replaySpool ()
+{
+    return spool.replay (access_mutex,
+        [this] (std::vector<std::string> const & records)
+        {
+            std::string & data = internal::get_appender_sp ().chstr;
+            data.clear ();
+            for (std::string const & record : records)
+                data += record;
+            return socket.write (data);
+        },
+        [this]
+        {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+            ctcSetConnected ();
+#endif
+        });
+}
+
+
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
 thread::Mutex const &
 SocketAppender::ctcGetAccessMutex () const
@@ -196,6 +238,13 @@ SocketAppender::ctcSetConnected ()
     connected = true;
 }
 
+
+bool
+SocketAppender::ctcReplay ()
+{
+    return replaySpool ();
+}
+
 #endif
 
 
@@ -0,0 +1,524 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Haisman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/spool.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/internal/env.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#endif
+
+namespace log4cplus {
+
+namespace helpers {
+
+//! Maximal size of batch of records passed to write callback by replay().
+static std::size_t const replay_batch_size = 64 * 1024;
+
+//! Minimal size of segment file before the next segment is started.
+static std::uintmax_t const min_segment_size = 64 * 1024;
+
+
+static
+std::uintmax_t
+parse_size (tstring const & value)
+{
+    tstring const tmp (toUpper (value));
+    std::uintmax_t size = std::strtoull (
+        LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str (), nullptr, 10);
+    tstring::size_type const len = tmp.length ();
+    if (len > 2
+        && tmp.compare (len - 2, 2, LOG4CPLUS_TEXT ("MB")) == 0)
+        size *= 1024 * 1024;
+    else if (len > 2
+        && tmp.compare (len - 2, 2, LOG4CPLUS_TEXT ("KB")) == 0)
+        size *= 1024;
+    return size;
+}
+
+
+Spool::Spool ()
+    : memoryLimit (0)
+    , memoryBytes (0)
+    , fileLimit (64 * 1024 * 1024)
+    , fileBytes (0)
+    , readPos (0)
+    , peekedMemory (0)
+    , peekedFileEnd (0)
+    , drops (0)
+{ }
+
+
+Spool::~Spool () = default;
+
+
+void
+Spool::configure (Properties const & properties)
+{
+    tstring const size = properties.getProperty (
+        LOG4CPLUS_TEXT ("SpoolSize"));
+    if (! size.empty ())
+        memoryLimit = static_cast<std::size_t>(parse_size (size));
+
+    tstring const file_size = properties.getProperty (
+        LOG4CPLUS_TEXT ("SpoolFileSize"));
+    if (! file_size.empty ())
+        fileLimit = parse_size (file_size);
+
+    filePrefix = properties.getProperty (LOG4CPLUS_TEXT ("SpoolFile"));
+    if (filePrefix.empty ())
+        return;
+
+    internal::make_dirs (filePrefix);
+
+    // Pick up segments left by previous run.
+    std::filesystem::path const prefix (filePrefix);
+    std::filesystem::path dir (prefix.parent_path ());
+    if (dir.empty ())
+        dir = std::filesystem::path (".");
+    std::string const base (prefix.filename ().string () + ".");
+
+    std::error_code ec;
+    for (auto const & entry : std::filesystem::directory_iterator (dir, ec))
+    {
+        std::string const name (entry.path ().filename ().string ());
+        if (name.size () <= base.size () || ! name.starts_with (base)
+            || ! std::all_of (name.begin () + base.size (), name.end (),
+                [] (char ch) { return ch >= '0' && ch <= '9'; }))
+            continue;
+
+        std::uintmax_t const segment_size = entry.file_size (ec);
+        if (ec)
+            continue;
+
+        segments.push_back (Segment {
+            std::strtoul (name.c_str () + base.size (), nullptr, 10),
+            segment_size});
+        fileBytes += segment_size;
+    }
+
+    std::sort (segments.begin (), segments.end (),
+        [] (Segment const & a, Segment const & b)
+        { return a.index < b.index; });
+
+    if (! segments.empty ())
+        getLogLog ().debug (LOG4CPLUS_TEXT ("Found ")
+            + convertIntegerToString (segments.size ())
+            + LOG4CPLUS_TEXT (" spool file(s) ") + filePrefix
+            + LOG4CPLUS_TEXT (".*"));
+}
+
+
+bool
+Spool::enabled () const
+{
+    return memoryLimit != 0 || ! filePrefix.empty ();
+}
+
+
+bool
+Spool::empty () const
+{
+    return memory.empty () && segments.empty ();
+}
+
+
+bool
+Spool::push (std::string_view record)
+{
+    if (! enabled ())
+        return false;
+
+    // Records are kept in memory only while there are no older records
+    // on disk so that they are replayed in order.
+    if (segments.empty () && memoryBytes + record.size () <= memoryLimit)
+    {
+        memory.emplace_back (record);
+        memoryBytes += record.size ();
+        return true;
+    }
+
+    if (! filePrefix.empty ()
+        && fileBytes + sizeof (std::uint32_t) + record.size () <= fileLimit
+        && write (record))
+        return true;
+
+    ++drops;
+    return false;
+}
+
+
+bool
+Spool::replay (thread::Mutex const & mutex,
+    std::function<bool (std::vector<std::string> const &)> const & write_,
+    std::function<void ()> const & done)
+{
+    std::vector<std::string> records;
+    while (true)
+    {
+        {
+            thread::MutexGuard guard (mutex);
+
+            if (drops != 0)
+            {
+                getLogLog ().warn (LOG4CPLUS_TEXT ("Spool dropped ")
+                    + convertIntegerToString (drops)
+                    + LOG4CPLUS_TEXT (" record(s)"));
+                drops = 0;
+            }
+
+            // Damaged or empty segments yield no records.
+            peek (records, replay_batch_size);
+            while (records.empty () && ! empty ())
+            {
+                pop ();
+                peek (records, replay_batch_size);
+            }
+
+            if (records.empty ())
+            {
+                done ();
+                return true;
+            }
+        }
+
+        // The batch is written without the mutex so that producers are
+        // not blocked by a slow connection.
+        if (! write_ (records))
+            return false;
+
+        {
+            thread::MutexGuard guard (mutex);
+            pop ();
+        }
+    }
+}
+
+
+std::size_t
+Spool::getDropCount () const
+{
+    return drops;
+}
+
+
+tstring
+Spool::segmentName (unsigned long index) const
+{
+    return filePrefix + LOG4CPLUS_TEXT (".") + convertIntegerToString (index);
+}
+
+
+bool
+Spool::write (std::string_view record)
+{
+    if (record.size () > (std::numeric_limits<std::uint32_t>::max) ())
+        return false;
+
+    LogLog & loglog = getLogLog ();
+    std::uintmax_t const segment_limit
+        = (std::max) (fileLimit / 8, min_segment_size);
+    if (! writer.is_open () || segments.back ().size >= segment_limit)
+    {
+        writer.close ();
+        writer.clear ();
+
+        unsigned long const index
+            = segments.empty () ? 1 : segments.back ().index + 1;
+        tstring const name (segmentName (index));
+        writer.open (std::filesystem::path (name),
+            std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+        if (! writer)
+        {
+            loglog.error (LOG4CPLUS_TEXT ("Failed to open spool file ")
+                + name);
+            writer.close ();
+            writer.clear ();
+            return false;
+        }
+
+        segments.push_back (Segment {index, 0});
+    }
+
+    std::uint32_t const size = static_cast<std::uint32_t>(record.size ());
+    writer.write (reinterpret_cast<char const *>(&size), sizeof (size));
+    writer.write (record.data (), static_cast<std::streamsize>(record.size ()));
+    writer.flush ();
+
+    Segment & segment = segments.back ();
+    if (! writer)
+    {
+        tstring const name (segmentName (segment.index));
+        loglog.error (LOG4CPLUS_TEXT ("Failed to write spool file ")
+            + name);
+        writer.close ();
+        writer.clear ();
+
+        // Partially written record is skipped by the reader.
+        std::error_code ec;
+        std::uintmax_t const segment_size
+            = std::filesystem::file_size (std::filesystem::path (name), ec);
+        if (! ec)
+        {
+            fileBytes += segment_size - segment.size;
+            segment.size = segment_size;
+        }
+        return false;
+    }
+
+    segment.size += sizeof (size) + record.size ();
+    fileBytes += sizeof (size) + record.size ();
+    return true;
+}
+
+
+void
+Spool::peek (std::vector<std::string> & records, std::size_t maxBytes)
+{
+    records.clear ();
+    peekedMemory = 0;
+    peekedFileEnd = readPos;
+    std::size_t bytes = 0;
+
+    for (std::string const & record : memory)
+    {
+        if (! records.empty () && bytes + record.size () > maxBytes)
+            return;
+
+        records.push_back (record);
+        bytes += record.size ();
+        ++peekedMemory;
+    }
+
+    if (segments.empty ())
+        return;
+
+    Segment const & segment = segments.front ();
+    tstring const name (segmentName (segment.index));
+    std::ifstream in (std::filesystem::path (name), std::ios_base::binary);
+    in.seekg (static_cast<std::streamoff>(readPos));
+
+    std::string record;
+    while (peekedFileEnd < segment.size)
+    {
+        std::uint32_t size = 0;
+        in.read (reinterpret_cast<char *>(&size), sizeof (size));
+        bool damaged = ! in
+            || peekedFileEnd + sizeof (size) + size > segment.size;
+        if (! damaged)
+        {
+            if (! records.empty () && bytes + size > maxBytes)
+                return;
+
+            record.resize (size);
+            in.read (record.data (), size);
+            damaged = ! in;
+        }
+
+        if (damaged)
+        {
+            // This can be the result of a crash while the record was
+            // being written. Skip the rest of the segment.
+            getLogLog ().warn (LOG4CPLUS_TEXT ("Skipping damaged spool file ")
+                + name);
+            peekedFileEnd = segment.size;
+            return;
+        }
+
+        records.push_back (std::move (record));
+        bytes += size;
+        peekedFileEnd += sizeof (size) + size;
+    }
+}
+
+
+void
+Spool::pop ()
+{
+    for (; peekedMemory != 0; --peekedMemory)
+    {
+        memoryBytes -= memory.front ().size ();
+        memory.pop_front ();
+    }
+
+    if (segments.empty ())
+        return;
+
+    fileBytes -= peekedFileEnd - readPos;
+    readPos = peekedFileEnd;
+    if (readPos < segments.front ().size)
+        return;
+
+    // The first segment has been replayed completely. If it is also the
+    // last one, the next record will start a new segment.
+    if (segments.size () == 1)
+    {
+        writer.close ();
+        writer.clear ();
+    }
+
+    std::error_code ec;
+    std::filesystem::remove (
+        std::filesystem::path (segmentName (segments.front ().index)), ec);
+    segments.pop_front ();
+    readPos = 0;
+    peekedFileEnd = 0;
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Spool", "[spool]")
+{
+    std::filesystem::path const dir ("spool_test");
+    tstring const prefix (LOG4CPLUS_TEXT ("spool_test/spool"));
+    std::error_code ec;
+    std::filesystem::remove_all (dir, ec);
+
+    thread::Mutex mutex;
+
+    // Each record is 9 bytes long.
+    auto make_record = [] (std::size_t i) {
+        std::string record ("record-00");
+        record[7] = static_cast<char>('0' + i / 10);
+        record[8] = static_cast<char>('0' + i % 10);
+        return record;
+    };
+
+    std::vector<std::string> replayed;
+    auto collect = [&] (std::vector<std::string> const & records) {
+        replayed.insert (replayed.end (), records.begin (), records.end ());
+        return true;
+    };
+
+    bool connected = false;
+    auto done = [&] { connected = true; };
+
+    auto require_replayed = [&] (std::size_t first, std::size_t last) {
+        CATCH_REQUIRE (replayed.size () == last - first);
+        for (std::size_t i = first; i != last; ++i)
+            CATCH_REQUIRE (replayed[i - first] == make_record (i));
+    };
+
+    Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("SpoolSize"), LOG4CPLUS_TEXT ("100"));
+
+    CATCH_SECTION ("disabled")
+    {
+        Spool spool;
+        spool.configure (Properties ());
+        CATCH_REQUIRE (! spool.enabled ());
+        CATCH_REQUIRE (! spool.push (make_record (0)));
+        CATCH_REQUIRE (spool.getDropCount () == 0);
+        CATCH_REQUIRE (spool.replay (mutex, collect, done));
+        CATCH_REQUIRE (connected);
+    }
+
+    CATCH_SECTION ("memory")
+    {
+        Spool spool;
+        spool.configure (props);
+        for (std::size_t i = 0; i != 20; ++i)
+            CATCH_REQUIRE (spool.push (make_record (i)) == (i < 11));
+        CATCH_REQUIRE (spool.getDropCount () == 9);
+
+        CATCH_REQUIRE (spool.replay (mutex, collect, done));
+        CATCH_REQUIRE (connected);
+        CATCH_REQUIRE (spool.empty ());
+        CATCH_REQUIRE (spool.getDropCount () == 0);
+        require_replayed (0, 11);
+    }
+
+    props.setProperty (LOG4CPLUS_TEXT ("SpoolFile"), prefix);
+    props.setProperty (LOG4CPLUS_TEXT ("SpoolFileSize"),
+        LOG4CPLUS_TEXT ("1KB"));
+
+    CATCH_SECTION ("file")
+    {
+        Spool spool;
+        spool.configure (props);
+        for (std::size_t i = 0; i != 50; ++i)
+            CATCH_REQUIRE (spool.push (make_record (i)));
+
+        // Failed write keeps the batch in the spool.
+        CATCH_REQUIRE (! spool.replay (mutex,
+            [] (std::vector<std::string> const &) { return false; }, done));
+        CATCH_REQUIRE (! connected);
+        CATCH_REQUIRE (! spool.empty ());
+
+        CATCH_REQUIRE (spool.replay (mutex, collect, done));
+        CATCH_REQUIRE (connected);
+        CATCH_REQUIRE (spool.empty ());
+        require_replayed (0, 50);
+        CATCH_REQUIRE (std::filesystem::is_empty (dir));
+    }
+
+    CATCH_SECTION ("file limit")
+    {
+        Spool spool;
+        spool.configure (props);
+        // 11 records fit into memory and 78 records of 13 bytes
+        // including the length into the file.
+        for (std::size_t i = 0; i != 99; ++i)
+            CATCH_REQUIRE (spool.push (make_record (i)) == (i < 89));
+        CATCH_REQUIRE (spool.getDropCount () == 10);
+
+        CATCH_REQUIRE (spool.replay (mutex, collect, done));
+        require_replayed (0, 89);
+    }
+
+    CATCH_SECTION ("previous run")
+    {
+        {
+            Spool spool;
+            spool.configure (props);
+            for (std::size_t i = 0; i != 50; ++i)
+                CATCH_REQUIRE (spool.push (make_record (i)));
+        }
+
+        // Records kept in memory are lost, those in the file are not.
+        Spool spool;
+        spool.configure (props);
+        CATCH_REQUIRE (! spool.empty ());
+        CATCH_REQUIRE (spool.push (make_record (50)));
+
+        CATCH_REQUIRE (spool.replay (mutex, collect, done));
+        require_replayed (11, 51);
+        CATCH_REQUIRE (std::filesystem::is_empty (dir));
+    }
+
+    std::filesystem::remove_all (dir, ec);
+}
+#endif
+
+} // namespace helpers
+
+} // namespace log4cplus
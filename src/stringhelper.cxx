@@ -240,6 +240,37 @@ toLower(const tstring_view& s)
 }
 
 
+tstring_handle
+makeStringHandle (const tstring_view& s)
+{
+    return std::make_shared<tstring const> (s);
+}
+
+
+tstring_handle const &
+getEmptyStringHandle ()
+{
+    // Aliasing constructor with empty owner gives non-owning handle.
+    static tstring_handle const empty_handle (std::shared_ptr<void> (),
+        &internal::empty_str);
+    return empty_handle;
+}
+
+
+void
+assignStringHandle (tstring_handle & handle, const tstring_view& s)
+{
+    // Consecutive events mostly carry the same logger and thread
+    // names, keep sharing the string then.
+    if (handle && *handle == s)
+        return;
+    else if (s.empty ())
+        handle = getEmptyStringHandle ();
+    else
+        handle = makeStringHandle (s);
+}
+
+
 #if defined (LOG4CPLUS_WITH_UNIT_TESTS)
 
 namespace
@@ -277,6 +308,27 @@ CATCH_TEST_CASE( "Strings helpers", "[strings]" )
         CATCH_REQUIRE (internal::empty_str.empty ());
     }
 
+    CATCH_SECTION ("assignStringHandle")
+    {
+        tstring_handle handle = makeStringHandle (LOG4CPLUS_TEXT ("a"));
+        tstring const * const a = handle.get ();
+
+        assignStringHandle (handle, LOG4CPLUS_TEXT ("a"));
+        CATCH_REQUIRE (handle.get () == a);
+
+        assignStringHandle (handle, LOG4CPLUS_TEXT ("b"));
+        CATCH_REQUIRE (handle.get () != a);
+        CATCH_REQUIRE (*handle == LOG4CPLUS_TEXT ("b"));
+
+        tstring_handle const copy = handle;
+        assignStringHandle (handle, LOG4CPLUS_TEXT ("c"));
+        CATCH_REQUIRE (*copy == LOG4CPLUS_TEXT ("b"));
+        CATCH_REQUIRE (*handle == LOG4CPLUS_TEXT ("c"));
+
+        assignStringHandle (handle, LOG4CPLUS_TEXT (""));
+        CATCH_REQUIRE (handle == getEmptyStringHandle ());
+    }
+
     CATCH_SECTION ("tokenize")
     {
         std::vector<tstring> tokens;
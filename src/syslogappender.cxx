@@ -26,6 +26,7 @@
 #include <log4cplus/internal/internal.h>
 #include <log4cplus/internal/env.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
 #include <cstring>
 
 #if defined (LOG4CPLUS_HAVE_SYSLOG_H)
@@ -212,13 +213,25 @@ parseFacility (const tstring& text)
 
 
 static
-tstring
-substrOrNil(tstring const & str, tstring::size_type const limit)
+void
+appendSubstrOrNil(tstring & result, tstring const & str,
+    tstring::size_type const limit)
 {
     if (str.empty ())
-        return tstring (LOG4CPLUS_TEXT ("-"));
+        result += LOG4CPLUS_TEXT ('-');
     else
-        return str.substr (0, limit);
+        result.append (str, 0, limit);
+}
+
+
+template <std::integral intType>
+static
+void
+appendInteger(tstring & result, intType value)
+{
+    tstring & tmp = internal::get_ptd ()->faa_str;
+    helpers::convertIntegerToString (tmp, value);
+    result += tmp;
 }
 
 } // namespace
@@ -292,6 +305,7 @@ SysLogAppender::SysLogAppender(const helpers::Properties & properties)
             port = 514;
 
         appendFunc = &SysLogAppender::appendRemote;
+        spool.configure (properties);
         openSocket ();
         initConnector ();
     }
@@ -336,6 +350,14 @@ SysLogAppender::close()
 {
     helpers::getLogLog().debug(
         LOG4CPLUS_TEXT("Entering SysLogAppender::close()..."));
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // The connector thread takes access_mutex when it replays the
+    // spool, it has to be terminated before the mutex is taken here.
+    if (connector)
+        connector->terminate ();
+#endif
+
     thread::MutexGuard guard (access_mutex);
 
     if (host.empty ())
@@ -347,11 +369,6 @@ SysLogAppender::close()
     else
         syslogSocket.close ();
 
-#if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    if (connector)
-        connector->terminate ();
-#endif
-
     closed = true;
 }
 
@@ -398,12 +415,9 @@ void
 SysLogAppender::appendLocal(const spi::InternalLoggingEvent& event)
 {
     int const level = getSysLogLevel(event.getLogLevel());
-    internal::appender_sratch_pad & appender_sp = internal::get_appender_sp ();
-    detail::clear_tostringstream (appender_sp.oss);
-    layout->formatAndAppend(appender_sp.oss, event);
-    appender_sp.str = appender_sp.oss.str ();
+    tstring const & str = formatEvent (event);
     ::syslog(facility | level, "%s",
-        LOG4CPLUS_TSTRING_TO_STRING(appender_sp.str).c_str());
+        LOG4CPLUS_TSTRING_TO_STRING(str).c_str());
 }
 
 #endif
@@ -416,12 +430,13 @@ tstring const SysLogAppender::remoteTimeFormat (
 void
 SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
 {
-
-    if (! connected)
+    bool spooling = ! connected;
+    if (spooling)
     {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
         connector->trigger ();
-        return;
+        if (! spool.enabled ())
+            return;
 
 #else
         openSocket ();
@@ -432,40 +447,54 @@ SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
                 LOG4CPLUS_TEXT ("- failed to connect to ")
                 + host + LOG4CPLUS_TEXT (":")
                 + helpers::convertIntegerToString (port));
-            return;
+            if (! spool.enabled ())
+                return;
         }
+        else
+            spooling = false;
 #endif
     }
 
+#if defined (LOG4CPLUS_SINGLE_THREADED)
+    if (! spooling && ! spool.empty ())
+        spooling = ! replaySpool ();
+#endif
+
     int const level = getSysLogLevel(event.getLogLevel());
     internal::appender_sratch_pad & appender_sp = internal::get_appender_sp ();
-    detail::clear_tostringstream (appender_sp.oss);
-
-    appender_sp.oss
-        // PRI
-        << LOG4CPLUS_TEXT ('<') << (level | facility) << LOG4CPLUS_TEXT ('>')
-        // VERSION
-        << 1
-        // TIMESTAMP
-        << LOG4CPLUS_TEXT (' ')
-        << helpers::getFormattedTime (remoteTimeFormat, event.getTimestamp (),
-            true)
-        // HOSTNAME
-        << LOG4CPLUS_TEXT (' ') << substrOrNil (hostname, 255)
-        // APP-NAME
-        << LOG4CPLUS_TEXT (' ') << substrOrNil (ident, 48)
-        // PROCID
-        << LOG4CPLUS_TEXT (' ') << internal::get_process_id ()
-        // MSGID
-        << LOG4CPLUS_TEXT (' ') << substrOrNil (event.getLoggerName (), 32)
-        // STRUCTURED-DATA
-        // no structured data, it could be whole MDC
-        << LOG4CPLUS_TEXT (" - ");
+    tstring & str = appender_sp.str;
+    str.clear ();
+
+    // PRI
+    str += LOG4CPLUS_TEXT ('<');
+    appendInteger (str, level | facility);
+    str += LOG4CPLUS_TEXT ('>');
+    // VERSION
+    str += LOG4CPLUS_TEXT ('1');
+    // TIMESTAMP
+    str += LOG4CPLUS_TEXT (' ');
+    helpers::appendFormattedTime (str, remoteTimeFormat,
+        event.getTimestamp (), true);
+    // HOSTNAME
+    str += LOG4CPLUS_TEXT (' ');
+    appendSubstrOrNil (str, hostname, 255);
+    // APP-NAME
+    str += LOG4CPLUS_TEXT (' ');
+    appendSubstrOrNil (str, ident, 48);
+    // PROCID
+    str += LOG4CPLUS_TEXT (' ');
+    appendInteger (str, internal::get_process_id ());
+    // MSGID
+    str += LOG4CPLUS_TEXT (' ');
+    appendSubstrOrNil (str, event.getLoggerName (), 32);
+    // STRUCTURED-DATA
+    // no structured data, it could be whole MDC
+    str += LOG4CPLUS_TEXT (" - ");
 
     // MSG
-    layout->formatAndAppend (appender_sp.oss, event);
+    layout->formatInto (str, event);
 
-    appender_sp.chstr = LOG4CPLUS_TSTRING_TO_STRING (appender_sp.oss.str ());
+    appender_sp.chstr = LOG4CPLUS_TSTRING_TO_STRING (str);
 
     if (remoteSyslogType != RSTUdp)
     {
@@ -478,6 +507,12 @@ SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
             syslogFrameHeader.begin (), syslogFrameHeader.end ());
     }
 
+    if (spooling)
+    {
+        spool.push (appender_sp.chstr);
+        return;
+    }
+
     bool ret = syslogSocket.write (appender_sp.chstr);
     if (! ret)
     {
@@ -486,6 +521,7 @@ SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
             LOG4CPLUS_TEXT ("- socket write failed"));
 
         connected = false;
+        spool.push (appender_sp.chstr);
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
         connector->trigger ();
@@ -494,6 +530,28 @@ SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
 }
 
 
+bool
+SysLogAppender::replaySpool ()
+{
+    return spool.replay (access_mutex,
+        [this] (std::vector<std::string> const & records)
+        {
+            // Each UDP message has to be sent as separate datagram.
+            if (remoteSyslogType == RSTUdp)
+                return std::all_of (records.begin (), records.end (),
+                    [this] (std::string const & record)
+                    { return syslogSocket.write (record); });
+
+            std::string & data = internal::get_appender_sp ().chstr;
+            data.clear ();
+            for (std::string const & record : records)
+                data += record;
+            return syslogSocket.write (data);
+        },
+        [this] { connected = true; });
+}
+
+
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
 thread::Mutex const &
 SysLogAppender::ctcGetAccessMutex () const
@@ -523,6 +581,13 @@ SysLogAppender::ctcSetConnected ()
     connected = true;
 }
 
+
+bool
+SysLogAppender::ctcReplay ()
+{
+    return replaySpool ();
+}
+
 #endif
 
 
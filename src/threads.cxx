@@ -92,31 +92,32 @@ yield()
 }
 
 #if defined(LOG4CPLUS_SINGLE_THREADED)
-static log4cplus::tstring thread_name
+static log4cplus::tstring_handle thread_name
     LOG4CPLUS_INIT_PRIORITY (LOG4CPLUS_INIT_PRIORITY_BASE - 1)
-    (LOG4CPLUS_TEXT("single"));
-static log4cplus::tstring thread_name2
+    (helpers::makeStringHandle (LOG4CPLUS_TEXT("single")));
+static log4cplus::tstring_handle thread_name2
     LOG4CPLUS_INIT_PRIORITY (LOG4CPLUS_INIT_PRIORITY_BASE - 1)
     (thread_name);
 #endif
 
 LOG4CPLUS_EXPORT
-log4cplus::tstring const &
-getCurrentThreadName()
+log4cplus::tstring_handle const &
+getCurrentThreadNameHandle()
 {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    log4cplus::tstring & name = log4cplus::internal::get_thread_name_str ();
-    if (name.empty ()) [[unlikely]]
+    log4cplus::tstring_handle & name
+        = log4cplus::internal::get_thread_name_str ();
+    if (! name) [[unlikely]]
     {
         log4cplus::tostringstream tmp;
         tmp << impl::getCurrentThreadId ();
-        name = tmp.str ();
+        name = helpers::makeStringHandle (tmp.str ());
     }
 #else
-    log4cplus::tstring & name = thread_name;
-    if (name.empty()) [[unlikely]]
+    log4cplus::tstring_handle & name = thread_name;
+    if (! name) [[unlikely]]
     {
-        name = LOG4CPLUS_TEXT("single");
+        name = helpers::makeStringHandle (LOG4CPLUS_TEXT("single"));
     }
 #endif
 
@@ -124,6 +125,14 @@ getCurrentThreadName()
 }
 
 
+LOG4CPLUS_EXPORT
+log4cplus::tstring const &
+getCurrentThreadName()
+{
+    return *getCurrentThreadNameHandle ();
+}
+
+
 namespace
 {
 
@@ -161,23 +170,24 @@ get_current_thread_name_alt (log4cplus::tostream * s)
 
 
 LOG4CPLUS_EXPORT
-log4cplus::tstring const &
-getCurrentThreadName2()
+log4cplus::tstring_handle const &
+getCurrentThreadName2Handle()
 {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    log4cplus::tstring & name = log4cplus::internal::get_thread_name2_str ();
-    if (name.empty ()) [[unlikely]]
+    log4cplus::tstring_handle & name
+        = log4cplus::internal::get_thread_name2_str ();
+    if (! name) [[unlikely]]
     {
         log4cplus::tostringstream tmp;
         get_current_thread_name_alt (&tmp);
-        name = tmp.str ();
+        name = helpers::makeStringHandle (tmp.str ());
     }
 
 #else
-    log4cplus::tstring & name = thread_name2;
-    if (name.empty()) [[unlikely]]
+    log4cplus::tstring_handle & name = thread_name2;
+    if (! name) [[unlikely]]
     {
-        name = getCurrentThreadName();
+        name = getCurrentThreadNameHandle();
     }
 
 #endif
@@ -185,21 +195,50 @@ getCurrentThreadName2()
     return name;
 }
 
+
+LOG4CPLUS_EXPORT
+log4cplus::tstring const &
+getCurrentThreadName2()
+{
+    return *getCurrentThreadName2Handle ();
+}
+
+namespace
+{
+
+// Events keep handles of previous names, so a new string is always
+// created here instead of modifying the old one. Empty name resets the
+// handle so that default name is generated again.
+static
+log4cplus::tstring_handle
+make_thread_name_handle (const log4cplus::tstring & name)
+{
+    if (name.empty ())
+        return log4cplus::tstring_handle ();
+    else
+        return helpers::makeStringHandle (name);
+}
+
+} // namespace
+
+
 LOG4CPLUS_EXPORT void setCurrentThreadName(const log4cplus::tstring & name)
 {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    log4cplus::internal::get_thread_name_str() = name;
+    log4cplus::internal::get_thread_name_str()
+        = make_thread_name_handle (name);
 #else
-    thread_name = name;
+    thread_name = make_thread_name_handle (name);
 #endif
 }
 
 LOG4CPLUS_EXPORT void setCurrentThreadName2(const log4cplus::tstring & name)
 {
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    log4cplus::internal::get_thread_name2_str() = name;
+    log4cplus::internal::get_thread_name2_str()
+        = make_thread_name_handle (name);
 #else
-    thread_name2 = name;
+    thread_name2 = make_thread_name_handle (name);
 #endif
 }
 
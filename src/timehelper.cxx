@@ -34,6 +34,10 @@
 #include <cwchar>
 #endif
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch_amalgamated.hpp>
+#endif
+
 #if defined (LOG4CPLUS_HAVE_SYS_TYPES_H)
 #include <sys/types.h>
 #endif
@@ -125,60 +129,84 @@ namespace
 {
 
 
-static log4cplus::tstring const padding_zeros[4] =
-{
-    { LOG4CPLUS_TEXT("000") },
-    { LOG4CPLUS_TEXT("00") },
-    { LOG4CPLUS_TEXT("0") },
-    { }
-};
-
-
-static log4cplus::tstring const uc_q_padding_zeros[4] =
-{
-    { LOG4CPLUS_TEXT(".000") },
-    { LOG4CPLUS_TEXT(".00") },
-    { LOG4CPLUS_TEXT(".0") },
-    { LOG4CPLUS_TEXT(".") }
-};
-
-
+//! Appends \c value in range [0, 999] as three digits with leading zeros.
 static
 void
-build_q_value (log4cplus::tstring & q_str, long tv_usec)
+append_three_digits (log4cplus::tstring & str, long value)
 {
-    convertIntegerToString(q_str, tv_usec / 1000);
-    std::size_t const len = q_str.length();
-    if (len <= 2)
-        q_str.insert (0, padding_zeros[q_str.length()]);
+    tchar const digits[3] = {
+        static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value / 100),
+        static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value / 10 % 10),
+        static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value % 10) };
+    str.append (digits, 3);
 }
 
 
+//! Appends strftime()/wcsftime() formatted \c fmt to \c result. The
+//! \c fmt is restored before returning.
 static
 void
-build_uc_q_value (log4cplus::tstring & uc_q_str, long tv_usec,
-    log4cplus::tstring & tmp)
+append_strftime (log4cplus::tstring & result, log4cplus::tstring & fmt,
+    tm const & time, std::vector<tchar> & buffer)
 {
-    build_q_value (uc_q_str, tv_usec);
+    if (fmt.empty ())
+        return;
 
-    convertIntegerToString(tmp, tv_usec % 1000);
-    std::size_t const usecs_len = tmp.length();
-    tmp.insert (0, usecs_len <= 3
-        ? uc_q_padding_zeros[usecs_len] : uc_q_padding_zeros[3]);
-    uc_q_str.append (tmp);
-}
+    // Format string like "%p" renders as empty string in some locales.
+    // The trailing sentinel character keeps the result non-empty so that
+    // zero returned by strftime() always means too small buffer.
+    fmt.push_back (LOG4CPLUS_TEXT (' '));
 
+    std::size_t buffer_size = fmt.size () + 1;
+    std::size_t len;
 
-} // namespace
+    // Limit how far can the buffer grow. This is necessary so that we
+    // catch bad format string. Some implementations of strftime() signal
+    // both too small buffer and invalid format string by returning 0
+    // without changing errno.
+    std::size_t const buffer_size_max
+        = (std::max) (static_cast<std::size_t>(1024), buffer_size * 16);
 
+    buffer_size = (std::max) (buffer_size, buffer.capacity());
+
+    do
+    {
+        buffer.resize (buffer_size);
+        errno = 0;
+#ifdef UNICODE
+        len = helpers::wcsftime(&buffer[0], buffer_size, fmt.c_str(), &time);
+#else
+        len = helpers::strftime(&buffer[0], buffer_size, fmt.c_str(), &time);
+#endif
+        if (len == 0)
+        {
+            int const eno = errno;
+            buffer_size *= 2;
+            if (buffer_size > buffer_size_max)
+            {
+                fmt.pop_back ();
+                LogLog::getLogLog ()->error (
+                    LOG4CPLUS_TEXT("Error in strftime(): ")
+                    + convertIntegerToString (eno), true);
+                std::unreachable();
+            }
+        }
+    }
+    while (len == 0);
+
+    fmt.pop_back ();
+    result.append (buffer.data (), len - 1);
+}
 
-log4cplus::tstring
-getFormattedTime(const log4cplus::tstring& fmt_orig,
-    Time const & the_time, bool use_gmtime)
-{
-    if (fmt_orig.empty () || fmt_orig[0] == 0)
-        return log4cplus::tstring ();
 
+//! Renders everything in \c fmt except for %q and %Q for second \c tv_sec
+//! into \c entry.
+static
+void
+build_cache_entry (internal::gft_scratch_pad::cache_entry & entry,
+    internal::gft_scratch_pad & gft_sp, log4cplus::tstring const & fmt,
+    time_t tv_sec, Time const & the_time, bool use_gmtime)
+{
     tm time;
 
     if (use_gmtime)
@@ -186,24 +214,26 @@ getFormattedTime(const log4cplus::tstring& fmt_orig,
     else
         localTime (&time, the_time);
 
+    entry.valid = false;
+    entry.fmt = fmt;
+    entry.sec = tv_sec;
+    entry.use_gmtime = use_gmtime;
+    entry.text.clear ();
+    entry.fractions.clear ();
+
     enum State
     {
         TEXT,
         PERCENT_SIGN
     };
 
-    internal::gft_scratch_pad & gft_sp = internal::get_gft_scratch_pad ();
-    gft_sp.reset ();
-
-    std::size_t const fmt_orig_size = gft_sp.fmt.size ();
-    gft_sp.ret.reserve (fmt_orig_size + fmt_orig_size / 3);
-    State state = TEXT;
-
     // Walk the format string and process all occurrences of %q, %Q and %s.
+    // Pieces between %q and %Q are rendered by strftime() separately.
 
-    long const tv_usec = microseconds_part (the_time);
-    time_t const tv_sec = to_time_t (the_time);
-    for (auto fmt_ch : fmt_orig)
+    log4cplus::tstring & piece = gft_sp.fmt;
+    piece.clear ();
+    State state = TEXT;
+    for (auto fmt_ch : fmt)
     {
         switch (state)
         {
@@ -212,7 +242,7 @@ getFormattedTime(const log4cplus::tstring& fmt_orig,
             if (fmt_ch == LOG4CPLUS_TEXT ('%'))
                 state = PERCENT_SIGN;
             else
-                gft_sp.ret.push_back (fmt_ch);
+                piece.push_back (fmt_ch);
         }
         break;
 
@@ -221,25 +251,12 @@ getFormattedTime(const log4cplus::tstring& fmt_orig,
             switch (fmt_ch)
             {
             case LOG4CPLUS_TEXT ('q'):
-            {
-                if (! gft_sp.q_str_valid)
-                {
-                    build_q_value (gft_sp.q_str, tv_usec);
-                    gft_sp.q_str_valid = true;
-                }
-                gft_sp.ret.append (gft_sp.q_str);
-                state = TEXT;
-            }
-            break;
-
             case LOG4CPLUS_TEXT ('Q'):
             {
-                if (! gft_sp.uc_q_str_valid)
-                {
-                    build_uc_q_value (gft_sp.uc_q_str, tv_usec, gft_sp.tmp);
-                    gft_sp.uc_q_str_valid = true;
-                }
-                gft_sp.ret.append (gft_sp.uc_q_str);
+                append_strftime (entry.text, piece, time, gft_sp.buffer);
+                piece.clear ();
+                entry.fractions.emplace_back (entry.text.size (),
+                    fmt_ch == LOG4CPLUS_TEXT ('Q'));
                 state = TEXT;
             }
             break;
@@ -248,20 +265,16 @@ getFormattedTime(const log4cplus::tstring& fmt_orig,
             // (seconds since epoch).
             case LOG4CPLUS_TEXT ('s'):
             {
-                if (! gft_sp.s_str_valid)
-                {
-                    convertIntegerToString (gft_sp.s_str, tv_sec);
-                    gft_sp.s_str_valid = true;
-                }
-                gft_sp.ret.append (gft_sp.s_str);
+                convertIntegerToString (gft_sp.s_str, tv_sec);
+                piece.append (gft_sp.s_str);
                 state = TEXT;
             }
             break;
 
             default:
             {
-                gft_sp.ret.push_back (LOG4CPLUS_TEXT ('%'));
-                gft_sp.ret.push_back (fmt_ch);
+                piece.push_back (LOG4CPLUS_TEXT ('%'));
+                piece.push_back (fmt_ch);
                 state = TEXT;
             }
             }
@@ -272,47 +285,127 @@ getFormattedTime(const log4cplus::tstring& fmt_orig,
 
     // Finally call strftime/wcsftime to format the rest of the string.
 
-    gft_sp.fmt.swap (gft_sp.ret);
-    std::size_t buffer_size = gft_sp.fmt.size () + 1;
-    std::size_t len;
+    append_strftime (entry.text, piece, time, gft_sp.buffer);
+    entry.valid = true;
+}
 
-    // Limit how far can the buffer grow. This is necessary so that we
-    // catch bad format string. Some implementations of strftime() signal
-    // both too small buffer and invalid format string by returning 0
-    // without changing errno.
-    std::size_t const buffer_size_max
-        = (std::max) (static_cast<std::size_t>(1024), buffer_size * 16);
 
-    buffer_size = (std::max) (buffer_size, gft_sp.buffer.capacity());
+} // namespace
 
-    do
+
+log4cplus::tstring
+getFormattedTime(const log4cplus::tstring& fmt_orig,
+    Time const & the_time, bool use_gmtime)
+{
+    log4cplus::tstring result;
+    appendFormattedTime (result, fmt_orig, the_time, use_gmtime);
+    return result;
+}
+
+
+void
+appendFormattedTime (log4cplus::tstring & result,
+    const log4cplus::tstring& fmt_orig, Time const & the_time,
+    bool use_gmtime)
+{
+    if (fmt_orig.empty () || fmt_orig[0] == 0)
+        return;
+
+    // The cache is keyed on whole seconds since epoch. Local time of
+    // given second does not depend on anything else but time zone rules,
+    // so DST transitions always hit a fresh cache entry and changes of
+    // time zone take effect at latest with the next second.
+
+    internal::gft_scratch_pad & gft_sp = internal::get_gft_scratch_pad ();
+    time_t const tv_sec = to_time_t (the_time);
+    internal::gft_scratch_pad::cache_entry * entry = nullptr;
+    internal::gft_scratch_pad::cache_entry * same_fmt_entry = nullptr;
+    for (auto & e : gft_sp.cache)
     {
-        gft_sp.buffer.resize (buffer_size);
-        errno = 0;
-#ifdef UNICODE
-        len = helpers::wcsftime(&gft_sp.buffer[0], buffer_size,
-            gft_sp.fmt.c_str(), &time);
-#else
-        len = helpers::strftime(&gft_sp.buffer[0], buffer_size,
-            gft_sp.fmt.c_str(), &time);
-#endif
-        if (len == 0)
+        if (e.valid && e.use_gmtime == use_gmtime && e.fmt == fmt_orig)
         {
-            int const eno = errno;
-            buffer_size *= 2;
-            if (buffer_size > buffer_size_max)
+            if (e.sec == tv_sec)
+                entry = &e;
+            else
+                same_fmt_entry = &e;
+            break;
+        }
+    }
+
+    if (! entry) [[unlikely]]
+    {
+        if (same_fmt_entry)
+            entry = same_fmt_entry;
+        else
+        {
+            entry = &gft_sp.cache[gft_sp.cache_victim];
+            gft_sp.cache_victim
+                = (gft_sp.cache_victim + 1) % gft_sp.cache.size ();
+        }
+
+        build_cache_entry (*entry, gft_sp, fmt_orig, tv_sec, the_time,
+            use_gmtime);
+    }
+
+    // Patch fractions of second into the cached text.
+
+    long const tv_usec = microseconds_part (the_time);
+    std::size_t pos = 0;
+    for (auto const & [fraction_pos, microseconds] : entry->fractions)
+    {
+        result.append (entry->text, pos, fraction_pos - pos);
+        append_three_digits (result, tv_usec / 1000);
+        if (microseconds)
+        {
+            result.push_back (LOG4CPLUS_TEXT ('.'));
+            append_three_digits (result, tv_usec % 1000);
+        }
+        pos = fraction_pos;
+    }
+    result.append (entry->text, pos, log4cplus::tstring::npos);
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("getFormattedTime", "[timehelper]")
+{
+    tstring const fmt (LOG4CPLUS_TEXT ("%Y-%m-%d %H:%M:%S,%q %Q %%q"));
+
+    CATCH_SECTION ("fractions patched into cached second")
+    {
+        CATCH_REQUIRE (getFormattedTime (fmt, time_from_parts (0, 5007), true)
+            == LOG4CPLUS_TEXT ("1970-01-01 00:00:00,005 005.007 %q"));
+        CATCH_REQUIRE (getFormattedTime (fmt, time_from_parts (0, 999999), true)
+            == LOG4CPLUS_TEXT ("1970-01-01 00:00:00,999 999.999 %q"));
+        CATCH_REQUIRE (getFormattedTime (fmt, time_from_parts (61, 0), true)
+            == LOG4CPLUS_TEXT ("1970-01-01 00:01:01,000 000.000 %q"));
+        CATCH_REQUIRE (getFormattedTime (fmt, time_from_parts (0, 1), true)
+            == LOG4CPLUS_TEXT ("1970-01-01 00:00:00,000 000.001 %q"));
+    }
+
+    CATCH_SECTION ("more formats than cache entries")
+    {
+        for (int round = 0; round != 2; ++round)
+            for (int i = 0; i != 6; ++i)
             {
-                LogLog::getLogLog ()->error (
-                    LOG4CPLUS_TEXT("Error in strftime(): ")
-                    + convertIntegerToString (eno), true);
-                std::unreachable();
+                tstring const prefix (convertIntegerToString (i));
+                CATCH_REQUIRE (getFormattedTime (prefix + LOG4CPLUS_TEXT ("%s.%q"),
+                    time_from_parts (86400 + round, 42000), true)
+                    == prefix + convertIntegerToString (86400 + round)
+                        + LOG4CPLUS_TEXT (".042"));
             }
-        }
     }
-    while (len == 0);
 
-    return tstring (gft_sp.buffer.begin (), gft_sp.buffer.begin () + len);
+    CATCH_SECTION ("append")
+    {
+        tstring str (LOG4CPLUS_TEXT ("x"));
+        appendFormattedTime (str, LOG4CPLUS_TEXT ("%H%q"),
+            time_from_parts (3600, 1000), true);
+        appendFormattedTime (str, tstring (), time_from_parts (0, 0), true);
+        CATCH_REQUIRE (str == LOG4CPLUS_TEXT ("x01001"));
+    }
 }
+#endif
 
 
 } // namespace log4cplus::helpers
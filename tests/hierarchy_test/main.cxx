@@ -63,6 +63,37 @@ main()
         log4cplus::tcout << "Logger name: " << logger.getName()
              << " Parent = " << logger.getParent().getName() << endl;
 
+        // Test that chained log level follows changes of ancestors' log
+        // levels and of the hierarchy structure.
+
+        {
+            Logger deep = Logger::getInstance (
+                LOG4CPLUS_TEXT ("test.subtest.a.b.c.d"));
+            Logger mid = Logger::getInstance (LOG4CPLUS_TEXT ("test.subtest"));
+            LOG4CPLUS_ASSERT (root, deep.isEnabledFor (DEBUG_LOG_LEVEL));
+
+            mid.setLogLevel (WARN_LOG_LEVEL);
+            LOG4CPLUS_ASSERT (root, ! deep.isEnabledFor (INFO_LOG_LEVEL));
+            LOG4CPLUS_ASSERT (root, deep.isEnabledFor (WARN_LOG_LEVEL));
+
+            root.setLogLevel (FATAL_LOG_LEVEL);
+            LOG4CPLUS_ASSERT (root, ! deep.isEnabledFor (INFO_LOG_LEVEL));
+            LOG4CPLUS_ASSERT (root, deep.isEnabledFor (WARN_LOG_LEVEL));
+
+            mid.setLogLevel (NOT_SET_LOG_LEVEL);
+            LOG4CPLUS_ASSERT (root, ! deep.isEnabledFor (ERROR_LOG_LEVEL));
+
+            // New intermediate logger with its own log level.
+            Logger::getInstance (LOG4CPLUS_TEXT ("test.subtest.a.b"))
+                .setLogLevel (TRACE_LOG_LEVEL);
+            LOG4CPLUS_ASSERT (root, deep.isEnabledFor (TRACE_LOG_LEVEL));
+
+            hier.resetConfiguration ();
+            BasicConfigurator::doConfigure ();
+            LOG4CPLUS_ASSERT (root, ! deep.isEnabledFor (TRACE_LOG_LEVEL));
+            LOG4CPLUS_ASSERT (root, deep.isEnabledFor (DEBUG_LOG_LEVEL));
+        }
+
         // Test that loggers exist.
 
         LOG4CPLUS_ASSERT (root, hier.exists (LOG4CPLUS_TEXT ("test.subtest")));
@@ -7,6 +7,9 @@
 #include <log4cplus/helpers/fileinfo.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/initializer.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 
 using namespace std;
@@ -26,6 +29,52 @@ log4cplus::tostream& operator <<(log4cplus::tostream& s, const Time& t)
 #define LOOP_COUNT 100000
 
 
+// Global allocation counters to report heap traffic per logged event.
+static std::atomic<std::size_t> allocated_bytes (0);
+static std::atomic<std::size_t> allocation_count (0);
+
+
+void *
+operator new (std::size_t size)
+{
+    allocated_bytes.fetch_add (size, std::memory_order_relaxed);
+    allocation_count.fetch_add (1, std::memory_order_relaxed);
+    if (void * p = std::malloc (size ? size : 1))
+        return p;
+    throw std::bad_alloc ();
+}
+
+
+void *
+operator new (std::size_t size, std::nothrow_t const &) noexcept
+{
+    allocated_bytes.fetch_add (size, std::memory_order_relaxed);
+    allocation_count.fetch_add (1, std::memory_order_relaxed);
+    return std::malloc (size ? size : 1);
+}
+
+
+void
+operator delete (void * p) noexcept
+{
+    std::free (p);
+}
+
+
+void
+operator delete (void * p, std::size_t) noexcept
+{
+    std::free (p);
+}
+
+
+void
+operator delete (void * p, std::nothrow_t const &) noexcept
+{
+    std::free (p);
+}
+
+
 log4cplus::tstring
 getPropertiesFileArgument (int argc, char * argv[])
 {
@@ -55,19 +104,27 @@ main(int argc, char * argv[])
 
         LOG4CPLUS_WARN(Logger::getRoot (), "Starting test loop....");
 
-        hr_clock::time_point start = hr_clock::now ();
         tstring msg(LOG4CPLUS_TEXT("This is a WARNING..."));
+        std::size_t const bytes_start = allocated_bytes.load ();
+        std::size_t const count_start = allocation_count.load ();
+        hr_clock::time_point start = hr_clock::now ();
         int i = 0;
         for(i=0; i<LOOP_COUNT; ++i) {
             LOG4CPLUS_WARN(logger, msg);
         }
         hr_clock::time_point end = hr_clock::now ();
+        std::size_t const bytes = allocated_bytes.load () - bytes_start;
+        std::size_t const count = allocation_count.load () - count_start;
         hr_clock::duration diff = end - start;
         double diff_seconds = sec_dur_type (diff).count ();
         LOG4CPLUS_WARN(LOG4CPLUS_TEXT("root"), "Logging " << LOOP_COUNT
                        << " took: " << diff_seconds << endl);
         LOG4CPLUS_WARN(root, "Logging average: " << (diff_seconds/LOOP_COUNT)
                        << endl);
+        LOG4CPLUS_WARN(root, "Logging allocated bytes per event: "
+                       << (static_cast<double>(bytes) / LOOP_COUNT)
+                       << " in " << (static_cast<double>(count) / LOOP_COUNT)
+                       << " allocations" << endl);
 
         start = hr_clock::now ();
         for(i=0; i<LOOP_COUNT; ++i) {